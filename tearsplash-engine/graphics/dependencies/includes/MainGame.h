@@ -12,11 +12,12 @@
 // STL includes
 #include <vector>
 #include <iostream>
+#include <string>
 
 #include <SDL/SDL.h>  // Used for window and input
 
 #include <GL/glew.h>  // Used for OpenGL
-#include <Box2D/Box2D.h>
+#include <box2d/box2d.h>
 
 // Tearsplash engine
 #include <Tearsplash/Tearsplash.h>
@@ -27,15 +28,33 @@
 #include <Tearsplash/Spritebatch.h>
 #include <Tearsplash/Spritefont.h>
 #include <Tearsplash/InputManager.h>
+#include <Tearsplash/InputRecording.h>
 #include <Tearsplash/Timing.h>
+#include <Tearsplash/GPUTimer.h>
 #include <Tearsplash/AudioEngine.h>
 #include <Tearsplash/Box.h>
+#include <Tearsplash/ECS.h>
+#include <Tearsplash/ECSSystems.h>
 #include <Tearsplash/ParticleEngine2D.h>
-
-#include "Projectile.h"
+#include <Tearsplash/PhysicsService.h>
+#include <Tearsplash/ProjectilePool.h>
+#include <Tearsplash/RenderLayer.h>
+#include <Tearsplash/SpatialGrid.h>
 
 enum class GameState { PLAY, EXIT };
 
+// Input action IDs, bound to keys in MainGame::bindInputActions.
+enum GameAction
+{
+    ACTION_MOVE_UP,
+    ACTION_MOVE_DOWN,
+    ACTION_MOVE_LEFT,
+    ACTION_MOVE_RIGHT,
+    ACTION_ZOOM_OUT,
+    ACTION_ZOOM_IN,
+    ACTION_FIRE
+};
+
 class MainGame
 {
 public:
@@ -43,15 +62,29 @@ public:
     ~MainGame();
     void run();
 
+    // Call before run(). Records the input of the run to filePath, written on exit.
+    void recordInput(const std::string& filePath);
+    // Call before run(). Plays the input recorded in filePath instead of taking live
+    // input, each frame taking the simulation steps it took when recorded, then prints
+    // the frame times and exits.
+    void replayInput(const std::string& filePath);
+    // Call before run(). Renders to an offscreen framebuffer with no window or audio,
+    // e.g. to replay input in CI. Needs the engine built with TEARSPLASH_HEADLESS.
+    void setHeadless(const bool headless) { mHeadless = headless; }
+
 private:
     // Functions
     void initSystems();
     void initShaders();
+    void bindInputActions();
     void gameLoop();
     void processInput();
+    bool pollInputEvent(SDL_Event& event);
     void render();
-    void printFPS();
+    void renderStaticLayer(const GLint pLocation);
     void createPhysicsObjects();
+    void spawnPhysicsBoxes(const std::vector<glm::vec2>& positions);
+    void createPlayer();
     void updatePhysics(const float timeStep);
     void initParticleSystem();
     void initImGui();
@@ -66,27 +99,58 @@ private:
     Tearsplash::Spritebatch          mSpritebatchParticles;
     Tearsplash::InputManager         mInputManager;
     Tearsplash::FPSLimiter           mFPSLimiter;
+    Tearsplash::FixedTimestep        mFixedTimestep;
+    Tearsplash::GPUTimer             mGPUTimer;
     Tearsplash::AudioEngine          mAudioEngine;
     Tearsplash::Spritefont           mHUDText;
+    Tearsplash::TextLayout           mHUDLayout;
     Tearsplash::ParticleEngine2D     mParticleEngine;
-    std::vector<Projectile>          mBullets;
-    glm::vec2                        mPlayerPosition;
+    Tearsplash::ProjectilePool       mBullets;
+    Tearsplash::SoundEffect          mBulletSound;
+    std::vector<Tearsplash::ProjectileHit> mBulletHits;
+    Tearsplash::World                mWorld;
+    Tearsplash::SystemScheduler      mSystems;
+    Tearsplash::Entity               mPlayer;
     glm::vec2                        mPlayerDirection;
+    Tearsplash::InputRecorder        mInputRecorder;
+    Tearsplash::InputReplay          mInputReplay;
+    std::string                      mInputRecordPath;
+    bool                             mRecordingInput;
+    bool                             mReplayingInput;
+    // Mouse state of the replayed events, fed to ImGui in place of the live mouse.
+    glm::vec2                        mReplayMousePosition;
+    uint32_t                         mReplayMouseButtons;
+    uint32_t                         mReplayMouseClicks;
+    bool                             mHeadless;
+    uint32_t                         mFrameNumber;
+    uint32_t                         mRandomSeed;
     glm::vec2                        mParticleVelocity;
     Tearsplash::ColorRGBA8           mParticleColor;
     Tearsplash::GLTexture            mParticleTexture;
 
     Tearsplash::ParticleBatch2D      mParticleBatch2D;
+    Tearsplash::GPUParticleBatch2D   mGPUParticleBatch2D;
 
 
 
     float                              mFPS;
     float                              mMaxFPS;
+    float                              mSimulationRate;
     int                                mWindowWidth;
     int                                mWindowHeight;
-    std::unique_ptr<b2World>           mPhysicsWorld;
     b2Vec2                             mGravity;
-    std::vector<Tearsplash::Box>       mPhysicsBoxes;
+    Tearsplash::PhysicsService         mPhysics;
+    std::vector<uint32_t>              mSpawnedBoxHandles;
+    std::vector<Tearsplash::AABB>      mPhysicsBoxBounds;
+    std::vector<int>                   mPhysicsBoxGridHandles;
+    std::vector<Tearsplash::Entity>    mPhysicsBoxEntities;
+    std::vector<uint32_t>              mVisibleBoxHandles;
+    std::vector<Tearsplash::Entity>    mVisibleBoxEntities;
+    // Geometry that never moves, cached in mStaticLayer.
+    std::vector<Tearsplash::AABB>      mStaticBoxes;
+    Tearsplash::RenderLayer            mStaticLayer;
+    Tearsplash::GLTexture              mGroundTexture;
+    Tearsplash::SpatialGrid            mWorldGrid;
     std::vector<Tearsplash::GLTexture> mTextures;
 };
 
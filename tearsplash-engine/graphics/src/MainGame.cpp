@@ -11,6 +11,7 @@
 /**********************************************************************/
 
 // Includes -------------------------
+#include <cmath>
 #include <ctime>
 #include <string>
 #include <random>
@@ -19,6 +20,7 @@
 #include <Tearsplash/ImageLoader.h>
 #include <Tearsplash/ResourceManager.h>
 #include <Tearsplash/ParticleBatch2D.h>
+#include <Tearsplash/Profiler.h>
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/rotate_vector.hpp>
@@ -35,10 +37,19 @@ MainGame::MainGame() :
     mCurrentGameState(GameState::PLAY),
     mFPS(0.0f),
     mMaxFPS(60.0f),
+    mSimulationRate(60.0f),
     mWindowWidth(1280), mWindowHeight(720),
     mGravity(0.0f, -9.82f),
-    mPlayerPosition(glm::vec2(0.0, 0.0f)),
-    mPlayerDirection(glm::vec2(1.0, 0.0f)) {}
+    mPlayer(Tearsplash::NULL_ENTITY),
+    mPlayerDirection(glm::vec2(1.0, 0.0f)),
+    mRecordingInput(false),
+    mReplayingInput(false),
+    mReplayMousePosition(-1.0f, -1.0f),
+    mReplayMouseButtons(0),
+    mReplayMouseClicks(0),
+    mHeadless(false),
+    mFrameNumber(0),
+    mRandomSeed(0) {}
 
 // ----------------------------------
 // Default destructor
@@ -51,32 +62,88 @@ MainGame::~MainGame()
 // Runs the game
 void MainGame::run()
 {
+    // A replay reuses the recorded seed, so everything random plays out the same.
+    mRandomSeed = mReplayingInput ? mInputReplay.getSeed() : static_cast<uint32_t>(std::time(nullptr));
+    if (mRecordingInput)
+    {
+        mInputRecorder.begin(mRandomSeed);
+    }
+
     initSystems();
 
     gameLoop();
 }
 
+void MainGame::recordInput(const std::string& filePath)
+{
+    mInputRecordPath = filePath;
+    mRecordingInput = true;
+}
+
+void MainGame::replayInput(const std::string& filePath)
+{
+    if (!mInputReplay.load(filePath))
+    {
+        Tearsplash::fatalError("Could not load input recording " + filePath);
+    }
+    mReplayingInput = true;
+}
+
 // ----------------------------------
 // Initializes vital game engine systems such as memory allocation, SDL (for input and creating window),
 // etc.
 void MainGame::initSystems()
 {
-    Tearsplash::init();
-    mAudioEngine.init();
+    // Headless runs have no audio device, sound effects stay silent.
+    Tearsplash::init(mHeadless);
+    if (!mHeadless)
+    {
+        mAudioEngine.init();
+    }
 
     mFPSLimiter.init(mMaxFPS);
+    mFixedTimestep.init(mSimulationRate);
+    if (mReplayingInput)
+    {
+        // The steps each frame took when recorded, as fast as the machine can go.
+        mFixedTimestep.setLockstep(true);
+        mFPSLimiter.setMaxFPS(100000.0f);
+    }
 
-    mWindow.createWindow("Tearsplash", mWindowWidth, mWindowHeight, Tearsplash::WindowFlags::RESIZABLE);
+    mWindow.createWindow("Tearsplash", mWindowWidth, mWindowHeight, mHeadless ? Tearsplash::WindowFlags::HEADLESS : Tearsplash::WindowFlags::RESIZABLE);
     mCamera.init(mWindowWidth, mWindowHeight);
     mCamera.setScale(2.0f);
 
+    bindInputActions();
+
     initShaders();
     mSpritebatch.init();
 
     mHUDText.init("fonts/28_Days_Later.ttf");
+    // Static HUD text is laid out once, not every frame.
+    mHUDLayout.set("hejsan sa", glm::vec2(100.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f), 1.0f);
+
+    // The default systems run at most two to a stage, one worker covers the second.
+    mSystems.init(1);
+    Tearsplash::addDefaultSystems(mSystems, mPhysics.getTransforms());
+    createPlayer();
 
+    // Cells a few box sizes wide.
+    mWorldGrid.init(64.0f);
     createPhysicsObjects();
 
+    // Static geometry is drawn once into a layer around the spawn area, at the camera's zoom.
+    mStaticLayer.init(Tearsplash::AABB{ glm::vec2(-512.0f, -256.0f), glm::vec2(512.0f, 256.0f) }, 2.0f);
+    mGroundTexture = Tearsplash::ResourceManager::getTexture("textures/01bricks1.png");
+
+    mBullets.init(100000, glm::vec2(30.0f, 30.0f),
+        Tearsplash::ResourceManager::getTexture("textures/jimmyJump_pack/PNG/CharacterRight_Standing.png"),
+        Tearsplash::ColorRGBA8(255, 255, 255, 255));
+    if (!mHeadless)
+    {
+        mBulletSound = mAudioEngine.loadSoundEffect("sound/shots/pistol.wav");
+    }
+
     initParticleSystem();
 
     initImGui();
@@ -89,70 +156,166 @@ void MainGame::gameLoop()
     // Keep looping while player hasn't pressed exit
     while (mCurrentGameState != GameState::EXIT)
     { 
-        float timeStep = 1.0f / 60.0f;
+        TS_PROFILE_FRAME();
         mFPSLimiter.begin();
+        if (mReplayingInput)
+        {
+            mFixedTimestep.setLockstepSteps(mInputReplay.getSteps(mFrameNumber));
+        }
+        mFixedTimestep.beginFrame();
 
-        float startTicks = static_cast<float>(SDL_GetTicks());
+        // Free the voices that finished before this frame plays new sounds.
+        mAudioEngine.update();
         processInput();
 
         mCamera.update();
 
         // Start the Dear ImGui frame
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplSDL2_NewFrame(mWindow.getSDLWindow());
-        ImGui::NewFrame();
+        {
+            TS_PROFILE_SCOPE("ImGui::NewFrame");
+            ImGui_ImplOpenGL3_NewFrame();
+            if (mHeadless)
+            {
+                // No SDL window to take the size and time from.
+                ImGuiIO& io = ImGui::GetIO();
+                io.DisplaySize = ImVec2(static_cast<float>(mWindowWidth), static_cast<float>(mWindowHeight));
+                io.DeltaTime = mFixedTimestep.getTimeStep();
+            }
+            else
+            {
+                ImGui_ImplSDL2_NewFrame(mWindow.getSDLWindow());
+            }
+            if (mReplayingInput)
+            {
+                // The SDL backend reads the live mouse, ImGui gets the replayed one instead.
+                ImGuiIO& io = ImGui::GetIO();
+                io.MousePos = ImVec2(mReplayMousePosition.x, mReplayMousePosition.y);
+                const Uint32 imGuiButtons[] = { SDL_BUTTON_LEFT, SDL_BUTTON_RIGHT, SDL_BUTTON_MIDDLE };
+                for (int i = 0; i < 3; i++)
+                {
+                    // A click released within the frame still counts as held for it.
+                    io.MouseDown[i] = ((mReplayMouseButtons | mReplayMouseClicks) & SDL_BUTTON(imGuiButtons[i])) != 0;
+                }
+                mReplayMouseClicks = 0;
+            }
+            ImGui::NewFrame();
+        }
 
         ImGui::Begin("Spawn box");
         if (ImGui::Button("Button")) {
-          // Create a bunch of falling boxes.
-          Tearsplash::Box box;
-          box.init(mPhysicsWorld.get(), glm::vec2(0.0f, 100.0f), glm::vec2(15.0f, 15.0f), b2_dynamicBody);
-          mPhysicsBoxes.push_back(box);
+          spawnPhysicsBoxes({ glm::vec2(0.0f, 100.0f) });
+        }
+        if (ImGui::Button("Spawn 100")) {
+          // A 10 x 10 stack, spawned as one batch.
+          std::vector<glm::vec2> positions;
+          for (int i = 0; i < 100; i++) {
+            positions.emplace_back(-80.0f + (i % 10) * 16.0f, 100.0f + (i / 10) * 16.0f);
+          }
+          spawnPhysicsBoxes(positions);
         }
         ImGui::End();
 
-        // Update all bullets
-        for (size_t i = 0; i < mBullets.size();)
+        // CPU frame times with the GPU pass times and audio voices next to them.
+        if (Tearsplash::FrameStats::beginImGuiOverlay()) {
+            mFPSLimiter.getFrameStats().drawImGui();
+            ImGui::Separator();
+            mGPUTimer.drawImGui();
+            ImGui::Separator();
+            mAudioEngine.getVoiceManager().drawImGui();
+        }
+        ImGui::End();
+        Tearsplash::Profiler::drawImGuiFlameGraph();
+
+        // Simulate in fixed steps, as many as the real time since last frame covers.
+        int numSteps = 0;
+        while (mFixedTimestep.step())
         {
-            if (mBullets[i].update() == true)
-            {
-                mBullets[i] = mBullets.back();
-                mBullets.pop_back();
-            }
-            else
+            TS_PROFILE_SCOPE("MainGame::simulationStep");
+            numSteps++;
+            const float timeStep = mFixedTimestep.getTimeStep();
+
+            // Move the bullets and push every box they hit.
+            mBullets.update(timeStep);
+            mBulletHits.clear();
+            mBullets.collide(mWorldGrid, mBulletHits);
+            for (const Tearsplash::ProjectileHit& hit : mBulletHits)
             {
-                i++;
+                mPhysics.applyLinearImpulse(hit.userData, hit.velocity * 0.01f, hit.position);
             }
-        }
 
-        mParticleEngine.updateBatches(timeStep);
+            mParticleEngine.updateBatches(timeStep);
+
+            updatePhysics(timeStep);
 
-        updatePhysics(timeStep);
+            mSystems.run(mWorld, timeStep);
+        }
+        if (mRecordingInput)
+        {
+            mInputRecorder.recordSteps(numSteps);
+        }
 
         render();
 
         mFPS = mFPSLimiter.end();
 
-        printFPS();
+        mFrameNumber++;
+        if (mReplayingInput && mInputReplay.isFinished(mFrameNumber))
+        {
+            mCurrentGameState = GameState::EXIT;
+        }
+    }
+
+    if (mRecordingInput && !mInputRecorder.save(mInputRecordPath))
+    {
+        Tearsplash::softError("Could not save input recording " + mInputRecordPath);
+    }
+    if (mReplayingInput)
+    {
+        const Tearsplash::FrameStatsSummary& stats = mFPSLimiter.getFrameStats().getSummary();
+        std::cout << "Replayed " << mFrameNumber << " frames. Last " << stats.numSamples << " frames, ms: avg " << stats.avgMs
+            << " p95 " << stats.p95Ms << " p99 " << stats.p99Ms << " max " << stats.maxMs << std::endl;
     }
 
     shutdownImGui();
+    mStaticLayer.destroy();
+    mGPUTimer.destroy();
+    mPhysics.destroy();
+    mSystems.destroy();
 
     return;
 }
 
+// ----------------------------------
+// Binds the keys of every GameAction, by scancode so they keep their place on other keyboard layouts.
+void MainGame::bindInputActions()
+{
+    mInputManager.bindAction(ACTION_MOVE_UP, SDL_SCANCODE_W);
+    mInputManager.bindAction(ACTION_MOVE_DOWN, SDL_SCANCODE_S);
+    mInputManager.bindAction(ACTION_MOVE_LEFT, SDL_SCANCODE_A);
+    mInputManager.bindAction(ACTION_MOVE_RIGHT, SDL_SCANCODE_D);
+    mInputManager.bindAction(ACTION_ZOOM_OUT, SDL_SCANCODE_Q);
+    mInputManager.bindAction(ACTION_ZOOM_IN, SDL_SCANCODE_E);
+    mInputManager.bindAction(ACTION_FIRE, SDL_SCANCODE_F);
+}
+
 // ----------------------------------
 // Processes user input.
 void MainGame::processInput()
 {
+    TS_PROFILE_SCOPE("MainGame::processInput");
+
     const float SCALE_SPEED = 0.1f;
-    const float CAMERA_SPEED = 5.0f;
-    const float PLAYER_SPEED = 5.0f;
+    // Units per second, the player is moved by integrateVelocities in the simulation step.
+    const float PLAYER_SPEED = 300.0f;
+
+    Tearsplash::TransformComponent& playerTransform = *mWorld.get<Tearsplash::TransformComponent>(mPlayer);
+    const glm::vec2& playerPosition = playerTransform.position;
+    glm::vec2 playerVelocity(0.0f, 0.0f);
 
     mInputManager.update();
     SDL_Event userInput;
 
-    while (SDL_PollEvent(&userInput) == 1)
+    while (pollInputEvent(userInput))
     {
         ImGui_ImplSDL2_ProcessEvent(&userInput);
         // There is a user input present
@@ -163,26 +326,28 @@ void MainGame::processInput()
                 break;
 
             case SDL_MOUSEMOTION:
+            {
                 mInputManager.setMouseCoords(static_cast<float>(userInput.motion.x), static_cast<float>(userInput.motion.y));
                 glm::vec2 mouseCoords = mInputManager.getMouseCoords();
                 mouseCoords = mCamera.convertScreen2World(mouseCoords);
-                mPlayerDirection = glm::normalize(mouseCoords - mPlayerPosition);
+                mPlayerDirection = glm::normalize(mouseCoords - playerPosition);
                 break;
+            }
 
             case SDL_KEYDOWN:
-                mInputManager.pressKey(userInput.key.keysym.sym);
+                mInputManager.pressKey(userInput.key.keysym.scancode);
                 break;
 
             case SDL_KEYUP:
-                mInputManager.releaseKey(userInput.key.keysym.sym);
+                mInputManager.releaseKey(userInput.key.keysym.scancode);
                 break;
 
             case SDL_MOUSEBUTTONDOWN:
-                mInputManager.pressKey(userInput.button.button);
+                mInputManager.pressKey(Tearsplash::InputManager::mouseButton(userInput.button.button));
                 break;
 
             case SDL_MOUSEBUTTONUP:
-                mInputManager.releaseKey(userInput.button.button);
+                mInputManager.releaseKey(Tearsplash::InputManager::mouseButton(userInput.button.button));
                 break;
 
             default:
@@ -193,60 +358,114 @@ void MainGame::processInput()
 
     // Check for key pressed in input manager and add action
 
-    if (mInputManager.isKeyPressed(SDLK_w))
+    if (mInputManager.isActionDown(ACTION_MOVE_UP))
     {
-        // NOTE! Camera is moving down, scene moving up
-        //mCamera.setPosition(mCamera.getPosition() + glm::vec2(0.0f, -CAMERA_SPEED));
-        mPlayerPosition = mPlayerPosition + glm::vec2(0.0f, PLAYER_SPEED);
+        playerVelocity += glm::vec2(0.0f, PLAYER_SPEED);
     }
 
-    if (mInputManager.isKeyPressed(SDLK_s))
+    if (mInputManager.isActionDown(ACTION_MOVE_DOWN))
     {
-        // NOTE! Camera is moving up, scene moving down
-        //mCamera.setPosition(mCamera.getPosition() + glm::vec2(0.0f, CAMERA_SPEED));
-
-        mPlayerPosition = mPlayerPosition + glm::vec2(0.0f, -PLAYER_SPEED);
+        playerVelocity += glm::vec2(0.0f, -PLAYER_SPEED);
     }
 
-    if (mInputManager.isKeyPressed(SDLK_a))
+    if (mInputManager.isActionDown(ACTION_MOVE_LEFT))
     {
-        // NOTE! Camera is moving right, scene moving left
-        //mCamera.setPosition(mCamera.getPosition() + glm::vec2(CAMERA_SPEED, 0.0f));
-
-        mPlayerPosition = mPlayerPosition + glm::vec2(-PLAYER_SPEED, 0.0f);
+        playerVelocity += glm::vec2(-PLAYER_SPEED, 0.0f);
     }
 
-    if (mInputManager.isKeyPressed(SDLK_d))
+    if (mInputManager.isActionDown(ACTION_MOVE_RIGHT))
     {
-        // NOTE! Camera is moving left, scene moving right
-        //mCamera.setPosition(mCamera.getPosition() + glm::vec2(-CAMERA_SPEED, 0.0f));
-
-        mPlayerPosition = mPlayerPosition + glm::vec2(PLAYER_SPEED, 0.0f);
+        playerVelocity += glm::vec2(PLAYER_SPEED, 0.0f);
     }
+    mWorld.get<Tearsplash::VelocityComponent>(mPlayer)->velocity = playerVelocity;
 
-    if (mInputManager.isKeyPressed(SDLK_q))
+    if (mInputManager.isActionDown(ACTION_ZOOM_OUT))
     {
         mCamera.setScale(mCamera.getScale() - SCALE_SPEED);
     }
 
-    if (mInputManager.isKeyPressed(SDLK_e))
+    if (mInputManager.isActionDown(ACTION_ZOOM_IN))
     {
         mCamera.setScale(mCamera.getScale() + SCALE_SPEED);
     }
 
-    if (mInputManager.isKeyPressed(SDLK_f))
+    // One bullet per press, not one per frame the key is held.
+    if (mInputManager.isActionPressed(ACTION_FIRE))
+    {
+        // Bullets are positioned by their bottom left corner, center them on the player.
+        if (mBullets.spawn(playerPosition - glm::vec2(15.0f, 15.0f), mPlayerDirection * 600.0f, 16.0f))
+        {
+            mBulletSound.play();
+        }
+    }
+
+    // The player faces the mouse right away, only its position is interpolated.
+    playerTransform.angle = std::atan2(mPlayerDirection.y, mPlayerDirection.x);
+    playerTransform.prevAngle = playerTransform.angle;
+}
+
+// ----------------------------------
+// Next input event of this frame, live or replayed. Live events are recorded when recording.
+bool MainGame::pollInputEvent(SDL_Event& event)
+{
+    if (mReplayingInput)
+    {
+        // Live input is drained so the window stays responsive, only closing it gets through.
+        while (SDL_PollEvent(&event) == 1)
+        {
+            if (event.type == SDL_QUIT)
+            {
+                return true;
+            }
+        }
+        if (!mInputReplay.poll(mFrameNumber, event))
+        {
+            return false;
+        }
+
+        // Kept for ImGui, see gameLoop.
+        switch (event.type)
+        {
+            case SDL_MOUSEMOTION:
+                mReplayMousePosition = glm::vec2(event.motion.x, event.motion.y);
+                break;
+
+            case SDL_MOUSEBUTTONDOWN:
+                mReplayMousePosition = glm::vec2(event.button.x, event.button.y);
+                mReplayMouseButtons |= SDL_BUTTON(event.button.button);
+                mReplayMouseClicks |= SDL_BUTTON(event.button.button);
+                break;
+
+            case SDL_MOUSEBUTTONUP:
+                mReplayMousePosition = glm::vec2(event.button.x, event.button.y);
+                mReplayMouseButtons &= ~SDL_BUTTON(event.button.button);
+                break;
+
+            default:
+                break;
+        }
+        return true;
+    }
+
+    if (SDL_PollEvent(&event) != 1)
     {
-        glm::vec2 mouseCoords = mInputManager.getMouseCoords();
-        // This is really ugly, should not try to load the sound effect every time a bullet is fired.
-        mBullets.emplace_back(mPlayerPosition, mPlayerDirection, 10.0f, 1000, mAudioEngine.loadSoundEffect("sound/shots/pistol.wav"));
-        mBullets.back().playSoundFX();
+        return false;
     }
+    if (mRecordingInput)
+    {
+        mInputRecorder.record(mFrameNumber, event);
+    }
+    return true;
 }
 
 // ----------------------------------
 // Rendering main function
 void MainGame::render()
 {
+    TS_PROFILE_SCOPE("MainGame::render");
+
+    mGPUTimer.beginFrame();
+
     // Prepare for rendering
     glClearDepth(1.0f); // Clear depth to 1
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);	// Clear color buffer and depth buffer between draws
@@ -265,61 +484,101 @@ void MainGame::render()
     glm::mat4 cameraMatrix = mCamera.getCameraMatrix();
     glUniformMatrix4fv(pLocation, 1, GL_FALSE, &(cameraMatrix[0][0]));
 
-    // Start filling sprite batches
+    // Composite the static layer as one quad, redrawing it first if anything in it changed.
+    mGPUTimer.beginPass("Static layer");
+    if (mStaticLayer.isDirty())
+    {
+        renderStaticLayer(pLocation);
+        glUniformMatrix4fv(pLocation, 1, GL_FALSE, &(cameraMatrix[0][0]));
+    }
     mSpritebatch.begin(Tearsplash::GlyphSortType::TEXTURE);
+    mStaticLayer.draw(mSpritebatch);
+    mSpritebatch.end();
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    mSpritebatch.renderBatch();
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    mGPUTimer.endPass();
 
-    glm::vec4 uv(0.0f, 0.0f, 1.0f, 1.0f);
-    static Tearsplash::GLTexture playerTexture = Tearsplash::ResourceManager::getTexture("textures/jimmyJump_pack/PNG/CharacterRight_Standing.png");
-    Tearsplash::ColorRGBA8 color;
-    color.r = 255;
-    color.g = 255;
-    color.b = 255;
-    color.a = 255;
-
-    // Draw the player sprite.
-    mSpritebatch.draw(glm::vec4(mPlayerPosition, 50.0, 50.0), uv, playerTexture.id, 0, color, mPlayerDirection);
+    // Start filling sprite batches
+    mSpritebatch.begin(Tearsplash::GlyphSortType::TEXTURE);
 
-    for (size_t i = 0; i < mBullets.size(); i++)
+    // The visible physics boxes come from one query of the world grid with the camera's view.
+    const Tearsplash::AABB viewAABB = mCamera.getViewAABB();
+    mVisibleBoxHandles.clear();
+    mWorldGrid.query(viewAABB, mVisibleBoxHandles);
+    mVisibleBoxEntities.clear();
+    for (const uint32_t handle : mVisibleBoxHandles)
     {
-        // Render the bullets to the sprite batch.
-        if (mCamera.isInView(mBullets[i].getPosition(), mBullets[i].getAABB())) {
-            mBullets[i].draw(mSpritebatch);
-        }
+        mVisibleBoxEntities.push_back(mPhysicsBoxEntities[handle]);
     }
+    Tearsplash::drawSprites(mWorld, mSpritebatch, mVisibleBoxEntities, mFixedTimestep.getAlpha());
 
-    // Draw the physics boxes.
-    static Tearsplash::GLTexture brickTexture = Tearsplash::ResourceManager::getTexture("textures/01bricks1.png");
-    for (auto& box : mPhysicsBoxes) {
-        glm::vec4 destRect;
-        // Subtract half of the dimensions since the physics box origin is in the box center,
-        // but our draw center is in the corner.
-        destRect.x = box.getBody()->GetPosition().x - box.getDimensions().x * 0.5f;
-        destRect.y = box.getBody()->GetPosition().y - box.getDimensions().y * 0.5f;
-        destRect.z = box.getDimensions().x;
-        destRect.w = box.getDimensions().y;
-        mSpritebatch.draw(destRect, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), brickTexture.id, 0.0f, Tearsplash::ColorRGBA8(255, 255, 255, 255));
-    }
+    // Every other entity with a sprite, i.e. the player, is culled on its own.
+    Tearsplash::drawSprites(mWorld, mSpritebatch, viewAABB, mFixedTimestep.getAlpha(),
+        Tearsplash::ComponentRegistry::mask<Tearsplash::PhysicsBodyComponent>());
+
+    // Render the visible bullets to the sprite batch, culled and added in one batch.
+    mBullets.buildDrawData(viewAABB, mFixedTimestep.getAlpha());
+    mBullets.draw(mSpritebatch);
 
     // Stop filling sprite batches
     mSpritebatch.end();
 
     // Render sprite batches
+    mGPUTimer.beginPass("Sprites");
     mSpritebatch.renderBatch();
+    mGPUTimer.endPass();
 
     // Draw the particles.
-    mParticleEngine.drawBatches();
+    mGPUTimer.beginPass("Particles");
+    mParticleEngine.drawBatches(cameraMatrix);
+    mGPUTimer.endPass();
 
     // Stop using shader program
     mColorShaders.dontuse();
 
     // Render Text
-    mHUDText.drawText("hejsan sa", glm::vec4(100.0f, 0.0f, 0.0f, 0.0f), cameraMatrix, glm::vec3(1.0f, 1.0f, 1.0f), 1.0f);
+    mHUDText.drawText(mHUDLayout, cameraMatrix);
+    mGPUTimer.beginPass("Text");
     mHUDText.render();
+    mGPUTimer.endPass();
 
-    ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    {
+        TS_PROFILE_SCOPE("ImGui::Render");
+        ImGui::Render();
+        mGPUTimer.beginPass("ImGui");
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        mGPUTimer.endPass();
+    }
 
-    mWindow.swapBuffer();
+    {
+        TS_PROFILE_SCOPE("Window::swapBuffer");
+        mWindow.swapBuffer();
+    }
+}
+
+// ----------------------------------
+// Redraws the dirty part of the static layer. Leaves the layer's projection in pLocation.
+void MainGame::renderStaticLayer(const GLint pLocation)
+{
+    TS_PROFILE_SCOPE("MainGame::renderStaticLayer");
+
+    const Tearsplash::AABB dirtyRect = mStaticLayer.getDirtyRect();
+    const glm::mat4 layerMatrix = mStaticLayer.begin();
+    glUniformMatrix4fv(pLocation, 1, GL_FALSE, &(layerMatrix[0][0]));
+
+    mSpritebatch.begin(Tearsplash::GlyphSortType::TEXTURE);
+    for (const Tearsplash::AABB& box : mStaticBoxes)
+    {
+        if (box.overlaps(dirtyRect))
+        {
+            mSpritebatch.draw(glm::vec4(box.min, box.max - box.min), glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), mGroundTexture.id, 0, Tearsplash::ColorRGBA8(255, 255, 255, 255));
+        }
+    }
+    mSpritebatch.end();
+    mSpritebatch.renderBatch();
+
+    mStaticLayer.end();
 }
 
 // ----------------------------------
@@ -336,44 +595,76 @@ void MainGame::initShaders()
     mColorShaders.linkShaders();
 }
 
-// ----------------------------------
-// Prints fps each 10 frames
-void MainGame::printFPS()
+void MainGame::createPhysicsObjects()
 {
-    static int frameCounter = 0;
+    // Create the physics world, stepped on its own thread. Everything here lands in
+    // one shard, the boxes all pile up on the same ground.
+    Tearsplash::PhysicsServiceConfig physicsConfig;
+    physicsConfig.gravity = mGravity;
+    mPhysics.init(physicsConfig);
+
+    // Create a static ground box. It's not tracked by handle since it never moves, it's
+    // drawn through the static layer instead.
+    const glm::vec2 groundPosition(0.0f, -10.0f);
+    const glm::vec2 groundDimensions(100.0f, 15.0f);
+    mPhysics.addStaticBox(groundPosition, groundDimensions);
+    mStaticBoxes.push_back(Tearsplash::AABB::fromCenter(groundPosition, groundDimensions));
 
-    frameCounter++;
-
-    // Print each 10th frame
-    if (frameCounter == 100)
-    {
-        std::cout << "fps: " << mFPS << std::endl;
-        frameCounter = 0;
-    }
+    // Create a bunch of falling boxes.
+    spawnPhysicsBoxes({ glm::vec2(0.0f, 100.0f) });
 }
 
-void MainGame::createPhysicsObjects()
+void MainGame::spawnPhysicsBoxes(const std::vector<glm::vec2>& positions)
 {
-    // Create the physics world.
-    mPhysicsWorld = std::make_unique<b2World>(mGravity);
+    const std::vector<glm::vec2> dimensions(positions.size(), glm::vec2(15.0f, 15.0f));
+    mSpawnedBoxHandles.resize(positions.size());
+    mPhysics.spawnBoxes(positions.data(), dimensions.data(), positions.size(), b2_dynamicBody, mSpawnedBoxHandles.data());
 
-    // Create a static ground box.
-    Tearsplash::Box ground;
-    ground.init(mPhysicsWorld.get(), glm::vec2(0.0f, -10.0f), glm::vec2(100.0f, 15.0f));
-    // Don't add this to the mPhysicsBoxes since we don't want it rendered.
-    //mPhysicsBoxes.push_back(ground);
+    static Tearsplash::GLTexture brickTexture = Tearsplash::ResourceManager::getTexture("textures/01bricks1.png");
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        const uint32_t handle = mSpawnedBoxHandles[i];
 
-    // Create a bunch of falling boxes.
-    Tearsplash::Box box;
-    box.init(mPhysicsWorld.get(), glm::vec2(0.0f, 100.0f), glm::vec2(15.0f, 15.0f), b2_dynamicBody);
-    mPhysicsBoxes.push_back(box);
+        // Drawn through the ECS, its transform follows the body.
+        const Tearsplash::Entity entity = mWorld.create();
+        mWorld.add(entity, Tearsplash::makeTransform(positions[i]));
+        mWorld.add(entity, Tearsplash::SpriteComponent{ dimensions[i], glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), brickTexture.id, 0, Tearsplash::ColorRGBA8(255, 255, 255, 255) });
+        // Boxes are never destroyed, so physics handles and the indices below line up.
+        mWorld.add(entity, Tearsplash::PhysicsBodyComponent{ handle });
+
+        mPhysicsBoxEntities.push_back(entity);
+
+        // Bullets and the camera find the boxes through the world grid, by handle.
+        mPhysicsBoxBounds.push_back(Tearsplash::AABB::fromCenter(positions[i], dimensions[i]));
+        mPhysicsBoxGridHandles.push_back(mWorldGrid.insert(mPhysicsBoxBounds.back(), mSpawnedBoxHandles[i]));
+    }
 }
  
+void MainGame::createPlayer()
+{
+    static Tearsplash::GLTexture playerTexture = Tearsplash::ResourceManager::getTexture("textures/jimmyJump_pack/PNG/CharacterRight_Standing.png");
+    mPlayer = mWorld.create();
+    mWorld.add(mPlayer, Tearsplash::makeTransform(glm::vec2(25.0f, 25.0f)));
+    mWorld.add(mPlayer, Tearsplash::VelocityComponent{ glm::vec2(0.0f, 0.0f) });
+    mWorld.add(mPlayer, Tearsplash::SpriteComponent{ glm::vec2(50.0f, 50.0f), glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), playerTexture.id, 0, Tearsplash::ColorRGBA8(255, 255, 255, 255) });
+}
+
 void MainGame::updatePhysics(const float timeStep)
 {
-    // Since we're locking the fps to 60, we'll use that as a timestep.
-    // If the FPS starts lagging behind this won't work very well.
-    mPhysicsWorld->Step(timeStep, 6, 2);
+    TS_PROFILE_SCOPE("MainGame::updatePhysics");
+
+    // Called with the fixed simulation step, independent of the frame rate. Publishes
+    // the previous step and starts this one, the bodies are drawn one step behind.
+    mPhysics.step(timeStep);
+
+    // Refresh the bounds used for bullet hits of the bodies that moved.
+    for (const uint32_t handle : mPhysics.getMovedHandles())
+    {
+        // Rotated boxes reach at most half the diagonal from their center.
+        const float diagonal = glm::length(mPhysics.getDimensions(handle));
+        mPhysicsBoxBounds[handle] = Tearsplash::AABB::fromCenter(mPhysics.getTransform(handle).position, glm::vec2(diagonal));
+        mWorldGrid.update(mPhysicsBoxGridHandles[handle], mPhysicsBoxBounds[handle]);
+    }
 }
 
 void MainGame::initParticleSystem() {
@@ -385,7 +676,7 @@ void MainGame::initParticleSystem() {
     mParticleTexture = Tearsplash::ResourceManager::getTexture("textures/whitePuff02.png");
     mParticleBatch2D.init(maxParticles, 1.0f, mParticleTexture);
     // Setup random generator for random angle around 360 deg circle.
-    std::mt19937 mt_rand(std::time(nullptr));
+    std::mt19937 mt_rand(mRandomSeed);
     std::uniform_real_distribution<float> randAngleCircle(0.0f, 360);
 
     // Specify velocity and rotate it.
@@ -401,6 +692,16 @@ void MainGame::initParticleSystem() {
     }
 
     mParticleEngine.addParticleBatch(mParticleBatch2D, mSpritebatchParticles);
+
+    // The bigger effect is simulated on the GPU.
+    const int maxGPUParticles = 100000;
+    mGPUParticleBatch2D.init(maxGPUParticles, 0.5f, mParticleTexture);
+    Tearsplash::ColorRGBA8 gpuParticleColor(255, 128, 0, 255);
+    for (int i = 0; i < maxGPUParticles; i++) {
+        mGPUParticleBatch2D.addParticle(glm::vec2(100.0f, 0.0f), glm::rotate(mParticleVelocity, randAngleCircle(mt_rand)), gpuParticleColor, 2.0f, 1.0f);
+    }
+
+    mParticleEngine.addParticleBatch(mGPUParticleBatch2D);
 }
 
 void MainGame::initImGui() {
@@ -411,13 +712,23 @@ void MainGame::initImGui() {
   // Setup Dear ImGui style
   ImGui::StyleColorsDark();
 
-  // Setup Platform/Renderer bindings
-  ImGui_ImplSDL2_InitForOpenGL(mWindow.getSDLWindow(), mWindow.getGLContext());
+  // Recorded clicks only land on the same widgets with the same window layout, so
+  // recording and replaying always start from the default one.
+  if (mRecordingInput || mReplayingInput) {
+    ImGui::GetIO().IniFilename = nullptr;
+  }
+
+  // Setup Platform/Renderer bindings, headless runs only render
+  if (!mWindow.isHeadless()) {
+    ImGui_ImplSDL2_InitForOpenGL(mWindow.getSDLWindow(), mWindow.getGLContext());
+  }
   ImGui_ImplOpenGL3_Init(mWindow.getGLSLVersion());
 }
 
 void MainGame::shutdownImGui() {
   ImGui_ImplOpenGL3_Shutdown();
-  ImGui_ImplSDL2_Shutdown();
+  if (!mWindow.isHeadless()) {
+    ImGui_ImplSDL2_Shutdown();
+  }
   ImGui::DestroyContext();
 }
\ No newline at end of file
@@ -11,6 +11,8 @@
 /**********************************************************************/
 
 // Includes -------------------------
+#include <string>
+
 #include "MainGame.h"
 
 
@@ -20,6 +22,26 @@ int main(int argc, char** argv) // Argc and argv are needed since the "real" mai
 {
 	// Create the main game object and run
 	MainGame mainGame;
+
+	// --record <file> saves the input of the run, --replay <file> plays it back,
+	// --headless renders offscreen, e.g. to replay in CI
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string option = argv[i];
+		if (option == "--record" && i + 1 < argc)
+		{
+			mainGame.recordInput(argv[++i]);
+		}
+		else if (option == "--replay" && i + 1 < argc)
+		{
+			mainGame.replayInput(argv[++i]);
+		}
+		else if (option == "--headless")
+		{
+			mainGame.setHeadless(true);
+		}
+	}
+
 	mainGame.run();
 
 	return 0;
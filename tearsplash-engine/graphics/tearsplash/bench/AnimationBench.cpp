@@ -0,0 +1,59 @@
+// Advancing 100k animated sprites at 60 Hz through SpriteAnimator, spread over a
+// handful of clips with different frame rates and started at random offsets so
+// frames don't all change on the same update.
+
+#include <random>
+
+#include <Tearsplash/SpriteAnimator.h>
+
+#include "Bench.h"
+
+using namespace TearsplashBench;
+
+namespace {
+    const int NUM_SPRITES = 100000;
+    const float DELTA_TIME = 1.0f / 60.0f;
+
+    void animationBench(BenchReport& report) {
+        Tearsplash::GLTexture texture = { 0, 256, 256 };
+        Tearsplash::Tilesheet tilesheet;
+        tilesheet.init(texture, glm::ivec3(8, 8, 0));
+
+        Tearsplash::SpriteAnimator animator;
+        const int clips[] = {
+            animator.addClip(tilesheet, 0, 8, 0.1f),
+            animator.addClip(tilesheet, 8, 4, 0.25f),
+            animator.addClip(tilesheet, 16, 6, 1.0f / 12.0f),
+            animator.addClip(tilesheet, { 24, 25, 26, 25 }, { 0.2f, 0.05f, 0.3f, 0.05f }),
+            animator.addClip(tilesheet, 32, 16, 1.0f / 30.0f, false),
+        };
+        const int numClips = static_cast<int>(sizeof(clips) / sizeof(clips[0]));
+
+        std::mt19937 rng(1234);
+        std::uniform_int_distribution<int> clipDistribution(0, numClips - 1);
+        // Start each player up to a second into its clip, as sprites spawned over time would be.
+        std::uniform_real_distribution<float> startDistribution(0.0f, 1.0f);
+        std::vector<int> handles(NUM_SPRITES);
+        for (int i = 0; i < NUM_SPRITES; i++) {
+            handles[i] = animator.play(clips[clipDistribution(rng)], startDistribution(rng));
+        }
+
+        const uint64_t iterations = 600;
+        const double updateNs = measureNs(iterations, [&]() {
+            animator.update(DELTA_TIME);
+        });
+        report.add({ "animation/update_100k", iterations, updateNs,
+            { { "ns_per_sprite", updateNs / NUM_SPRITES } } });
+
+        glm::vec4 sum(0.0f);
+        const double lookupNs = measureNs(iterations, [&]() {
+            for (int i = 0; i < NUM_SPRITES; i++) {
+                sum += animator.getUV(handles[i]);
+            }
+            doNotOptimize(sum);
+        });
+        report.add({ "animation/get_uv_100k", iterations, lookupNs, {} });
+    }
+}
+
+TEARSPLASH_BENCH("animation", animationBench);
@@ -0,0 +1,88 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace TearsplashBench {
+
+    struct BenchResult {
+        std::string name;
+        uint64_t iterations;
+        double nsPerIteration;
+        // Extra numbers worth reporting next to the timing, e.g. how many objects were visible.
+        std::vector<std::pair<std::string, double>> counters;
+    };
+
+    class BenchReport {
+    public:
+        void add(const BenchResult& result) { mResults.push_back(result); }
+        const std::vector<BenchResult>& getResults() const { return mResults; }
+        // Records a failed check, e.g. results that don't match. The run exits non-zero.
+        void fail(const std::string& message) { mFailures.push_back(message); }
+        const std::vector<std::string>& getFailures() const { return mFailures; }
+
+        void print() const;
+        // Writes the results as JSON so runs can be diffed against a baseline. Returns false if the file couldn't be opened.
+        bool writeJson(const std::string& filePath) const;
+
+    private:
+        std::vector<BenchResult> mResults;
+        std::vector<std::string> mFailures;
+    };
+
+    typedef void (*BenchFunction)(BenchReport& report);
+
+    // Benchmarks register themselves at static init time with TEARSPLASH_BENCH.
+    struct BenchRegistrar {
+        BenchRegistrar(const char* name, BenchFunction function);
+    };
+
+    struct RegisteredBench {
+        const char* name;
+        BenchFunction function;
+    };
+    std::vector<RegisteredBench>& getRegisteredBenches();
+
+    // Frames each rendered scene runs for, set with --frames.
+    uint64_t getSceneFrames();
+
+    // Runs function iterations times after one warm up call and returns the average time of a call.
+    template<typename Function>
+    double measureNs(const uint64_t iterations, Function function) {
+        function();
+        const auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            function();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(iterations);
+    }
+
+    // Keeps the compiler from optimizing away a result that is otherwise unused.
+    template<typename T>
+    void doNotOptimize(const T& value) {
+#ifdef _MSC_VER
+        static const void* volatile sink;
+        sink = &value;
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "g"(&value) : "memory");
+#endif
+    }
+
+}
+
+#define TEARSPLASH_BENCH_CONCAT_IMPL(a, b) a##b
+#define TEARSPLASH_BENCH_CONCAT(a, b) TEARSPLASH_BENCH_CONCAT_IMPL(a, b)
+#define TEARSPLASH_BENCH(name, function) \
+    static TearsplashBench::BenchRegistrar TEARSPLASH_BENCH_CONCAT(tsBenchRegistrar, __LINE__)(name, function)
+
+#endif // !BENCH_H
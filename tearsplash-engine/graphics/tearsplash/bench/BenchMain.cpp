@@ -0,0 +1,117 @@
+// Runs every registered benchmark, or only those whose name contains the filter.
+//
+// Usage: tearsplash_bench [filter] [--json results.json] [--frames N]
+//
+// Exits non-zero if a benchmark reported a failed check.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include "Bench.h"
+
+using namespace TearsplashBench;
+
+namespace {
+    uint64_t sceneFrames = 300;
+
+    void writeEscaped(std::ofstream& file, const std::string& text) {
+        for (const char c : text) {
+            if (c == '"' || c == '\\') {
+                file << '\\';
+            }
+            file << c;
+        }
+    }
+}
+
+BenchRegistrar::BenchRegistrar(const char* name, BenchFunction function) {
+    getRegisteredBenches().push_back({ name, function });
+}
+
+std::vector<RegisteredBench>& TearsplashBench::getRegisteredBenches() {
+    // Function local so registration order between translation units doesn't matter.
+    static std::vector<RegisteredBench> benches;
+    return benches;
+}
+
+uint64_t TearsplashBench::getSceneFrames() {
+    return sceneFrames;
+}
+
+void BenchReport::print() const {
+    for (const BenchResult& result : mResults) {
+        std::printf("%-48s %14.1f ns %10llu iterations", result.name.c_str(), result.nsPerIteration,
+            static_cast<unsigned long long>(result.iterations));
+        for (const auto& counter : result.counters) {
+            std::printf("  %s=%g", counter.first.c_str(), counter.second);
+        }
+        std::printf("\n");
+    }
+    for (const std::string& failure : mFailures) {
+        std::printf("FAIL %s\n", failure.c_str());
+    }
+}
+
+bool BenchReport::writeJson(const std::string& filePath) const {
+    std::ofstream file(filePath);
+    if (!file) {
+        return false;
+    }
+
+    file.precision(12);
+    file << "{\"benchmarks\":[\n";
+    for (size_t i = 0; i < mResults.size(); i++) {
+        const BenchResult& result = mResults[i];
+        file << "  {\"name\":\"";
+        writeEscaped(file, result.name);
+        file << "\",\"iterations\":" << result.iterations << ",\"ns_per_iteration\":" << result.nsPerIteration;
+        for (const auto& counter : result.counters) {
+            file << ",\"";
+            writeEscaped(file, counter.first);
+            file << "\":" << counter.second;
+        }
+        file << "}" << (i + 1 < mResults.size() ? ",\n" : "\n");
+    }
+    file << "],\"failures\":[\n";
+    for (size_t i = 0; i < mFailures.size(); i++) {
+        file << "  \"";
+        writeEscaped(file, mFailures[i]);
+        file << "\"" << (i + 1 < mFailures.size() ? ",\n" : "\n");
+    }
+    file << "]}\n";
+
+    return static_cast<bool>(file);
+}
+
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    const char* jsonPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            sceneFrames = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else {
+            filter = argv[i];
+        }
+    }
+
+    BenchReport report;
+    for (const RegisteredBench& bench : getRegisteredBenches()) {
+        if (filter == nullptr || std::strstr(bench.name, filter) != nullptr) {
+            bench.function(report);
+        }
+    }
+
+    report.print();
+    if (jsonPath != nullptr && !report.writeJson(jsonPath)) {
+        std::fprintf(stderr, "Could not write %s\n", jsonPath);
+        return 1;
+    }
+
+    return report.getFailures().empty() ? 0 : 1;
+}
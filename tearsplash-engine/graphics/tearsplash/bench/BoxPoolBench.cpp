@@ -0,0 +1,80 @@
+// Spawning and destroying 10k dynamic boxes per second, in batches of one
+// 60 Hz frame, with BoxPool against creating and destroying Box2D bodies directly.
+
+#include <deque>
+
+#include <Tearsplash/Box.h>
+#include <Tearsplash/BoxPool.h>
+
+#include "Bench.h"
+
+using namespace TearsplashBench;
+
+namespace {
+    const size_t BOXES_PER_SECOND = 10000;
+    const size_t FRAMES_PER_SECOND = 60;
+    const size_t BOXES_PER_FRAME = BOXES_PER_SECOND / FRAMES_PER_SECOND;
+    // Boxes stay alive for this many frames before being destroyed.
+    const size_t LIFETIME_FRAMES = 30;
+
+    void fillBatch(std::vector<glm::vec2>& positions, std::vector<glm::vec2>& dimensions, const size_t frame) {
+        for (size_t i = 0; i < BOXES_PER_FRAME; i++) {
+            positions[i] = glm::vec2(static_cast<float>(i % 100) * 20.0f, static_cast<float>(frame % 50) * 20.0f);
+            // Two sizes, so shapes are shared and fixtures sometimes swapped.
+            dimensions[i] = (i % 8 == 0) ? glm::vec2(30.0f, 30.0f) : glm::vec2(15.0f, 15.0f);
+        }
+    }
+
+    void boxPoolBench(BenchReport& report) {
+        std::vector<glm::vec2> positions(BOXES_PER_FRAME);
+        std::vector<glm::vec2> dimensions(BOXES_PER_FRAME);
+        const uint64_t iterations = 5;
+
+        // One iteration is one second worth of frames.
+        b2World poolWorld(b2Vec2(0.0f, -9.81f));
+        Tearsplash::BoxPool pool;
+        pool.init(&poolWorld, BOXES_PER_FRAME * LIFETIME_FRAMES);
+        std::deque<std::vector<uint32_t>> liveBatches;
+        size_t poolFrame = 0;
+        const double poolNs = measureNs(iterations, [&]() {
+            for (size_t frame = 0; frame < FRAMES_PER_SECOND; frame++, poolFrame++) {
+                fillBatch(positions, dimensions, poolFrame);
+                liveBatches.emplace_back(BOXES_PER_FRAME);
+                pool.spawn(positions.data(), dimensions.data(), BOXES_PER_FRAME, b2_dynamicBody, liveBatches.back().data());
+
+                if (liveBatches.size() > LIFETIME_FRAMES) {
+                    for (const uint32_t handle : liveBatches.front()) {
+                        pool.destroy(handle);
+                    }
+                    liveBatches.pop_front();
+                }
+            }
+        });
+        report.add({ "boxes/pool_spawn_destroy_10k_per_second", iterations, poolNs,
+            { { "live", static_cast<double>(pool.size()) }, { "bodies", static_cast<double>(poolWorld.GetBodyCount()) } } });
+
+        b2World directWorld(b2Vec2(0.0f, -9.81f));
+        std::deque<std::vector<Tearsplash::Box>> liveBoxes;
+        size_t directFrame = 0;
+        const double directNs = measureNs(iterations, [&]() {
+            for (size_t frame = 0; frame < FRAMES_PER_SECOND; frame++, directFrame++) {
+                fillBatch(positions, dimensions, directFrame);
+                liveBoxes.emplace_back(BOXES_PER_FRAME);
+                for (size_t i = 0; i < BOXES_PER_FRAME; i++) {
+                    liveBoxes.back()[i].init(&directWorld, positions[i], dimensions[i], b2_dynamicBody);
+                }
+
+                if (liveBoxes.size() > LIFETIME_FRAMES) {
+                    for (Tearsplash::Box& box : liveBoxes.front()) {
+                        directWorld.DestroyBody(box.getBody());
+                    }
+                    liveBoxes.pop_front();
+                }
+            }
+        });
+        report.add({ "boxes/direct_create_destroy_10k_per_second", iterations, directNs,
+            { { "bodies", static_cast<double>(directWorld.GetBodyCount()) } } });
+    }
+}
+
+TEARSPLASH_BENCH("boxes", boxPoolBench);
@@ -0,0 +1,116 @@
+// View culling of 100k objects spread so that 5% of them are on screen.
+// Compares the per-object Camera2D::isInView loop MainGame used to run against
+// batch culling and a single spatial grid query.
+
+#include <cmath>
+#include <random>
+
+#include <Tearsplash/AABB.h>
+#include <Tearsplash/Camera2D.h>
+#include <Tearsplash/SpatialGrid.h>
+
+#include "Bench.h"
+
+using namespace TearsplashBench;
+
+namespace {
+    const size_t NUM_OBJECTS = 100000;
+    const float VISIBLE_FRACTION = 0.05f;
+    const int SCREEN_WIDTH = 1280;
+    const int SCREEN_HEIGHT = 720;
+    const glm::vec2 OBJECT_DIMS(30.0f, 30.0f);
+
+    struct Scene {
+        Tearsplash::Camera2D camera;
+        std::vector<glm::vec2> centers;
+        std::vector<Tearsplash::AABB> bounds;
+    };
+
+    Scene createScene() {
+        Scene scene;
+        scene.camera.init(SCREEN_WIDTH, SCREEN_HEIGHT);
+        scene.camera.update();
+
+        // A square world whose area is the view area divided by the visible fraction, with the camera in the middle.
+        const float worldSize = std::sqrt(SCREEN_WIDTH * SCREEN_HEIGHT / VISIBLE_FRACTION);
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> coordinate(-worldSize * 0.5f, worldSize * 0.5f);
+
+        scene.centers.resize(NUM_OBJECTS);
+        scene.bounds.resize(NUM_OBJECTS);
+        for (size_t i = 0; i < NUM_OBJECTS; i++) {
+            scene.centers[i] = glm::vec2(coordinate(rng), coordinate(rng));
+            scene.bounds[i] = Tearsplash::AABB::fromCenter(scene.centers[i], OBJECT_DIMS);
+        }
+        return scene;
+    }
+
+    void cullingBench(BenchReport& report) {
+        Scene scene = createScene();
+        const Tearsplash::AABB view = scene.camera.getViewAABB();
+        const uint64_t iterations = 200;
+
+        size_t numVisible = 0;
+        const double isInViewNs = measureNs(iterations, [&]() {
+            numVisible = 0;
+            for (size_t i = 0; i < NUM_OBJECTS; i++) {
+                numVisible += scene.camera.isInView(scene.centers[i], OBJECT_DIMS) ? 1 : 0;
+            }
+        });
+        report.add({ "culling/camera_is_in_view", iterations, isInViewNs, { { "visible", static_cast<double>(numVisible) } } });
+
+        const double scalarNs = measureNs(iterations, [&]() {
+            numVisible = 0;
+            for (size_t i = 0; i < NUM_OBJECTS; i++) {
+                numVisible += scene.bounds[i].overlaps(view) ? 1 : 0;
+            }
+        });
+        report.add({ "culling/aabb_scalar", iterations, scalarNs, { { "visible", static_cast<double>(numVisible) } } });
+
+        std::vector<uint32_t> mask(Tearsplash::cullMaskWords(NUM_OBJECTS));
+        const double batchNs = measureNs(iterations, [&]() {
+            Tearsplash::cullAABBs(scene.bounds.data(), NUM_OBJECTS, view, mask.data());
+            doNotOptimize(mask[0]);
+        });
+        numVisible = 0;
+        for (size_t i = 0; i < NUM_OBJECTS; i++) {
+            numVisible += Tearsplash::isMaskBitSet(mask.data(), i) ? 1 : 0;
+        }
+        report.add({ "culling/cull_aabbs_batch", iterations, batchNs, { { "visible", static_cast<double>(numVisible) } } });
+
+        // The same mask through the camera, using the view rect cached by update().
+        const double cameraBatchNs = measureNs(iterations, [&]() {
+            scene.camera.isInView(scene.bounds.data(), NUM_OBJECTS, mask.data());
+            doNotOptimize(mask[0]);
+        });
+        report.add({ "culling/camera_is_in_view_batch", iterations, cameraBatchNs, {} });
+
+        Tearsplash::SpatialGrid grid;
+        grid.init(128.0f);
+        std::vector<int> handles(NUM_OBJECTS);
+        for (size_t i = 0; i < NUM_OBJECTS; i++) {
+            handles[i] = grid.insert(scene.bounds[i], static_cast<uint32_t>(i));
+        }
+
+        std::vector<uint32_t> visible;
+        const double queryNs = measureNs(iterations, [&]() {
+            visible.clear();
+            grid.query(view, visible);
+        });
+        report.add({ "culling/spatial_grid_query", iterations, queryNs, { { "visible", static_cast<double>(visible.size()) } } });
+
+        // Every object moving a little per frame, the cost the grid adds to the simulation.
+        size_t frame = 0;
+        const double updateNs = measureNs(20, [&]() {
+            const glm::vec2 offset(frame++ % 2 == 0 ? 4.0f : -4.0f, 0.0f);
+            for (size_t i = 0; i < NUM_OBJECTS; i++) {
+                scene.bounds[i].min += offset;
+                scene.bounds[i].max += offset;
+                grid.update(handles[i], scene.bounds[i]);
+            }
+        });
+        report.add({ "culling/spatial_grid_update_all", 20, updateNs, {} });
+    }
+}
+
+TEARSPLASH_BENCH("culling", cullingBench);
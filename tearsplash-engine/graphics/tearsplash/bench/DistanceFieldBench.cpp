@@ -0,0 +1,59 @@
+// Generating signed distance fields for a printable ascii set at 48 px, as
+// Spritefont does at init in SIGNED_DISTANCE_FIELD mode. Glyphs are stand-in
+// rings of glyph-like sizes, FreeType isn't needed.
+
+#include <algorithm>
+#include <cmath>
+
+#include <Tearsplash/DistanceField.h>
+
+#include "Bench.h"
+
+using namespace TearsplashBench;
+
+namespace {
+    const int NUM_GLYPHS = 95;
+    const int SPREAD = 6;
+
+    struct Bitmap {
+        int width;
+        int height;
+        std::vector<unsigned char> pixels;
+    };
+
+    Bitmap makeRing(const int width, const int height) {
+        Bitmap bitmap = { width, height, std::vector<unsigned char>(static_cast<size_t>(width) * height) };
+        const float radius = std::min(width, height) * 0.5f;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                const float distance = std::hypot(x - width * 0.5f, y - height * 0.5f);
+                const bool stroke = distance < radius && distance > radius * 0.6f;
+                bitmap.pixels[y * width + x] = stroke ? 255 : 0;
+            }
+        }
+        return bitmap;
+    }
+
+    void distanceFieldBench(BenchReport& report) {
+        std::vector<Bitmap> glyphs;
+        for (int i = 0; i < NUM_GLYPHS; i++) {
+            glyphs.push_back(makeRing(16 + i % 20, 24 + i % 24));
+        }
+
+        std::vector<unsigned char> field;
+        size_t fieldBytes = 0;
+        const uint64_t iterations = 20;
+        const double ns = measureNs(iterations, [&]() {
+            fieldBytes = 0;
+            for (const Bitmap& glyph : glyphs) {
+                Tearsplash::generateSignedDistanceField(glyph.pixels.data(), glyph.width, glyph.height, glyph.width, SPREAD, field);
+                fieldBytes += field.size();
+                doNotOptimize(field[0]);
+            }
+        });
+        report.add({ "fonts/sdf_ascii_48px", iterations, ns,
+            { { "us_per_glyph", ns / NUM_GLYPHS / 1000.0 }, { "field_bytes", static_cast<double>(fieldBytes) } } });
+    }
+}
+
+TEARSPLASH_BENCH("fonts", distanceFieldBench);
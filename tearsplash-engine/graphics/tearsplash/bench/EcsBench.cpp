@@ -0,0 +1,59 @@
+// Iterating 100k entities spread over a few archetypes, directly and through the scheduler.
+
+#include <Tearsplash/ECSSystems.h>
+
+#include "Bench.h"
+
+using namespace TearsplashBench;
+
+namespace {
+    const size_t NUM_ENTITIES = 100000;
+
+    void ecsBench(BenchReport& report) {
+        Tearsplash::World world;
+        for (size_t i = 0; i < NUM_ENTITIES; i++) {
+            const Tearsplash::Entity entity = world.create();
+            world.add(entity, Tearsplash::makeTransform(glm::vec2(static_cast<float>(i), 0.0f)));
+            world.add(entity, Tearsplash::VelocityComponent{ glm::vec2(1.0f, 0.0f) });
+            // A second archetype so queries have to skip and combine archetypes.
+            if (i % 4 == 0) {
+                world.add(entity, Tearsplash::LifetimeComponent{ 1.0e9f });
+            }
+        }
+
+        const uint64_t iterations = 200;
+        const double integrateNs = measureNs(iterations, [&]() {
+            Tearsplash::integrateVelocities(world, 1.0f / 60.0f);
+        });
+        report.add({ "ecs/integrate_velocities", iterations, integrateNs, { { "entities", static_cast<double>(world.size()) } } });
+
+        Tearsplash::SystemScheduler scheduler;
+        scheduler.init(1);
+        scheduler.add("integrateVelocities",
+            Tearsplash::ComponentRegistry::mask<Tearsplash::VelocityComponent>(),
+            Tearsplash::ComponentRegistry::mask<Tearsplash::TransformComponent>(),
+            Tearsplash::integrateVelocities);
+        scheduler.add("updateLifetimes", 0,
+            Tearsplash::ComponentRegistry::mask<Tearsplash::LifetimeComponent>(),
+            Tearsplash::updateLifetimes);
+        const double scheduledNs = measureNs(iterations, [&]() {
+            scheduler.run(world, 1.0f / 60.0f);
+        });
+        report.add({ "ecs/scheduler_run", iterations, scheduledNs, { { "stages", static_cast<double>(scheduler.getNumStages()) } } });
+
+        const double createDestroyNs = measureNs(10, [&]() {
+            std::vector<Tearsplash::Entity> entities(10000);
+            for (Tearsplash::Entity& entity : entities) {
+                entity = world.create();
+                world.add(entity, Tearsplash::makeTransform(glm::vec2(0.0f)));
+                world.add(entity, Tearsplash::VelocityComponent{ glm::vec2(0.0f) });
+            }
+            for (const Tearsplash::Entity entity : entities) {
+                world.destroy(entity);
+            }
+        });
+        report.add({ "ecs/create_destroy_10k", 10, createDestroyNs, {} });
+    }
+}
+
+TEARSPLASH_BENCH("ecs", ecsBench);
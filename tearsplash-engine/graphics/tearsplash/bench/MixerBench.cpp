@@ -0,0 +1,104 @@
+// Mixing 256 looping voices into 48 kHz stereo with AudioMixer, headless, against
+// a plain scalar loop doing the same work. One iteration is one second of audio.
+
+#include <algorithm>
+#include <cmath>
+
+#include <Tearsplash/AudioMixer.h>
+
+#include "Bench.h"
+
+using namespace TearsplashBench;
+
+namespace {
+    const int SAMPLE_RATE = 48000;
+    const int BUFFER_FRAMES = 512;
+    const int NUM_VOICES = 256;
+    // Odd lengths, so loops wrap in the middle of buffers.
+    const size_t MONO_FRAMES = 12345;
+    const size_t STEREO_FRAMES = 23457;
+
+    std::vector<float> makeTone(const size_t numFrames, const int channels, const float frequency) {
+        std::vector<float> samples(numFrames * channels);
+        for (size_t frame = 0; frame < numFrames; frame++) {
+            const float value = 0.5f * std::sin(6.2831853f * frequency * static_cast<float>(frame) / SAMPLE_RATE);
+            for (int channel = 0; channel < channels; channel++) {
+                samples[frame * channels + channel] = value;
+            }
+        }
+        return samples;
+    }
+
+    void mixerBench(BenchReport& report) {
+        const std::vector<float> mono = makeTone(MONO_FRAMES, 1, 440.0f);
+        const std::vector<float> stereo = makeTone(STEREO_FRAMES, 2, 660.0f);
+        const uint64_t iterations = 10;
+        const int buffersPerSecond = SAMPLE_RATE / BUFFER_FRAMES;
+        std::vector<float> out(BUFFER_FRAMES * 2);
+
+        Tearsplash::AudioMixerConfig config;
+        config.sampleRate = SAMPLE_RATE;
+        config.bufferFrames = BUFFER_FRAMES;
+        config.maxVoices = NUM_VOICES;
+        config.openDevice = false;
+
+        Tearsplash::AudioMixer mixer;
+        mixer.init(config);
+        const Tearsplash::MixerSound* monoSound = mixer.createSound(mono.data(), MONO_FRAMES, 1);
+        const Tearsplash::MixerSound* stereoSound = mixer.createSound(stereo.data(), STEREO_FRAMES, 2);
+        for (int i = 0; i < NUM_VOICES; i++) {
+            const float pan = static_cast<float>(i) / NUM_VOICES * 2.0f - 1.0f;
+            mixer.play(i % 2 == 0 ? monoSound : stereoSound, 1.0f / NUM_VOICES, pan, true);
+        }
+
+        const double mixerNs = measureNs(iterations, [&]() {
+            for (int buffer = 0; buffer < buffersPerSecond; buffer++) {
+                mixer.mix(out.data(), BUFFER_FRAMES);
+            }
+            doNotOptimize(out[0]);
+        });
+        report.add({ "mixer/256_voices_48k_stereo_one_second", iterations, mixerNs,
+            { { "voices", static_cast<double>(mixer.getNumActiveVoices()) },
+              { "realtime_factor", 1e9 / mixerNs } } });
+
+        // The same voices, one sample at a time with a branch per channel layout.
+        struct ScalarVoice {
+            const std::vector<float>* samples;
+            int channels;
+            size_t numFrames;
+            size_t position;
+            float leftGain;
+            float rightGain;
+        };
+        std::vector<ScalarVoice> voices(NUM_VOICES);
+        for (int i = 0; i < NUM_VOICES; i++) {
+            const bool isMono = i % 2 == 0;
+            voices[i] = { isMono ? &mono : &stereo, isMono ? 1 : 2, isMono ? MONO_FRAMES : STEREO_FRAMES, 0,
+                0.7f / NUM_VOICES, 0.7f / NUM_VOICES };
+        }
+
+        const double scalarNs = measureNs(iterations, [&]() {
+            for (int buffer = 0; buffer < buffersPerSecond; buffer++) {
+                std::fill(out.begin(), out.end(), 0.0f);
+                for (ScalarVoice& voice : voices) {
+                    for (int frame = 0; frame < BUFFER_FRAMES; frame++) {
+                        const float* sample = voice.samples->data() + voice.position * voice.channels;
+                        out[frame * 2] += sample[0] * voice.leftGain;
+                        out[frame * 2 + 1] += sample[voice.channels - 1] * voice.rightGain;
+                        if (++voice.position == voice.numFrames) {
+                            voice.position = 0;
+                        }
+                    }
+                }
+                for (float& sample : out) {
+                    sample = std::min(std::max(sample, -1.0f), 1.0f);
+                }
+            }
+            doNotOptimize(out[0]);
+        });
+        report.add({ "mixer/scalar_256_voices_48k_stereo_one_second", iterations, scalarNs,
+            { { "realtime_factor", 1e9 / scalarNs } } });
+    }
+}
+
+TEARSPLASH_BENCH("mixer", mixerBench);
@@ -0,0 +1,133 @@
+// Replays the same scripted scene through PhysicsService serially and on its
+// stepping thread, with one and with four shards. The threaded runs must match
+// their serial run bit for bit, any mismatch fails the run. Impulses push through
+// the body center, the threaded game thread sees transforms a step later than a
+// serial one, so the script must not depend on them.
+
+#include <cstring>
+#include <random>
+
+#include <Tearsplash/PhysicsService.h>
+
+#include "Bench.h"
+
+using namespace TearsplashBench;
+
+namespace {
+    const size_t NUM_STEPS = 300;
+    const float TIME_STEP = 1.0f / 60.0f;
+
+    struct ReplayImpulse {
+        uint32_t handle;
+        glm::vec2 impulse;
+    };
+
+    // Everything queued before one step.
+    struct ReplayFrame {
+        std::vector<glm::vec2> spawns;
+        std::vector<ReplayImpulse> impulses;
+    };
+
+    std::vector<ReplayFrame> makeScript() {
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> randomX(-1000.0f, 1000.0f);
+        std::uniform_real_distribution<float> randomY(50.0f, 400.0f);
+        std::uniform_real_distribution<float> randomImpulse(-20000.0f, 20000.0f);
+
+        std::vector<ReplayFrame> script(NUM_STEPS);
+        uint32_t numSpawned = 0;
+        for (size_t step = 0; step < NUM_STEPS; step++) {
+            ReplayFrame& frame = script[step];
+            if (step % 10 == 0) {
+                for (int i = 0; i < 100; i++) {
+                    frame.spawns.emplace_back(randomX(random), randomY(random));
+                }
+            }
+            // Sideways pushes, so some boxes cross shard boundaries.
+            for (int i = 0; i < 5 && numSpawned > 0; i++) {
+                frame.impulses.push_back({ static_cast<uint32_t>(random() % numSpawned), glm::vec2(randomImpulse(random), 0.0f) });
+            }
+            numSpawned += static_cast<uint32_t>(frame.spawns.size());
+        }
+        return script;
+    }
+
+    Tearsplash::PhysicsServiceConfig makeConfig(const bool threaded, const int numShards) {
+        Tearsplash::PhysicsServiceConfig config;
+        config.threaded = threaded;
+        config.numShards = numShards;
+        config.shardOriginX = -1000.0f;
+        config.shardWidth = 2000.0f / numShards;
+        return config;
+    }
+
+    void runScript(Tearsplash::PhysicsService& physics, const std::vector<ReplayFrame>& script) {
+        physics.addStaticBox(glm::vec2(0.0f, -10.0f), glm::vec2(2400.0f, 15.0f));
+
+        std::vector<glm::vec2> dimensions;
+        std::vector<uint32_t> handles;
+        for (const ReplayFrame& frame : script) {
+            dimensions.assign(frame.spawns.size(), glm::vec2(15.0f, 15.0f));
+            handles.resize(frame.spawns.size());
+            physics.spawnBoxes(frame.spawns.data(), dimensions.data(), frame.spawns.size(), b2_dynamicBody, handles.data());
+            for (const ReplayImpulse& impulse : frame.impulses) {
+                physics.applyLinearImpulseToCenter(impulse.handle, impulse.impulse);
+            }
+            physics.step(TIME_STEP);
+        }
+        physics.finish();
+    }
+
+    size_t countMismatches(const std::vector<Tearsplash::PhysicsTransform>& expected, const std::vector<Tearsplash::PhysicsTransform>& actual) {
+        if (expected.size() != actual.size()) {
+            return expected.size() > actual.size() ? expected.size() : actual.size();
+        }
+        size_t mismatches = 0;
+        for (size_t i = 0; i < expected.size(); i++) {
+            if (std::memcmp(&expected[i], &actual[i], sizeof(Tearsplash::PhysicsTransform)) != 0) {
+                mismatches++;
+            }
+        }
+        return mismatches;
+    }
+
+    void physicsBench(BenchReport& report) {
+        const std::vector<ReplayFrame> script = makeScript();
+        const uint64_t iterations = 3;
+
+        for (const int numShards : { 1, 4 }) {
+            std::vector<Tearsplash::PhysicsTransform> serialTransforms;
+            Tearsplash::PhysicsService physics;
+
+            const double serialNs = measureNs(iterations, [&]() {
+                physics.init(makeConfig(false, numShards));
+                runScript(physics, script);
+                serialTransforms = physics.getTransforms();
+            });
+
+            std::vector<Tearsplash::PhysicsTransform> threadedTransforms;
+            uint64_t numMigrations = 0;
+            const double threadedNs = measureNs(iterations, [&]() {
+                physics.init(makeConfig(true, numShards));
+                runScript(physics, script);
+                threadedTransforms = physics.getTransforms();
+                numMigrations = physics.getNumMigrations();
+            });
+            physics.destroy();
+
+            const std::string suffix = std::to_string(numShards) + (numShards == 1 ? "_shard" : "_shards");
+            const size_t mismatches = countMismatches(serialTransforms, threadedTransforms);
+            report.add({ "physics/replay_serial_" + suffix, iterations, serialNs,
+                { { "bodies", static_cast<double>(serialTransforms.size()) } } });
+            report.add({ "physics/replay_threaded_" + suffix, iterations, threadedNs,
+                { { "mismatches", static_cast<double>(mismatches) },
+                  { "migrations", static_cast<double>(numMigrations) } } });
+            if (mismatches != 0) {
+                report.fail("physics/replay_threaded_" + suffix + ": " + std::to_string(mismatches) +
+                    " of " + std::to_string(serialTransforms.size()) + " transforms differ from the serial run");
+            }
+        }
+    }
+}
+
+TEARSPLASH_BENCH("physics", physicsBench);
@@ -0,0 +1,75 @@
+// One 60 Hz simulation step and one frame of draw data for 100k live
+// projectiles, against a world of boxes kept in a spatial grid.
+
+#include <random>
+
+#include <Tearsplash/ProjectilePool.h>
+
+#include "Bench.h"
+
+using namespace TearsplashBench;
+
+namespace {
+    const size_t NUM_PROJECTILES = 100000;
+    const size_t NUM_WORLD_BOXES = 2000;
+    const float WORLD_SIZE = 20000.0f;
+    const float TIME_STEP = 1.0f / 60.0f;
+
+    void projectileBench(BenchReport& report) {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> coordinate(-WORLD_SIZE * 0.5f, WORLD_SIZE * 0.5f);
+        std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+
+        Tearsplash::SpatialGrid world;
+        world.init(64.0f);
+        for (size_t i = 0; i < NUM_WORLD_BOXES; i++) {
+            world.insert(Tearsplash::AABB::fromCenter(glm::vec2(coordinate(rng), coordinate(rng)), glm::vec2(15.0f)), static_cast<uint32_t>(i));
+        }
+
+        Tearsplash::ProjectilePool pool;
+        pool.init(NUM_PROJECTILES, glm::vec2(30.0f), Tearsplash::GLTexture(), Tearsplash::ColorRGBA8(255, 255, 255, 255));
+        const auto refill = [&]() {
+            while (pool.spawn(glm::vec2(coordinate(rng), coordinate(rng)), glm::vec2(direction(rng), direction(rng)) * 600.0f, 16.0f)) {
+            }
+        };
+
+        const uint64_t iterations = 60;
+        std::vector<Tearsplash::ProjectileHit> hits;
+
+        refill();
+        const double updateNs = measureNs(iterations, [&]() {
+            pool.update(TIME_STEP);
+        });
+        report.add({ "projectiles/update", iterations, updateNs, { { "live", static_cast<double>(pool.size()) } } });
+
+        size_t numHits = 0;
+        const double collideNs = measureNs(iterations, [&]() {
+            refill();
+            hits.clear();
+            pool.collide(world, hits);
+            numHits += hits.size();
+        });
+        report.add({ "projectiles/collide", iterations, collideNs, { { "hits_per_step", static_cast<double>(numHits) / (iterations + 1) } } });
+
+        // A 1280x720 view in the middle of the world.
+        const Tearsplash::AABB view = Tearsplash::AABB::fromCenter(glm::vec2(0.0f), glm::vec2(1280.0f, 720.0f));
+        size_t numVisible = 0;
+        refill();
+        const double drawNs = measureNs(iterations, [&]() {
+            numVisible = pool.buildDrawData(view, 0.5f);
+        });
+        report.add({ "projectiles/build_draw_data", iterations, drawNs, { { "visible", static_cast<double>(numVisible) } } });
+
+        // Everything a fixed step at 60 Hz costs, to compare against the 16.7 ms budget.
+        const double stepNs = measureNs(iterations, [&]() {
+            refill();
+            pool.update(TIME_STEP);
+            hits.clear();
+            pool.collide(world, hits);
+            pool.buildDrawData(view, 0.5f);
+        });
+        report.add({ "projectiles/full_step", iterations, stepNs, { { "live", static_cast<double>(pool.size()) } } });
+    }
+}
+
+TEARSPLASH_BENCH("projectiles", projectileBench);
@@ -0,0 +1,293 @@
+// Scripted scenes rendered through a headless context for --frames frames each: a
+// storm of bouncing sprites, a storm of CPU and GPU particles and a wall of text.
+// A frame is timed from the start of its update to the end of its GPU work, so the
+// results include the driver and GPU, e.g. llvmpipe in CI. Run from the graphics
+// directory so shader and font paths resolve as they do for the game. Skipped when the
+// engine is built without TEARSPLASH_HEADLESS.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include <Tearsplash/Camera2D.h>
+#include <Tearsplash/GLTexture.h>
+#include <Tearsplash/GPUParticleBatch2D.h>
+#include <Tearsplash/ParticleBatch2D.h>
+#include <Tearsplash/ParticleEngine2D.h>
+#include <Tearsplash/ShaderProgram.h>
+#include <Tearsplash/Spritebatch.h>
+#include <Tearsplash/Spritefont.h>
+#include <Tearsplash/Tearsplash.h>
+#include <Tearsplash/TextLayout.h>
+#include <Tearsplash/Window.h>
+
+#include "Bench.h"
+
+using namespace TearsplashBench;
+
+namespace {
+    const int SCREEN_WIDTH = 1280;
+    const int SCREEN_HEIGHT = 720;
+    const float DELTA_TIME = 1.0f / 60.0f;
+    const uint64_t WARM_UP_FRAMES = 10;
+
+    const int NUM_SPRITES = 20000;
+    const int NUM_GPU_PARTICLES = 100000;
+    const int NUM_CPU_PARTICLES = 10000;
+    // Particles live two seconds, spawning this many per frame keeps the batches full.
+    const float PARTICLE_DECAY_RATE = 0.5f;
+    const int GPU_PARTICLES_PER_FRAME = NUM_GPU_PARTICLES / 120;
+    const int CPU_PARTICLES_PER_FRAME = NUM_CPU_PARTICLES / 120;
+    const int NUM_TEXT_LINES = 40;
+
+    bool headlessAvailable() {
+#ifdef TEARSPLASH_HEADLESS_EGL
+        return true;
+#else
+        std::printf("Scene benchmarks skipped, the engine was built without TEARSPLASH_HEADLESS\n");
+        return false;
+#endif
+    }
+
+    // The window, camera and sprite shader every scene draws with.
+    struct SceneContext {
+        Tearsplash::Window window;
+        Tearsplash::ShaderProgram colorShaders;
+        Tearsplash::Camera2D camera;
+
+        SceneContext() {
+            Tearsplash::init(true);
+            window.createWindow("tearsplash_bench", SCREEN_WIDTH, SCREEN_HEIGHT, Tearsplash::WindowFlags::HEADLESS);
+
+            colorShaders.compileShaders("shaders/colorShading.vert", "shaders/colorShading.frag");
+            colorShaders.addAttribute("vertexPosition");
+            colorShaders.addAttribute("vertexColor");
+            colorShaders.addAttribute("vertexUV");
+            colorShaders.linkShaders();
+
+            camera.init(SCREEN_WIDTH, SCREEN_HEIGHT);
+            camera.update();
+        }
+
+        // Binds the sprite shader with the camera's projection.
+        void useColorShaders() {
+            colorShaders.use();
+            glActiveTexture(GL_TEXTURE0);
+            glUniform1i(colorShaders.getUniformLocation("texSampler"), 0);
+            const glm::mat4 cameraMatrix = camera.getCameraMatrix();
+            glUniformMatrix4fv(colorShaders.getUniformLocation("P"), 1, GL_FALSE, &(cameraMatrix[0][0]));
+        }
+    };
+
+    Tearsplash::GLTexture createSolidTexture(const unsigned char gray) {
+        const unsigned char pixel[4] = { gray, gray, gray, 255 };
+        Tearsplash::GLTexture texture = { 0, 1, 1 };
+        glGenTextures(1, &texture.id);
+        glBindTexture(GL_TEXTURE_2D, texture.id);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+
+    glm::vec2 randomDirection(std::mt19937& rng) {
+        std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+        const float radians = angle(rng);
+        return glm::vec2(std::cos(radians), std::sin(radians));
+    }
+
+    // Runs frame for a few warm up frames and then getSceneFrames() timed ones. The
+    // result holds the mean frame time with percentiles as counters.
+    template<typename Frame>
+    BenchResult runScene(SceneContext& scene, const char* name, Frame frame) {
+        const uint64_t numFrames = getSceneFrames();
+        std::vector<double> frameNs;
+        frameNs.reserve(static_cast<size_t>(numFrames));
+
+        for (uint64_t i = 0; i < WARM_UP_FRAMES + numFrames; i++) {
+            const auto start = std::chrono::steady_clock::now();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            frame(i);
+            // Waits for the GPU when headless.
+            scene.window.swapBuffer();
+            const auto end = std::chrono::steady_clock::now();
+            if (i >= WARM_UP_FRAMES) {
+                frameNs.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+            }
+        }
+
+        BenchResult result = { name, numFrames, 0.0, {} };
+        if (frameNs.empty()) {
+            return result;
+        }
+
+        double totalNs = 0.0;
+        for (const double ns : frameNs) {
+            totalNs += ns;
+        }
+        result.nsPerIteration = totalNs / frameNs.size();
+
+        std::sort(frameNs.begin(), frameNs.end());
+        const auto percentileMs = [&frameNs](const double percentile) {
+            const size_t index = std::min(frameNs.size() - 1, static_cast<size_t>(percentile * frameNs.size()));
+            return frameNs[index] / 1.0e6;
+        };
+        result.counters.push_back({ "p50_ms", percentileMs(0.50) });
+        result.counters.push_back({ "p99_ms", percentileMs(0.99) });
+        result.counters.push_back({ "max_ms", frameNs.back() / 1.0e6 });
+        return result;
+    }
+
+    void spriteStormBench(BenchReport& report) {
+        if (!headlessAvailable()) {
+            return;
+        }
+
+        SceneContext scene;
+        const Tearsplash::GLTexture textures[] = { createSolidTexture(255), createSolidTexture(160) };
+        Tearsplash::Spritebatch spriteBatch;
+        spriteBatch.init();
+
+        // Sprites bounce around the view, spinning, split between two textures.
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> speed(50.0f, 200.0f);
+        const Tearsplash::AABB view = scene.camera.getViewAABB();
+        std::uniform_real_distribution<float> x(view.min.x, view.max.x);
+        std::uniform_real_distribution<float> y(view.min.y, view.max.y);
+        std::vector<glm::vec2> positions(NUM_SPRITES);
+        std::vector<glm::vec2> velocities(NUM_SPRITES);
+        for (int i = 0; i < NUM_SPRITES; i++) {
+            positions[i] = glm::vec2(x(rng), y(rng));
+            velocities[i] = randomDirection(rng) * speed(rng);
+        }
+
+        BenchResult result = runScene(scene, "scene/sprite_storm", [&](const uint64_t frame) {
+            for (int i = 0; i < NUM_SPRITES; i++) {
+                positions[i] += velocities[i] * DELTA_TIME;
+                if (positions[i].x < view.min.x || positions[i].x > view.max.x) {
+                    velocities[i].x = -velocities[i].x;
+                }
+                if (positions[i].y < view.min.y || positions[i].y > view.max.y) {
+                    velocities[i].y = -velocities[i].y;
+                }
+            }
+
+            scene.useColorShaders();
+            spriteBatch.begin(Tearsplash::GlyphSortType::TEXTURE);
+            const float angle = frame * DELTA_TIME;
+            for (int i = 0; i < NUM_SPRITES; i++) {
+                const Tearsplash::ColorRGBA8 color(static_cast<GLubyte>(i), static_cast<GLubyte>(i >> 8), 200, 255);
+                spriteBatch.draw(glm::vec4(positions[i] - 8.0f, 16.0f, 16.0f), glm::vec4(0.0f, 0.0f, 1.0f, 1.0f),
+                    textures[i & 1].id, 0, color, angle);
+            }
+            spriteBatch.end();
+            spriteBatch.renderBatch();
+            scene.colorShaders.dontuse();
+        });
+        result.counters.push_back({ "sprites", static_cast<double>(NUM_SPRITES) });
+        result.counters.push_back({ "draw_calls", static_cast<double>(spriteBatch.getNumBatches()) });
+        report.add(result);
+
+        for (const Tearsplash::GLTexture& texture : textures) {
+            glDeleteTextures(1, &texture.id);
+        }
+    }
+
+    void particleStormBench(BenchReport& report) {
+        if (!headlessAvailable()) {
+            return;
+        }
+
+        SceneContext scene;
+        Tearsplash::GLTexture texture = createSolidTexture(255);
+        Tearsplash::Spritebatch particleSpriteBatch;
+        particleSpriteBatch.init();
+
+        Tearsplash::ParticleBatch2D cpuParticles;
+        cpuParticles.init(NUM_CPU_PARTICLES, PARTICLE_DECAY_RATE, texture);
+        Tearsplash::GPUParticleBatch2D gpuParticles;
+        gpuParticles.init(NUM_GPU_PARTICLES, PARTICLE_DECAY_RATE, texture);
+
+        Tearsplash::ParticleEngine2D particleEngine;
+        particleEngine.addParticleBatch(cpuParticles, particleSpriteBatch);
+        particleEngine.addParticleBatch(gpuParticles);
+
+        // Two fountains, one per batch, spawning every frame.
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> speed(20.0f, 300.0f);
+        Tearsplash::ColorRGBA8 cpuColor(255, 0, 0, 255);
+        Tearsplash::ColorRGBA8 gpuColor(255, 128, 0, 255);
+
+        BenchResult result = runScene(scene, "scene/particle_storm", [&](const uint64_t) {
+            for (int i = 0; i < CPU_PARTICLES_PER_FRAME; i++) {
+                cpuParticles.addParticle(glm::vec2(-200.0f, 0.0f), randomDirection(rng) * speed(rng), cpuColor, 5.0f);
+            }
+            for (int i = 0; i < GPU_PARTICLES_PER_FRAME; i++) {
+                gpuParticles.addParticle(glm::vec2(200.0f, 0.0f), randomDirection(rng) * speed(rng), gpuColor, 2.0f);
+            }
+            particleEngine.updateBatches(DELTA_TIME);
+
+            scene.useColorShaders();
+            particleEngine.drawBatches(scene.camera.getCameraMatrix());
+            scene.colorShaders.dontuse();
+        });
+        result.counters.push_back({ "cpu_particles", static_cast<double>(NUM_CPU_PARTICLES) });
+        result.counters.push_back({ "gpu_particles", static_cast<double>(NUM_GPU_PARTICLES) });
+        report.add(result);
+
+        gpuParticles.destroy();
+        glDeleteTextures(1, &texture.id);
+    }
+
+    void textWallBench(BenchReport& report) {
+        if (!headlessAvailable()) {
+            return;
+        }
+
+        SceneContext scene;
+        Tearsplash::Spritefont font;
+        font.init("fonts/28_Days_Later.ttf", 0, 16);
+
+        // A screen full of static lines, laid out once, and a status line that changes every frame.
+        const float lineHeight = static_cast<float>(SCREEN_HEIGHT) / (NUM_TEXT_LINES + 1);
+        const glm::vec2 topLeft(SCREEN_WIDTH * -0.5f + 8.0f, SCREEN_HEIGHT * 0.5f - lineHeight);
+        std::vector<Tearsplash::TextLayout> lines(NUM_TEXT_LINES);
+        size_t numGlyphs = 0;
+        for (int line = 0; line < NUM_TEXT_LINES; line++) {
+            std::string text;
+            for (int i = 0; i < 120; i++) {
+                text += static_cast<char>(' ' + (line * 7 + i) % 95);
+            }
+            numGlyphs += text.size();
+            lines[line].set(text, topLeft - glm::vec2(0.0f, line * lineHeight), glm::vec3(1.0f), 1.0f);
+        }
+        Tearsplash::TextLayout status;
+
+        // Spritefont renders one layout per render().
+        size_t drawCalls = 0;
+        BenchResult result = runScene(scene, "scene/text_wall", [&](const uint64_t frame) {
+            const glm::mat4 cameraMatrix = scene.camera.getCameraMatrix();
+            drawCalls = 0;
+            for (Tearsplash::TextLayout& line : lines) {
+                font.drawText(line, cameraMatrix);
+                font.render();
+                drawCalls += font.getNumDrawCalls();
+            }
+            status.set("frame " + std::to_string(frame), glm::vec2(topLeft.x, SCREEN_HEIGHT * -0.5f + 4.0f), glm::vec3(1.0f, 1.0f, 0.0f), 1.0f);
+            font.drawText(status, cameraMatrix);
+            font.render();
+            drawCalls += font.getNumDrawCalls();
+        });
+        result.counters.push_back({ "glyphs", static_cast<double>(numGlyphs) });
+        result.counters.push_back({ "draw_calls", static_cast<double>(drawCalls) });
+        report.add(result);
+    }
+}
+
+TEARSPLASH_BENCH("scene/sprite_storm", spriteStormBench);
+TEARSPLASH_BENCH("scene/particle_storm", particleStormBench);
+TEARSPLASH_BENCH("scene/text_wall", textWallBench);
@@ -0,0 +1,99 @@
+// CPU side of drawing a 4096x4096 tile map at 1280x720 with 32 px tiles while the
+// camera pans and a few tiles change every frame. Chunked draws rebuild only the
+// chunks that changed, against rebuilding every visible tile's quad each frame as
+// a per tile Spritebatch pass would. GL calls aren't included, the rebuilds are.
+
+#include <Tearsplash/Camera2D.h>
+#include <Tearsplash/Tilemap.h>
+
+#include "Bench.h"
+
+using namespace TearsplashBench;
+
+namespace {
+    const int MAP_SIZE = 4096;
+    const float TILE_SIZE = 32.0f;
+    const int SCREEN_WIDTH = 1280;
+    const int SCREEN_HEIGHT = 720;
+    const int FRAMES = 600;
+    const int EDITS_PER_FRAME = 4;
+
+    void tilemapBench(BenchReport& report) {
+        Tearsplash::GLTexture texture = { 0, 256, 256 };
+        Tearsplash::Tilesheet tilesheet;
+        tilesheet.init(texture, glm::ivec3(8, 8, 0));
+
+        Tearsplash::Tilemap tilemap;
+        tilemap.init(&tilesheet, MAP_SIZE, MAP_SIZE, TILE_SIZE);
+        for (int y = 0; y < MAP_SIZE; y++) {
+            for (int x = 0; x < MAP_SIZE; x++) {
+                tilemap.setTile(x, y, static_cast<uint16_t>((x * 7 + y * 13) % tilesheet.getNumTiles()));
+            }
+        }
+
+        Tearsplash::Camera2D camera;
+        camera.init(SCREEN_WIDTH, SCREEN_HEIGHT);
+
+        // What draw() does on the CPU: find the visible chunks and rebuild the dirty ones.
+        std::vector<Tearsplash::Vertex> vertices;
+        std::vector<char> dirty(static_cast<size_t>(tilemap.getNumChunksX()) * tilemap.getNumChunksY(), 1);
+        const uint64_t iterations = 5;
+        size_t chunkFrame = 0;
+        size_t rebuilt = 0;
+        const double chunkedNs = measureNs(iterations, [&]() {
+            for (int frame = 0; frame < FRAMES; frame++, chunkFrame++) {
+                camera.setPosition(glm::vec2(2000.0f + chunkFrame * 4.0f, 2000.0f + chunkFrame * 2.0f));
+                camera.update();
+
+                for (int edit = 0; edit < EDITS_PER_FRAME; edit++) {
+                    const int x = static_cast<int>((camera.getPosition().x / TILE_SIZE) + edit * 3) % MAP_SIZE;
+                    const int y = static_cast<int>(camera.getPosition().y / TILE_SIZE) % MAP_SIZE;
+                    tilemap.setTile(x, y, static_cast<uint16_t>(chunkFrame % tilesheet.getNumTiles()));
+                    dirty[(y / 32) * tilemap.getNumChunksX() + x / 32] = 1;
+                }
+
+                glm::ivec2 first;
+                glm::ivec2 last;
+                if (tilemap.getVisibleChunks(camera.getViewAABB(), first, last)) {
+                    for (int chunkY = first.y; chunkY <= last.y; chunkY++) {
+                        for (int chunkX = first.x; chunkX <= last.x; chunkX++) {
+                            char& chunkDirty = dirty[chunkY * tilemap.getNumChunksX() + chunkX];
+                            if (chunkDirty) {
+                                tilemap.buildChunkVertices(chunkX, chunkY, vertices);
+                                doNotOptimize(vertices.data());
+                                chunkDirty = 0;
+                                rebuilt++;
+                            }
+                        }
+                    }
+                }
+            }
+        });
+        report.add({ "tilemap/chunked_4096x4096_600_frames", iterations, chunkedNs,
+            { { "us_per_frame", chunkedNs / FRAMES / 1000.0 }, { "chunks_rebuilt", static_cast<double>(rebuilt) } } });
+
+        // Every visible tile rebuilt every frame.
+        size_t allFrame = 0;
+        const double allNs = measureNs(iterations, [&]() {
+            for (int frame = 0; frame < FRAMES; frame++, allFrame++) {
+                camera.setPosition(glm::vec2(2000.0f + allFrame * 4.0f, 2000.0f + allFrame * 2.0f));
+                camera.update();
+
+                glm::ivec2 first;
+                glm::ivec2 last;
+                if (tilemap.getVisibleChunks(camera.getViewAABB(), first, last)) {
+                    for (int chunkY = first.y; chunkY <= last.y; chunkY++) {
+                        for (int chunkX = first.x; chunkX <= last.x; chunkX++) {
+                            tilemap.buildChunkVertices(chunkX, chunkY, vertices);
+                            doNotOptimize(vertices.data());
+                        }
+                    }
+                }
+            }
+        });
+        report.add({ "tilemap/rebuild_visible_4096x4096_600_frames", iterations, allNs,
+            { { "us_per_frame", allNs / FRAMES / 1000.0 } } });
+    }
+}
+
+TEARSPLASH_BENCH("tilemap", tilemapBench);
@@ -0,0 +1,49 @@
+#ifndef AABB_H
+#define AABB_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+namespace Tearsplash {
+
+    // Axis aligned bounding box. Kept at 16 bytes so four of them can be
+    // loaded and transposed into SIMD registers.
+    struct AABB {
+        glm::vec2 min;
+        glm::vec2 max;
+
+        // From a center position and full dimensions, as used by Camera2D::isInView.
+        static AABB fromCenter(const glm::vec2& center, const glm::vec2& dimensions) {
+            const glm::vec2 halfDims = dimensions * 0.5f;
+            return { center - halfDims, center + halfDims };
+        }
+
+        // From a Spritebatch destRect, i.e. bottom left corner and dimensions.
+        static AABB fromRect(const glm::vec4& destRect) {
+            return { glm::vec2(destRect.x, destRect.y), glm::vec2(destRect.x + destRect.z, destRect.y + destRect.w) };
+        }
+
+        bool overlaps(const AABB& other) const {
+            return min.x <= other.max.x && max.x >= other.min.x &&
+                   min.y <= other.max.y && max.y >= other.min.y;
+        }
+    };
+
+    // Number of 32 bit words needed for a bitmask with one bit per box.
+    inline size_t cullMaskWords(const size_t count) {
+        return (count + 31) / 32;
+    }
+
+    // Tests count boxes against view and sets bit i of outMask when box i overlaps it.
+    // outMask must hold cullMaskWords(count) words. Uses SSE when available.
+    void cullAABBs(const AABB* aabbs, const size_t count, const AABB& view, uint32_t* outMask);
+
+    inline bool isMaskBitSet(const uint32_t* mask, const size_t i) {
+        return (mask[i >> 5] >> (i & 31)) & 1u;
+    }
+
+}
+
+#endif // !AABB_H
@@ -6,20 +6,26 @@
 #include <SDL/SDL_mixer.h>
 #include <map>
 
+#include "Tearsplash/MusicStreamer.h"
+#include "Tearsplash/VoiceManager.h"
+
 namespace Tearsplash {
 
     class SoundEffect {
     public:
         friend class AudioEngine;
 
-        // Plays a sound effect on the default -1 channel.
+        // Plays a sound effect on a channel handed out by the engine's VoiceManager.
         // 0 plays the sound effect 1 time,
         // -1 plays the sound effect infinite amount of times,
         // n plays the sound effect n amounts of time.
-        void play(const int loop = 0);
+        // A higher priority may cut off lower priority sounds when every channel is busy.
+        // Returns the channel, or -1 if the sound was dropped.
+        int play(const int loop = 0, const int priority = 0);
 
     private:
-        Mix_Chunk* mChunk;
+        Mix_Chunk* mChunk = nullptr;
+        VoiceManager* mVoices = nullptr;
     };
 
     class Music {
@@ -28,7 +34,9 @@ namespace Tearsplash {
 
         // 1 plays the music infinite 1 time,
         // n plays the sound effect n amounts of time.
-        void play(const int loop = 1);
+        // Played through the engine's MusicStreamer, so it starts once the track is
+        // open and replaces whatever track the streamer is playing.
+        void play(const int loop = 1, const int fadeMs = 0);
 
         // Pauses the currently playing music.
         static void pause();
@@ -40,7 +48,8 @@ namespace Tearsplash {
         static void resume();
 
     private:
-        Mix_Music* mMusic;
+        std::string mFilePath;
+        MusicStreamer* mStreamer = nullptr;
     };
 
     class AudioEngine
@@ -49,16 +58,25 @@ namespace Tearsplash {
         AudioEngine();
         ~AudioEngine();
 
-        void init();
+        void init(const int numChannels = 32);
         void destroy();
 
+        // Call once per frame.
+        void update();
+
+        const VoiceManager& getVoiceManager() const { return mVoices; }
+        MusicStreamer& getMusicStreamer() { return mMusicStreamer; }
+
         SoundEffect loadSoundEffect(const std::string& filePath);
+        // Returns at once. The track is opened on the streamer's loader thread when
+        // played and freed when it stops.
         Music loadMusic(const std::string& filePath);
 
     private:
         bool mInitialized = false;
+        VoiceManager mVoices;
+        MusicStreamer mMusicStreamer;
         std::map<std::string, Mix_Chunk*> mEffectMap;
-        std::map<std::string, Mix_Music*> mMusicMap;
     };
 }
 
@@ -0,0 +1,131 @@
+#ifndef AUDIOMIXER_H
+#define AUDIOMIXER_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <SDL/SDL.h>
+
+#include "Tearsplash/SPSCQueue.h"
+
+namespace Tearsplash {
+
+    // Float PCM at the mixer's sample rate, decoded once at load time.
+    // Mono or stereo, stereo samples are interleaved.
+    struct MixerSound {
+        std::vector<float> samples;
+        int channels;
+        size_t numFrames;
+    };
+
+    struct AudioMixerConfig {
+        int sampleRate = 48000;
+        // Frames per SDL audio callback.
+        int bufferFrames = 512;
+        int maxVoices = 256;
+        // When false no audio device is opened and mix() is only called by hand,
+        // e.g. to benchmark it.
+        bool openDevice = true;
+    };
+
+    // Adds count frames of samples, scaled by leftGain and rightGain, into the
+    // interleaved stereo buffer out. channels is 1 or 2. Uses SSE when available.
+    void mixIntoStereo(float* out, const float* samples, const size_t count, const int channels, const float leftGain, const float rightGain);
+
+    // An in-engine alternative to SDL_mixer's channels. Voices are mixed into a float
+    // stereo buffer pulled by an SDL audio callback, with per voice gain and pan.
+    // The game thread sends play and stop commands over a lock free queue, so it
+    // never waits on the audio thread and the audio thread never locks.
+    class AudioMixer {
+    public:
+        typedef uint32_t VoiceHandle;
+        static const VoiceHandle NO_VOICE = 0;
+
+        AudioMixer();
+        ~AudioMixer();
+
+        void init(const AudioMixerConfig& config = AudioMixerConfig());
+        void destroy();
+
+        // Decodes a WAV file to the mixer's format. Cached by path.
+        const MixerSound* loadSound(const std::string& filePath);
+        // Copies numFrames frames of interleaved samples.
+        const MixerSound* createSound(const float* samples, const size_t numFrames, const int channels);
+
+        // Starts sound with gain and pan in [-1, 1], from left to right. Returns
+        // NO_VOICE if the command queue is full. A voice that finds every voice slot
+        // busy is dropped by the audio thread.
+        VoiceHandle play(const MixerSound* sound, const float gain = 1.0f, const float pan = 0.0f, const bool loop = false);
+        void stop(const VoiceHandle voice);
+        void setGainAndPan(const VoiceHandle voice, const float gain, const float pan);
+        void stopAll();
+
+        // Mixes numFrames frames of interleaved stereo into out. Called by the audio
+        // callback, or directly when no device is open. Not thread safe with itself.
+        void mix(float* out, const int numFrames);
+
+        int getSampleRate() const { return mConfig.sampleRate; }
+        int getNumActiveVoices() const { return mNumActiveVoices.load(std::memory_order_relaxed); }
+        uint64_t getNumDroppedVoices() const { return mNumDroppedVoices.load(std::memory_order_relaxed); }
+        // Time the last mix() call took.
+        uint32_t getLastMixMicroseconds() const { return mLastMixMicroseconds.load(std::memory_order_relaxed); }
+
+    private:
+        enum class CommandType {
+            PLAY,
+            STOP,
+            SET_GAIN_AND_PAN,
+            STOP_ALL
+        };
+
+        struct Command {
+            CommandType type;
+            VoiceHandle voice;
+            const MixerSound* sound;
+            float leftGain;
+            float rightGain;
+            bool loop;
+        };
+
+        struct Voice {
+            VoiceHandle handle;
+            const MixerSound* sound;
+            size_t position;
+            float leftGain;
+            float rightGain;
+            bool loop;
+        };
+
+        static void SDLCALL audioCallback(void* userData, Uint8* stream, int length);
+
+        bool pushCommand(const Command& command);
+        void processCommands();
+        // Index of voice in mVoices, or -1 if it isn't playing.
+        int findVoice(const VoiceHandle voice) const;
+
+        AudioMixerConfig mConfig;
+        SDL_AudioDeviceID mDevice;
+
+        // Game thread side.
+        std::vector<std::unique_ptr<MixerSound>> mSounds;
+        std::map<std::string, const MixerSound*> mSoundCache;
+        VoiceHandle mNextHandle;
+
+        SPSCQueue<Command, 1024> mCommands;
+
+        // Audio thread side. The first mNumVoices voices are playing.
+        std::vector<Voice> mVoices;
+        int mNumVoices;
+
+        std::atomic<int> mNumActiveVoices;
+        std::atomic<uint64_t> mNumDroppedVoices;
+        std::atomic<uint32_t> mLastMixMicroseconds;
+    };
+
+}
+
+#endif // !AUDIOMIXER_H
@@ -1,7 +1,7 @@
 #ifndef BOX_H
 #define BOX_H
 
-#include <Box2D/Box2D.h>
+#include <box2d/box2d.h>
 #include <glm/glm.hpp>
 
 namespace Tearsplash {
@@ -28,6 +28,8 @@ namespace Tearsplash {
         void init(b2World* physicsWorld, const glm::vec2& position, const glm::vec2& dimensions, const b2BodyType& dynamic = b2_staticBody);
 
     private:
+        friend class BoxPool;
+
         b2Body* mBody;
         b2Fixture* mFixture;
         glm::vec2 mDimensions;
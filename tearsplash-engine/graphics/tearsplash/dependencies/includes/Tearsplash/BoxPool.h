@@ -0,0 +1,66 @@
+#ifndef BOXPOOL_H
+#define BOXPOOL_H
+
+#include <cstdint>
+#include <vector>
+
+#include <box2d/box2d.h>
+#include <glm/glm.hpp>
+
+#include "Tearsplash/Box.h"
+
+namespace Tearsplash {
+
+    // Creates boxes in batches and recycles them. Destroyed boxes are disabled
+    // instead of removed from the b2World and handed out again by later spawns,
+    // so steady spawning and destroying doesn't go through Box2D's allocator.
+    // Boxes with the same dimensions share one b2PolygonShape.
+    class BoxPool {
+    public:
+        BoxPool();
+        ~BoxPool();
+
+        void init(b2World* physicsWorld, const size_t reserveBoxes = 0);
+
+        // Spawns count boxes, box i centered on positions[i] with dimensions[i].
+        // Writes the handle of each box to outHandles, which must hold count handles.
+        void spawn(const glm::vec2* positions,
+                   const glm::vec2* dimensions,
+                   const size_t count,
+                   const b2BodyType type,
+                   uint32_t* outHandles);
+
+        // Disables the body and keeps it for reuse. The handle may be returned by a later spawn.
+        void destroy(const uint32_t handle);
+
+        Box& getBox(const uint32_t handle) { return mBoxes[handle]; }
+        const Box& getBox(const uint32_t handle) const { return mBoxes[handle]; }
+        bool isAlive(const uint32_t handle) const { return mAlive[handle] != 0; }
+
+        // Handles range from 0 to capacity() - 1, including destroyed boxes.
+        size_t capacity() const { return mBoxes.size(); }
+        size_t size() const { return mBoxes.size() - mNumFree; }
+
+    private:
+        struct ShapeEntry {
+            glm::vec2 dimensions;
+            b2PolygonShape shape;
+            // Destroyed boxes with this shape, reused before anything else.
+            std::vector<uint32_t> freeHandles;
+        };
+
+        uint32_t findOrAddShape(const glm::vec2& dimensions);
+        uint32_t takeFreeHandle(const uint32_t shapeIndex);
+        void createBox(const uint32_t handle, const uint32_t shapeIndex, const glm::vec2& position, const b2BodyType type);
+
+        b2World* mPhysicsWorld;
+        std::vector<Box> mBoxes;
+        std::vector<uint32_t> mShapeIndices;
+        std::vector<uint8_t> mAlive;
+        std::vector<ShapeEntry> mShapes;
+        size_t mNumFree;
+    };
+
+}
+
+#endif // !BOXPOOL_H
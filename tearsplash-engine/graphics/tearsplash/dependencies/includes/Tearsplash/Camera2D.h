@@ -3,9 +3,14 @@
 #ifndef CAMERA2D_H
 #define CAMERA2D_H
 
+#include <cstddef>
+#include <cstdint>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "Tearsplash/AABB.h"
+
 namespace Tearsplash
 {
 
@@ -18,15 +23,30 @@ namespace Tearsplash
         void init(int screenWidth, int screenHeight);
         void update();
 
-        bool isInView(const glm::vec2& position, const glm::vec2& dimensions);
+        bool isInView(const glm::vec2& position, const glm::vec2& dimensions) const;
+        // Sets bit i of outMask when boxes[i] is in view, see cullAABBs.
+        void isInView(const AABB* boxes, const size_t count, uint32_t* outMask) const;
+
+        // World space rectangle seen by the camera as of the last update(), for querying
+        // a spatial index once per frame.
+        const AABB& getViewAABB() const { return mViewAABB; }
 
-        glm::vec2 convertScreen2World(glm::vec2& screenCoords);
+        // Screen coordinates are in pixels with the origin in the top left corner, as
+        // SDL reports the mouse. Both directions use the transforms cached by update().
+        glm::vec2 convertScreen2World(const glm::vec2& screenCoords) const;
+        glm::vec2 convertWorld2Screen(const glm::vec2& worldCoords) const;
+        // Converts count points at once, for picking against many entities. The output
+        // may alias the input.
+        void convertScreen2World(const glm::vec2* screenCoords, const size_t count, glm::vec2* outWorldCoords) const;
+        void convertWorld2Screen(const glm::vec2* worldCoords, const size_t count, glm::vec2* outScreenCoords) const;
 
         void setPosition(const glm::vec2& position) { mPosition = position; mNeedsMatrixUpdate = true; }
         void setScale(const float scale) { mScale = scale; mNeedsMatrixUpdate = true; }
 
         glm::vec2 getPosition() const { return mPosition; }
         glm::mat4 getCameraMatrix() const { return mCameraMatrix; }
+        // Maps clip space back to world space.
+        glm::mat4 getInverseCameraMatrix() const { return mInverseCameraMatrix; }
         float getScale() const { return mScale; }
 
 
@@ -36,8 +56,15 @@ namespace Tearsplash
         int       mScreenHeight;
         bool      mNeedsMatrixUpdate;
         glm::vec2 mPosition;
+        glm::vec2 mHalfViewDimensions;
         glm::mat4 mCameraMatrix;
+        glm::mat4 mInverseCameraMatrix;
         glm::mat4 mOrthoMatrix;
+        // 2D affine transforms between pixels and world space, folded from the camera
+        // matrix and the viewport so a point costs one multiply-add per axis.
+        glm::mat3 mWorldToScreen;
+        glm::mat3 mScreenToWorld;
+        AABB      mViewAABB;
 
     };
 }
@@ -0,0 +1,18 @@
+#ifndef DISTANCEFIELD_H
+#define DISTANCEFIELD_H
+
+#include <vector>
+
+namespace Tearsplash {
+
+    // Turns a coverage bitmap, such as a rendered glyph, into a signed distance
+    // field with spread pixels of margin on every side, so out holds
+    // (width + 2 * spread) x (height + 2 * spread) bytes. 128 is the edge, larger
+    // values are inside and the field saturates spread pixels away from the edge.
+    // Distances are exact Euclidean, from two separable passes per axis.
+    void generateSignedDistanceField(const unsigned char* coverage, const int width, const int height, const int pitch,
+                                     const int spread, std::vector<unsigned char>& out);
+
+}
+
+#endif // !DISTANCEFIELD_H
@@ -0,0 +1,246 @@
+#ifndef ECS_H
+#define ECS_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Tearsplash {
+
+    struct Entity {
+        uint32_t index;
+        // Bumped every time the index is reused, so stale handles can be detected.
+        uint32_t generation;
+
+        bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+        bool operator!=(const Entity& other) const { return !(*this == other); }
+    };
+
+    const Entity NULL_ENTITY = { UINT32_MAX, 0 };
+
+    // One bit per component type.
+    typedef uint64_t ComponentMask;
+    const uint32_t MAX_COMPONENT_TYPES = 64;
+
+    // Hands out a dense id to every component type the first time it is used.
+    class ComponentRegistry {
+    public:
+        // const T has the same id as T, so queries can ask for read only access.
+        template<typename T>
+        static uint32_t id() {
+            return typeId<typename std::remove_cv<T>::type>();
+        }
+
+        template<typename... Ts>
+        static ComponentMask mask() {
+            const ComponentMask bits[] = { ComponentMask(0), (ComponentMask(1) << id<Ts>())... };
+            ComponentMask result = 0;
+            for (const ComponentMask bit : bits) {
+                result |= bit;
+            }
+            return result;
+        }
+
+        static size_t getSize(const uint32_t id);
+        static size_t getAlignment(const uint32_t id);
+
+    private:
+        template<typename T>
+        static uint32_t typeId() {
+            static_assert(std::is_trivially_copyable<T>::value, "Components are moved between chunks with memcpy");
+            static const uint32_t sId = registerType(sizeof(T), alignof(T));
+            return sId;
+        }
+
+        static uint32_t registerType(const size_t size, const size_t alignment);
+    };
+
+    // Fixed size block holding the components of up to capacity entities of one archetype,
+    // one array per component type.
+    struct ArchetypeChunk {
+        std::unique_ptr<uint8_t[]> data;
+        uint32_t count;
+    };
+
+    // All entities with exactly the same set of components.
+    class Archetype {
+    public:
+        explicit Archetype(const ComponentMask mask);
+
+        bool hasComponent(const uint32_t componentId) const { return mColumns[componentId] >= 0; }
+        uint32_t getComponentSize(const uint32_t componentId) const { return mColumnSizes[mColumns[componentId]]; }
+
+        Entity* getEntities(ArchetypeChunk& chunk) const {
+            return reinterpret_cast<Entity*>(chunk.data.get());
+        }
+
+        void* getComponent(ArchetypeChunk& chunk, const uint32_t componentId, const uint32_t row) const {
+            return chunk.data.get() + mColumnOffsets[mColumns[componentId]] + row * mColumnSizes[mColumns[componentId]];
+        }
+
+        template<typename T>
+        T* getComponents(ArchetypeChunk& chunk) const {
+            return reinterpret_cast<T*>(chunk.data.get() + mColumnOffsets[mColumns[ComponentRegistry::id<T>()]]);
+        }
+
+        ComponentMask getMask() const { return mMask; }
+        uint32_t getChunkCapacity() const { return mChunkCapacity; }
+        std::vector<ArchetypeChunk>& getChunks() { return mChunks; }
+
+        // Appends a row to the last chunk, allocating a new chunk if it's full. Components are left uninitialized.
+        void allocateRow(const Entity entity, uint32_t& outChunk, uint32_t& outRow);
+
+        // Moves the last row into the removed one so chunks stay packed.
+        // Returns the entity that was moved, or NULL_ENTITY if the removed row was the last.
+        Entity removeRow(const uint32_t chunk, const uint32_t row);
+
+    private:
+        ComponentMask mMask;
+        // Column of every component type in the chunks, -1 if the archetype doesn't have it.
+        std::array<int, MAX_COMPONENT_TYPES> mColumns;
+        // Column 0 holds the entities, the rest follow in component id order.
+        std::vector<uint32_t> mColumnOffsets;
+        std::vector<uint32_t> mColumnSizes;
+        uint32_t mChunkCapacity;
+        uint32_t mChunkBytes;
+        std::vector<ArchetypeChunk> mChunks;
+    };
+
+    // Owns every entity and its components. Components are plain structs, stored
+    // per archetype in chunks so iterating a component set touches contiguous memory.
+    // Adding or removing components moves an entity to another archetype, so don't
+    // do it while iterating. Use queueDestroy to destroy entities from within a system.
+    class World {
+    public:
+        World();
+        ~World();
+
+        Entity create();
+        void destroy(const Entity entity);
+        bool isAlive(const Entity entity) const;
+
+        // Thread safe. Destroys the entity on the next flushDestroyed.
+        void queueDestroy(const Entity entity);
+        void flushDestroyed();
+
+        template<typename T>
+        T& add(const Entity entity, const T& component = T());
+
+        template<typename T>
+        void remove(const Entity entity);
+
+        template<typename T>
+        bool has(const Entity entity) const;
+
+        // Returns nullptr if the entity doesn't have the component.
+        // The pointer is invalidated when any entity of the same archetype is added or removed.
+        template<typename T>
+        T* get(const Entity entity);
+
+        // Calls function(count, entities, Ts* ...) for every chunk of every archetype that has all of Ts.
+        template<typename... Ts, typename Function>
+        void eachChunk(Function&& function);
+
+        // As eachChunk, skipping the archetypes that have any of the components in excluded.
+        template<typename... Ts, typename Function>
+        void eachChunkExcluding(const ComponentMask excluded, Function&& function);
+
+        // Calls function(entity, Ts& ...) for every entity that has all of Ts.
+        template<typename... Ts, typename Function>
+        void each(Function&& function);
+
+        size_t size() const { return mNumAlive; }
+
+    private:
+        struct EntityRecord {
+            Archetype* archetype;
+            uint32_t chunk;
+            uint32_t row;
+            uint32_t generation;
+        };
+
+        Archetype* getArchetype(const ComponentMask mask);
+        void moveEntity(const Entity entity, Archetype* archetype);
+        void removeFromArchetype(const EntityRecord& record);
+        void* getComponentPointer(const Entity entity, const uint32_t componentId);
+
+        std::vector<std::unique_ptr<Archetype>> mArchetypes;
+        std::unordered_map<ComponentMask, Archetype*> mArchetypesByMask;
+        std::vector<EntityRecord> mRecords;
+        std::vector<uint32_t> mFreeIndices;
+        size_t mNumAlive;
+
+        std::mutex mDestroyQueueMutex;
+        std::vector<Entity> mDestroyQueue;
+    };
+
+    template<typename T>
+    T& World::add(const Entity entity, const T& component) {
+        const uint32_t componentId = ComponentRegistry::id<T>();
+        const EntityRecord& record = mRecords[entity.index];
+        if (!record.archetype->hasComponent(componentId)) {
+            moveEntity(entity, getArchetype(record.archetype->getMask() | (ComponentMask(1) << componentId)));
+        }
+
+        T* destination = static_cast<T*>(getComponentPointer(entity, componentId));
+        *destination = component;
+        return *destination;
+    }
+
+    template<typename T>
+    void World::remove(const Entity entity) {
+        const uint32_t componentId = ComponentRegistry::id<T>();
+        const EntityRecord& record = mRecords[entity.index];
+        if (record.archetype->hasComponent(componentId)) {
+            moveEntity(entity, getArchetype(record.archetype->getMask() & ~(ComponentMask(1) << componentId)));
+        }
+    }
+
+    template<typename T>
+    bool World::has(const Entity entity) const {
+        return isAlive(entity) && mRecords[entity.index].archetype->hasComponent(ComponentRegistry::id<T>());
+    }
+
+    template<typename T>
+    T* World::get(const Entity entity) {
+        if (!has<T>(entity)) {
+            return nullptr;
+        }
+        return static_cast<T*>(getComponentPointer(entity, ComponentRegistry::id<T>()));
+    }
+
+    template<typename... Ts, typename Function>
+    void World::eachChunk(Function&& function) {
+        eachChunkExcluding<Ts...>(0, std::forward<Function>(function));
+    }
+
+    template<typename... Ts, typename Function>
+    void World::eachChunkExcluding(const ComponentMask excluded, Function&& function) {
+        const ComponentMask required = ComponentRegistry::mask<Ts...>();
+        for (const std::unique_ptr<Archetype>& archetype : mArchetypes) {
+            if ((archetype->getMask() & required) != required || (archetype->getMask() & excluded) != 0) {
+                continue;
+            }
+            for (ArchetypeChunk& chunk : archetype->getChunks()) {
+                function(static_cast<size_t>(chunk.count), archetype->getEntities(chunk), archetype->template getComponents<Ts>(chunk)...);
+            }
+        }
+    }
+
+    template<typename... Ts, typename Function>
+    void World::each(Function&& function) {
+        eachChunk<Ts...>([&function](const size_t count, const Entity* entities, Ts*... components) {
+            for (size_t i = 0; i < count; i++) {
+                function(entities[i], components[i]...);
+            }
+        });
+    }
+
+}
+
+#endif // !ECS_H
@@ -0,0 +1,57 @@
+#ifndef ECSCOMPONENTS_H
+#define ECSCOMPONENTS_H
+
+#include <cstdint>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "Tearsplash/Vertex.h"
+
+namespace Tearsplash {
+
+    // Center position and rotation in radians, with the values from the previous
+    // simulation step so drawing can interpolate between them.
+    struct TransformComponent {
+        glm::vec2 position;
+        glm::vec2 prevPosition;
+        float angle;
+        float prevAngle;
+    };
+
+    // Units per second.
+    struct VelocityComponent {
+        glm::vec2 velocity;
+    };
+
+    struct SpriteComponent {
+        glm::vec2 dimensions;
+        glm::vec4 uvRect;
+        GLuint texture;
+        int depth;
+        ColorRGBA8 color;
+    };
+
+    // Seconds left before the entity is destroyed.
+    struct LifetimeComponent {
+        float remaining;
+    };
+
+    // Index of the body's transform in the PhysicsRenderBridge or PhysicsService it
+    // follows. The body itself may live on another thread, so it isn't referenced.
+    struct PhysicsBodyComponent {
+        uint32_t physicsHandle;
+    };
+
+    // Handle of the SpriteAnimator player that sets the entity's SpriteComponent uvRect and texture.
+    struct AnimationComponent {
+        int animation;
+    };
+
+    inline TransformComponent makeTransform(const glm::vec2& position, const float angle = 0.0f) {
+        return { position, position, angle, angle };
+    }
+
+}
+
+#endif // !ECSCOMPONENTS_H
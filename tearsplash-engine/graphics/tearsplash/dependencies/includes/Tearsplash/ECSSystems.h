@@ -0,0 +1,46 @@
+#ifndef ECSSYSTEMS_H
+#define ECSSYSTEMS_H
+
+#include <vector>
+
+#include "Tearsplash/AABB.h"
+#include "Tearsplash/ECS.h"
+#include "Tearsplash/ECSComponents.h"
+#include "Tearsplash/PhysicsRenderBridge.h"
+#include "Tearsplash/SystemScheduler.h"
+
+namespace Tearsplash {
+
+    class Spritebatch;
+    class SpriteAnimator;
+
+    // Moves every entity with a velocity. Writes TransformComponent.
+    void integrateVelocities(World& world, const float deltaTime);
+
+    // Counts down lifetimes and queues expired entities for destruction.
+    void updateLifetimes(World& world, const float deltaTime);
+
+    // Copies the body transforms from physicsTransforms, the array published by a
+    // PhysicsRenderBridge or PhysicsService. Never reads the bodies themselves.
+    void syncPhysicsBodies(World& world, const std::vector<PhysicsTransform>& physicsTransforms);
+
+    // Copies the current frame of every animated entity into its SpriteComponent.
+    // Run after animator.update() and before drawSprites().
+    void applyAnimations(World& world, const SpriteAnimator& animator);
+
+    // Adds the sprites of every entity that overlaps view to spriteBatch, interpolated
+    // alpha of the way from their previous to their current transform. Entities with
+    // any of the components in excluded are skipped, e.g. those drawn by the overload below.
+    void drawSprites(World& world, Spritebatch& spriteBatch, const AABB& view, const float alpha, const ComponentMask excluded = 0);
+
+    // Adds the sprites of the given entities without culling them, for a visible set
+    // found by querying a spatial index with the view.
+    void drawSprites(World& world, Spritebatch& spriteBatch, const std::vector<Entity>& entities, const float alpha);
+
+    // Adds the simulation systems above to scheduler with their component access declared.
+    // physicsTransforms must outlive the scheduler.
+    void addDefaultSystems(SystemScheduler& scheduler, const std::vector<PhysicsTransform>& physicsTransforms);
+
+}
+
+#endif // !ECSSYSTEMS_H
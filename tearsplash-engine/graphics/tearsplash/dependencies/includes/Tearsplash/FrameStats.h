@@ -0,0 +1,70 @@
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Tearsplash {
+
+    // Summary of the frame times currently in a FrameStats ring, in milliseconds.
+    struct FrameStatsSummary {
+        float minMs = 0.0f;
+        float avgMs = 0.0f;
+        float p95Ms = 0.0f;
+        float p99Ms = 0.0f;
+        float maxMs = 0.0f;
+        float fps = 0.0f;
+        int numSamples = 0;
+    };
+
+    // Keeps the last NUM_SAMPLES frame times with microsecond resolution
+    // and derives statistics and a histogram from them.
+    class FrameStats {
+    public:
+        static const int NUM_SAMPLES = 256;
+        static const int NUM_HISTOGRAM_BUCKETS = 34;   // 0.0 - 33.0 ms in 1 ms buckets, the last one catches the rest.
+
+        FrameStats();
+        ~FrameStats();
+
+        void addSample(const uint64_t frameTimeMicroseconds);
+        void reset();
+
+        // The summary and histogram are recomputed lazily after new samples arrive.
+        const FrameStatsSummary& getSummary() const;
+        const std::array<float, NUM_HISTOGRAM_BUCKETS>& getHistogram() const;
+
+        // Width of each histogram bucket.
+        float getHistogramBucketMs() const { return 1.0f; }
+
+        // Returns the i:th oldest frame time still in the ring.
+        uint32_t getSampleMicroseconds(const int i) const;
+        int getNumSamples() const { return mNumSamples; }
+
+        // Draws the stats in a small ImGui overlay window. Must be called within an ImGui frame.
+        void drawImGuiOverlay(const char* title = "Frame stats") const;
+
+        // Draws the stats into the current ImGui window.
+        void drawImGui() const;
+
+        // Begins the overlay window used by drawImGuiOverlay, so more can be drawn next
+        // to the stats. Like ImGui::Begin, always pair it with ImGui::End.
+        static bool beginImGuiOverlay(const char* title = "Frame stats");
+
+    private:
+        void updateSummary() const;
+
+        std::array<uint32_t, NUM_SAMPLES> mFrameTimesUs;
+        int mNextSample;
+        int mNumSamples;
+
+        mutable bool mDirty;
+        mutable FrameStatsSummary mSummary;
+        mutable std::array<float, NUM_HISTOGRAM_BUCKETS> mHistogram;
+        mutable std::vector<uint32_t> mSortScratch;
+    };
+
+}
+
+#endif // !FRAMESTATS_H
@@ -0,0 +1,73 @@
+#ifndef GPUPARTICLEBATCH2D_H
+#define GPUPARTICLEBATCH2D_H
+
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "Tearsplash/GLTexture.h"
+#include "Tearsplash/ShaderProgram.h"
+#include "Tearsplash/Vertex.h"
+
+namespace Tearsplash {
+
+    // Particle state as it is laid out in the GPU buffers.
+    // Color is stored as floats since transform feedback can't write bytes.
+    struct GPUParticle2D {
+        glm::vec2 position;
+        glm::vec2 velocity;
+        glm::vec4 color;
+        float width;
+        float lifeTime;
+    };
+
+    // A particle batch that keeps all particle state in GL buffers.
+    // Particles are simulated in a vertex shader with transform feedback,
+    // ping-ponging between two buffers, and drawn straight from the buffer
+    // with a geometry shader. The CPU only uploads newly spawned particles.
+    // Requires an OpenGL 3.3 context.
+    class GPUParticleBatch2D {
+    public:
+        GPUParticleBatch2D();
+        ~GPUParticleBatch2D();
+
+        void init(const int numParticles, const float decayRate, Tearsplash::GLTexture& texture);
+        void destroy();
+
+        // Queues a particle for upload on the next update. Slots are handed out
+        // in a ring, so when the batch is full the oldest particle is overwritten.
+        void addParticle(const glm::vec2& position,
+                         const glm::vec2& velocity,
+                         ColorRGBA8& color,
+                         const float width,
+                         const float lifeTime = 1.0f);
+        void update(const float deltaTime);
+
+        // Draws the batch with its own shader. Leaves no shader program bound.
+        void draw(const glm::mat4& cameraMatrix);
+
+    private:
+        void createBuffers();
+        void initShaders();
+        void uploadSpawnedParticles();
+
+        Tearsplash::ShaderProgram mUpdateShader;
+        Tearsplash::ShaderProgram mRenderShader;
+        std::vector<GPUParticle2D> mSpawnQueue;
+        GLuint mVAOs[2];
+        GLuint mVBOs[2];
+        GLint mDeltaTimeLocation;
+        GLint mDecayRateLocation;
+        GLint mCameraMatrixLocation;
+        GLint mTextureLocation;
+        int mCurrentBuffer;
+        int mSpawnIndex;
+        float mDecayRate;
+        int mMaxParticles;
+        Tearsplash::GLTexture mTexture;
+    };
+
+}
+
+#endif // !GPUPARTICLEBATCH2D_H
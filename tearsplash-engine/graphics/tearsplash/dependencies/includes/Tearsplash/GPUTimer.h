@@ -0,0 +1,65 @@
+#ifndef GPUTIMER_H
+#define GPUTIMER_H
+
+#include <deque>
+#include <vector>
+
+#include <GL/glew.h>
+
+namespace Tearsplash {
+
+    struct GPUPassTime {
+        const char* name;
+        float ms;       // Time of the last frame that was read back
+        float avgMs;    // Exponential moving average
+    };
+
+    // Measures how long named render passes take on the GPU with GL_TIME_ELAPSED
+    // queries. Results are read back a few frames later, once the GPU has finished
+    // them, so measuring never stalls the CPU. Passes can't be nested since only one
+    // GL_TIME_ELAPSED query may be active at a time.
+    class GPUTimer {
+    public:
+        GPUTimer();
+        ~GPUTimer();
+
+        void destroy();
+
+        // Collects the results of every earlier frame the GPU has finished and starts
+        // a new frame. Call once per frame before the first pass.
+        void beginFrame();
+
+        // The name must be a string literal, only the pointer is stored.
+        void beginPass(const char* name);
+        void endPass();
+
+        // Pass times of the latest frame read back, in the order they were issued.
+        const std::vector<GPUPassTime>& getResults() const { return mResults; }
+
+        // Number of frames whose queries are still waiting on the GPU.
+        int getFramesInFlight() const { return static_cast<int>(mPendingFrames.size()); }
+
+        // Draws the pass times as ImGui text in the current window.
+        void drawImGui() const;
+
+    private:
+        struct PassQuery {
+            const char* name;
+            GLuint query;
+        };
+        typedef std::vector<PassQuery> FrameQueries;
+
+        GLuint acquireQuery();
+        bool isFrameAvailable(const FrameQueries& frame) const;
+        void readFrame(const FrameQueries& frame);
+
+        std::deque<FrameQueries> mPendingFrames;
+        std::vector<GLuint> mFreeQueries;
+        std::vector<GPUPassTime> mResults;
+        bool mPassActive;
+        bool mFirstFrameRead;
+    };
+
+}
+
+#endif // !GPUTIMER_H
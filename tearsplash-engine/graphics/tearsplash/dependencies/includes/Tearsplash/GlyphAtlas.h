@@ -0,0 +1,98 @@
+#ifndef GLYPHATLAS_H
+#define GLYPHATLAS_H
+
+#include <cstdint>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+namespace Tearsplash {
+
+    // Where a bitmap ended up in the atlas.
+    struct GlyphAtlasRegion {
+        GLuint texture;     // Page texture
+        int page;           // -1 for an empty bitmap, which takes no space
+        // The page's generation when the bitmap was added, see GlyphAtlas::isResident.
+        uint32_t generation;
+        // UVs for Spritebatch::draw, bottom left origin as 2DText.vert flips v.
+        glm::vec4 uvRect;
+    };
+
+    // Packs single channel bitmaps, such as font glyphs, into a few large GL_RED
+    // textures, so text sharing a page draws in one batch. Bitmaps go onto shelves,
+    // rows as tall as their first bitmap, and a new page is opened when one fills up.
+    // Once maxPages are open the least recently used page is cleared and reused,
+    // which evicts every bitmap on it.
+    class GlyphAtlas {
+    public:
+        GlyphAtlas();
+        ~GlyphAtlas();
+
+        // @param pageSize: Width and height of each page in pixels.
+        // @param padding: Empty pixels kept around each bitmap so linear filtering
+        //                 doesn't bleed in its neighbours.
+        // @param maxPages: Pages to open before evicting.
+        void init(const int pageSize = 1024, const int padding = 1, const int maxPages = 4);
+        void destroy();
+
+        // Copies a width x height bitmap, pitch bytes per row, into the atlas and
+        // returns where it went. Returns false if the bitmap is larger than a page, or
+        // if every page is full and was used this frame.
+        bool insert(const int width, const int height, const unsigned char* pixels, const int pitch, GlyphAtlasRegion& region);
+
+        // False once the region's page has been evicted.
+        bool isResident(const GlyphAtlasRegion& region) const {
+            return region.page < 0 || mPages[region.page].generation == region.generation;
+        }
+
+        // Marks the page as used this frame, so it is the last to be evicted.
+        void touch(const int page) {
+            if (page >= 0) {
+                mPages[page].lastUsedFrame = mFrame;
+            }
+        }
+
+        // Call once per frame, after the frame's text was drawn.
+        void newFrame() { mFrame++; }
+
+        int getNumPages() const { return static_cast<int>(mPages.size()); }
+        int getPageSize() const { return mPageSize; }
+        // Grows every time a page is evicted, anything laid out before is stale.
+        uint32_t getNumEvictions() const { return mNumEvictions; }
+
+    private:
+        struct Shelf {
+            int y;
+            int height;
+            int x;  // Next free column
+        };
+
+        struct Page {
+            GLuint texture;
+            std::vector<Shelf> shelves;
+            int nextShelfY;
+            uint32_t generation;
+            uint64_t lastUsedFrame;
+        };
+
+        // Finds room for a width x height block on page, returns false if there is none.
+        bool allocate(Page& page, const int width, const int height, int& x, int& y);
+        void addPage();
+        // Clears the least recently used page and makes it the one being filled.
+        // Returns false if every page was used this frame.
+        bool evictPage();
+
+        std::vector<Page> mPages;
+        // The page new bitmaps go onto, the others filled up before it.
+        int mCurrentPage;
+        int mPageSize;
+        int mPadding;
+        int mMaxPages;
+        uint64_t mFrame;
+        uint32_t mNumEvictions;
+    };
+
+}
+
+#endif // !GLYPHATLAS_H
@@ -0,0 +1,41 @@
+#ifndef HEADLESSCONTEXT_H
+#define HEADLESSCONTEXT_H
+
+#include <GL/glew.h>
+
+namespace Tearsplash {
+
+    // A GL 3.2 core context with no window, for benchmarks and rendering on machines
+    // without a display. Uses an EGL surfaceless context where the driver supports
+    // one, such as Mesa's llvmpipe, and a small pbuffer otherwise. Rendering goes to
+    // an offscreen framebuffer of the requested size, bound in place of a default
+    // framebuffer. Only available when built with TEARSPLASH_HEADLESS_EGL.
+    class HeadlessContext {
+    public:
+        HeadlessContext();
+        ~HeadlessContext();
+
+        // Creates the context and makes it current. Returns false if EGL or a suitable
+        // context isn't available.
+        bool create();
+        // Creates and binds the offscreen framebuffer. Needs GL functions loaded, i.e. call after glewInit.
+        void initFramebuffer(const int width, const int height);
+        void destroy();
+
+        bool isCreated() const { return mContext != nullptr; }
+        GLuint getFramebuffer() const { return mFramebuffer; }
+
+    private:
+        // EGL handles, kept opaque so EGL headers stay out of engine headers.
+        void* mDisplay;
+        void* mSurface;
+        void* mContext;
+
+        GLuint mFramebuffer;
+        GLuint mColorBuffer;
+        GLuint mDepthBuffer;
+    };
+
+}
+
+#endif // !HEADLESSCONTEXT_H
@@ -3,38 +3,77 @@
 #ifndef INPUTMANAGER_H
 #define INPUTMANAGER_H
 
-#include <unordered_map>
+#include <cstdint>
+#include <vector>
+
 #include <glm/glm.hpp>
 
 namespace Tearsplash
 {
+    // Key and button state as one bit per key. Keys are SDL scancodes, mouse buttons
+    // come after them, see mouseButton(). IDs past NUM_KEYS are ignored.
+    // Each frame's edges come from XOR-ing the current state with the previous
+    // frame's, so the cost of update() and of every query is the same regardless of
+    // how many keys have been used.
     class InputManager
     {
     public:
+        // SDL_NUM_SCANCODES, followed by room for the mouse buttons.
+        static const unsigned int MOUSE_BUTTON_OFFSET = 512;
+        static const unsigned int NUM_KEYS = 576;
+
+        // Key ID of an SDL mouse button, e.g. SDL_BUTTON_LEFT.
+        static unsigned int mouseButton(const unsigned int button) { return MOUSE_BUTTON_OFFSET + button; }
+
         InputManager();
         ~InputManager();
 
+        // Call once per frame before handling the frame's events.
         void update();
 
         void pressKey(const unsigned int keyID);
         void releaseKey(const unsigned int keyID);
         void setMouseCoords(const float x, const float y);
 
-        // Returns whether keyID is pressed or not, provided that it exists in mKeyMap
-        bool isKeyPressed(const unsigned int keyID);
-        bool isKeyDown(const unsigned int keyID);
+        // Down this frame.
+        bool isKeyDown(const unsigned int keyID) const;
+        // Went down this frame.
+        bool isKeyPressed(const unsigned int keyID) const;
+        // Went up this frame.
+        bool isKeyReleased(const unsigned int keyID) const;
+        // Down this frame and the last.
+        bool isKeyHeld(const unsigned int keyID) const;
+
+        // Actions are IDs picked by the game, e.g. from an enum, bound to any number of
+        // keys. An action is down while any of its keys are down.
+        void bindAction(const unsigned int actionID, const unsigned int keyID);
+        void unbindAction(const unsigned int actionID);
+        bool isActionDown(const unsigned int actionID) const;
+        bool isActionPressed(const unsigned int actionID) const;
+        bool isActionReleased(const unsigned int actionID) const;
+        bool isActionHeld(const unsigned int actionID) const;
 
         // Returns mouse coordinates
         glm::vec2 getMouseCoords() const { return mMouseCoords; }
 
     private:
-        bool wasKeyDown(const unsigned int keyID);
+        static const unsigned int NUM_WORDS = NUM_KEYS / 64;
 
-        std::unordered_map<unsigned int, bool> mKeyMap;
-        std::unordered_map<unsigned int, bool> mPrevKeyMap;
-        glm::vec2 mMouseCoords;
+        struct KeyBits
+        {
+            uint64_t words[NUM_WORDS];
+        };
+
+        static bool testBit(const KeyBits& bits, const unsigned int keyID);
+        // Whether any key in mask is set in bits.
+        static bool testAny(const KeyBits& bits, const KeyBits& mask);
 
+        KeyBits mKeys;
+        KeyBits mPrevKeys;
+        // Keys bound to each action, indexed by action ID.
+        std::vector<KeyBits> mActionMasks;
+        glm::vec2 mMouseCoords;
     };
 }
 
-#endif // !INPUTMANAGER_H
\ No newline at end of file
+#endif // !INPUTMANAGER_H
@@ -0,0 +1,95 @@
+#ifndef INPUTRECORDING_H
+#define INPUTRECORDING_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <SDL/SDL.h>
+
+namespace Tearsplash {
+
+    // The parts of an input event the game reacts to.
+    struct RecordedInputEvent {
+        enum class Kind : uint8_t {
+            KEY_DOWN,
+            KEY_UP,
+            MOUSE_MOTION,
+            MOUSE_BUTTON_DOWN,
+            MOUSE_BUTTON_UP
+        };
+
+        uint32_t frame;
+        Kind kind;
+        // Scancode for keys, button for mouse buttons.
+        uint32_t code;
+        int32_t x;
+        int32_t y;
+    };
+
+    // Records the input events handled each frame and the simulation steps each
+    // frame took, together with the random seed the run used, so InputReplay can
+    // play the run back exactly.
+    // Log format, little endian:
+    //   "TSIR", version byte, seed u32, number of frames u32, number of events u32,
+    //   then per event: frame delta varint, kind byte, code varint, and for mouse
+    //   events x and y as zigzag varints. Then the step counts, run length encoded:
+    //   number of runs u32, then per run: number of frames varint, steps byte.
+    class InputRecorder {
+    public:
+        InputRecorder();
+        ~InputRecorder();
+
+        void begin(const uint32_t seed);
+
+        // Keeps event if it's a kind the log holds, returns whether it did.
+        bool record(const uint32_t frame, const SDL_Event& event);
+
+        // Call once per frame, in order, with the simulation steps the frame took.
+        void recordSteps(const int steps);
+
+        // Writes the log, covering every frame passed to recordSteps.
+        // Returns false if the file couldn't be written.
+        bool save(const std::string& filePath) const;
+
+        size_t getNumEvents() const { return mEvents.size(); }
+
+    private:
+        uint32_t mSeed;
+        std::vector<RecordedInputEvent> mEvents;
+        std::vector<uint8_t> mFrameSteps;
+    };
+
+    // Plays back a log written by InputRecorder as SDL events, frame by frame.
+    class InputReplay {
+    public:
+        InputReplay();
+        ~InputReplay();
+
+        // Returns false if the file couldn't be read or isn't an input log.
+        bool load(const std::string& filePath);
+
+        // Fills event with the next recorded event of frame and returns true, or
+        // returns false once frame has no events left. Frames must be polled in order.
+        bool poll(const uint32_t frame, SDL_Event& event);
+
+        // True once every recorded frame has been played.
+        bool isFinished(const uint32_t frame) const { return frame >= mNumFrames; }
+
+        // Simulation steps frame took when it was recorded.
+        int getSteps(const uint32_t frame) const { return frame < mFrameSteps.size() ? mFrameSteps[frame] : 1; }
+
+        uint32_t getSeed() const { return mSeed; }
+        uint32_t getNumFrames() const { return mNumFrames; }
+
+    private:
+        uint32_t mSeed;
+        uint32_t mNumFrames;
+        std::vector<RecordedInputEvent> mEvents;
+        std::vector<uint8_t> mFrameSteps;
+        size_t mNextEvent;
+    };
+
+}
+
+#endif // !INPUTRECORDING_H
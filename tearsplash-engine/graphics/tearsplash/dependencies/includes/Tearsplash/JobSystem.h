@@ -0,0 +1,53 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Tearsplash {
+
+    // A fixed set of worker threads that split parallel loops between them.
+    // Workers sleep between loops, so unlike std::async no thread is created per job.
+    class JobSystem {
+    public:
+        typedef std::function<void(const size_t index)> Job;
+
+        JobSystem();
+        ~JobSystem();
+
+        void init(const size_t numWorkers);
+        void destroy();
+
+        // Calls job once for every index in [0, count) and returns when all calls are done.
+        // The calling thread takes jobs too. Indices are handed out in order, but may finish
+        // in any order. Only one thread at a time may call parallelFor.
+        void parallelFor(const size_t count, const Job& job);
+
+        size_t getNumWorkers() const { return mWorkers.size(); }
+
+    private:
+        void workerLoop();
+        void runJobs();
+
+        std::vector<std::thread> mWorkers;
+        std::mutex mMutex;
+        std::condition_variable mWakeCondition;
+        std::condition_variable mDoneCondition;
+        // Changes every loop, so workers can tell a new loop from a spurious wake up.
+        uint64_t mGeneration;
+        size_t mNumActiveWorkers;
+        bool mQuit;
+
+        const Job* mJob;
+        size_t mJobCount;
+        std::atomic<size_t> mNextIndex;
+    };
+
+}
+
+#endif // !JOBSYSTEM_H
@@ -0,0 +1,88 @@
+#ifndef MUSICSTREAMER_H
+#define MUSICSTREAMER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <SDL/SDL_mixer.h>
+
+namespace Tearsplash {
+
+    // Plays one music track at a time without stalling the game thread. Tracks are
+    // opened on a loader thread, then SDL_mixer streams them from disk while they
+    // play, so a long track never sits decoded in memory. Switching tracks fades the
+    // old one out and the new one in, and a track is freed as soon as it stops.
+    // It owns SDL_mixer's single music channel, AudioEngine's Music plays through it.
+    // Music::stop, pause and resume act on the channel directly, the streamer frees
+    // a track halted that way on its next update.
+    class MusicStreamer {
+    public:
+        MusicStreamer();
+        ~MusicStreamer();
+
+        // Starts the loader thread. Call after Mix_OpenAudio.
+        void init();
+        // Halts the music and frees every track. Call before Mix_CloseAudio.
+        void destroy();
+
+        // Returns at once. When the track is open the current one fades out over fadeMs
+        // and the new one fades in over fadeMs. loops is as for Mix_FadeInMusic, -1 loops
+        // forever. A later play or stop cancels a track still loading.
+        void play(const std::string& filePath, const int loops = -1, const int fadeMs = 1000);
+        void stop(const int fadeMs = 1000);
+
+        // Call once per frame. Starts tracks that finished loading and frees the ones
+        // that stopped.
+        void update();
+
+        bool isLoading() const { return mLoading; }
+        // Empty when nothing is playing or fading in.
+        const std::string& getCurrentTrack() const { return mCurrentPath; }
+
+    private:
+        struct LoadRequest {
+            uint32_t id;
+            std::string filePath;
+        };
+
+        struct LoadResult {
+            uint32_t id;
+            std::string filePath;
+            Mix_Music* music;
+            std::string error;
+        };
+
+        void loaderLoop();
+        // Frees every track that is neither playing nor waiting to play.
+        void freeStoppedTracks();
+
+        // Game thread side.
+        Mix_Music* mCurrent;
+        std::string mCurrentPath;
+        Mix_Music* mNext;
+        std::string mNextPath;
+        int mNextLoops;
+        int mFadeMs;
+        // Tracks fading out, freed once SDL_mixer is done with them.
+        std::vector<Mix_Music*> mFadingOut;
+        // Only the result of the latest request is played, the rest are freed.
+        uint32_t mLatestRequest;
+        bool mLoading;
+
+        // Shared with the loader thread.
+        std::thread mLoader;
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::deque<LoadRequest> mRequests;
+        std::vector<LoadResult> mResults;
+        bool mQuit;
+    };
+
+}
+
+#endif // !MUSICSTREAMER_H
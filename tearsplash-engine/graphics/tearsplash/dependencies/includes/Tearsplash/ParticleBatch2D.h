@@ -3,7 +3,7 @@
 
 #include "Tearsplash/Particle2D.h"
 #include "Tearsplash/Spritebatch.h"
-#include "Tearsplash/GlTexture.h"
+#include "Tearsplash/GLTexture.h"
 
 namespace Tearsplash {
 
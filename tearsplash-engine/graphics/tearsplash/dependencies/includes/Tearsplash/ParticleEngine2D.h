@@ -4,6 +4,7 @@
 #include <utility>
 
 #include "Tearsplash/ParticleBatch2D.h"
+#include "Tearsplash/GPUParticleBatch2D.h"
 
 namespace Tearsplash {
     class ParticleEngine2D {
@@ -12,12 +13,19 @@ namespace Tearsplash {
         ~ParticleEngine2D();
 
         void addParticleBatch(Tearsplash::ParticleBatch2D& pb, Spritebatch& sb);
+
+        // GPU batches simulate and draw themselves, so they don't need a Spritebatch.
+        void addParticleBatch(Tearsplash::GPUParticleBatch2D& pb);
         void updateBatches(const float deltaTime);
-        void drawBatches() const;
+
+        // CPU batches are drawn with the currently bound shader program, GPU batches
+        // with their own, which is why they are drawn last.
+        void drawBatches(const glm::mat4& cameraMatrix) const;
 
 
     private:
         std::vector<std::pair<Tearsplash::ParticleBatch2D&, Tearsplash::Spritebatch&>> mBatches;
+        std::vector<Tearsplash::GPUParticleBatch2D*> mGPUBatches;
     };
 }
 
@@ -0,0 +1,59 @@
+#ifndef PHYSICSRENDERBRIDGE_H
+#define PHYSICSRENDERBRIDGE_H
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class b2Body;
+
+namespace Tearsplash {
+
+    // Body state after the last two physics steps.
+    struct PhysicsTransform {
+        glm::vec2 position;
+        glm::vec2 prevPosition;
+        float angle;
+        float prevAngle;
+    };
+
+    // Copies body positions and angles out of Box2D into one contiguous array after
+    // every step, so rendering never touches the bodies. Sleeping bodies are skipped,
+    // after the step a body falls asleep in only its awake flag is read.
+    class PhysicsRenderBridge {
+    public:
+        PhysicsRenderBridge();
+        ~PhysicsRenderBridge();
+
+        // Returns the slot of the body's transform. Slots are handed out in order and never move.
+        uint32_t add(b2Body* body);
+        void clear();
+
+        // Call after every b2World::Step.
+        void sync();
+
+        const PhysicsTransform& getTransform(const uint32_t slot) const { return mTransforms[slot]; }
+        const std::vector<PhysicsTransform>& getTransforms() const { return mTransforms; }
+
+        // Slots whose transform was updated by the last sync.
+        const std::vector<uint32_t>& getMovedSlots() const { return mMovedSlots; }
+
+        static glm::vec2 interpolatePosition(const PhysicsTransform& transform, const float alpha) {
+            return glm::mix(transform.prevPosition, transform.position, alpha);
+        }
+        static float interpolateAngle(const PhysicsTransform& transform, const float alpha) {
+            return glm::mix(transform.prevAngle, transform.angle, alpha);
+        }
+
+    private:
+        std::vector<b2Body*> mBodies;
+        std::vector<PhysicsTransform> mTransforms;
+        // Set once a sleeping body's final state has been copied.
+        std::vector<uint8_t> mSettled;
+        std::vector<uint32_t> mMovedSlots;
+    };
+
+}
+
+#endif // !PHYSICSRENDERBRIDGE_H
@@ -0,0 +1,189 @@
+#ifndef PHYSICSSERVICE_H
+#define PHYSICSSERVICE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <box2d/box2d.h>
+#include <glm/glm.hpp>
+
+#include "Tearsplash/Box.h"
+#include "Tearsplash/BoxPool.h"
+#include "Tearsplash/JobSystem.h"
+#include "Tearsplash/PhysicsRenderBridge.h"
+
+namespace Tearsplash {
+
+    struct PhysicsServiceConfig {
+        b2Vec2 gravity = b2Vec2(0.0f, -9.81f);
+        int velocityIterations = 6;
+        int positionIterations = 2;
+
+        // Step on a dedicated thread, one step behind the game thread. When false every
+        // step runs to completion inside step(), on the calling thread.
+        bool threaded = true;
+
+        // The world is split into numShards vertical strips of shardWidth, the first one
+        // starting at shardOriginX, each with its own b2World. Bodies left of the first
+        // or right of the last strip belong to the outermost shards. Bodies in different
+        // shards never collide, so shards suit regions that don't interact.
+        int numShards = 1;
+        float shardOriginX = 0.0f;
+        float shardWidth = 1000.0f;
+        // How far past a strip boundary a body must move before it migrates, so bodies
+        // resting on a boundary don't bounce between shards.
+        float migrationMargin = 1.0f;
+    };
+
+    // Owns the physics simulation and steps it off the game thread. All changes to
+    // the simulation are queued and applied at the start of the next step, in order.
+    // The game thread reads the body transforms published by the last finished step,
+    // indexed by the handle returned when the body was spawned. Handles are not
+    // reused until the step that destroyed their body has been published.
+    // Shards are stepped in parallel by a JobSystem. Everything else a step does runs
+    // in handle order on one thread, so a threaded run gives the same results, bit
+    // for bit, as stepping the same commands serially.
+    class PhysicsService {
+    public:
+        PhysicsService();
+        ~PhysicsService();
+
+        void init(const PhysicsServiceConfig& config);
+        // Waits for the step in flight and destroys the worlds.
+        void destroy();
+
+        // Static boxes aren't tracked by handle and are added to every shard.
+        void addStaticBox(const glm::vec2& position, const glm::vec2& dimensions);
+
+        // Spawns count boxes, box i centered on positions[i] with dimensions[i]. Writes
+        // the handle of each box to outHandles, which must hold count handles. The
+        // transforms are published right away, at the spawn position.
+        void spawnBoxes(const glm::vec2* positions,
+                        const glm::vec2* dimensions,
+                        const size_t count,
+                        const b2BodyType type,
+                        uint32_t* outHandles);
+        // Each handle may only be destroyed once.
+        void destroyBox(const uint32_t handle);
+        void applyLinearImpulse(const uint32_t handle, const glm::vec2& impulse, const glm::vec2& point);
+        // Pushes the body through its center of mass, so the impulse doesn't depend on
+        // where the body is when the command runs.
+        void applyLinearImpulseToCenter(const uint32_t handle, const glm::vec2& impulse);
+
+        // Waits for the step in flight and publishes its results, then starts a step of
+        // timeStep with everything queued since. Returns right away when threaded.
+        void step(const float timeStep);
+        // Waits for the step in flight and publishes its results.
+        void finish();
+
+        const PhysicsTransform& getTransform(const uint32_t handle) const { return mTransforms[handle]; }
+        // The same vector for the life of the service, indexed by handle.
+        const std::vector<PhysicsTransform>& getTransforms() const { return mTransforms; }
+        const glm::vec2& getDimensions(const uint32_t handle) const { return mDimensions[handle]; }
+        // Handles whose transform changed in the last published step.
+        const std::vector<uint32_t>& getMovedHandles() const { return mMovedHandles; }
+
+        int getNumShards() const { return static_cast<int>(mShards.size()); }
+        // Bodies that changed shard, as of the last published step.
+        uint64_t getNumMigrations() const { return mNumMigrations; }
+
+    private:
+        enum class CommandType {
+            ADD_STATIC_BOXES,
+            SPAWN_BOXES,
+            DESTROY_BOX,
+            APPLY_LINEAR_IMPULSE,
+            APPLY_LINEAR_IMPULSE_TO_CENTER
+        };
+
+        struct Command {
+            CommandType type;
+            // Handle the command applies to, unused by box commands.
+            uint32_t handle;
+            // Box commands read count handles, positions and dimensions starting at dataIndex.
+            uint32_t count;
+            uint32_t dataIndex;
+            b2BodyType bodyType;
+            glm::vec2 impulse;
+            glm::vec2 point;
+        };
+
+        struct CommandBuffer {
+            std::vector<Command> commands;
+            std::vector<uint32_t> handles;
+            std::vector<glm::vec2> positions;
+            std::vector<glm::vec2> dimensions;
+            // Handles destroyed by these commands, free again once their step is published.
+            std::vector<uint32_t> destroyedHandles;
+
+            void clear();
+        };
+
+        struct Shard {
+            std::unique_ptr<b2World> world;
+            BoxPool boxes;
+            std::vector<Box> staticBoxes;
+        };
+
+        // Where a handle's body currently lives. Only touched by the stepping thread.
+        struct BodyRecord {
+            int shard;
+            uint32_t poolHandle;
+            uint8_t alive;
+            // Set once a sleeping body's final state has been copied.
+            uint8_t settled;
+        };
+
+        void threadLoop();
+        void waitForStep();
+        void publish();
+
+        // Everything below runs on the stepping thread.
+        void runStep();
+        void applyCommands();
+        void spawnBodies(const Command& command);
+        void migrateAndSync();
+        b2Body* migrateBody(BodyRecord& record, b2Body* body, const int targetShard);
+        int findShard(const float x) const;
+
+        PhysicsServiceConfig mConfig;
+        std::vector<std::unique_ptr<Shard>> mShards;
+        JobSystem mJobs;
+
+        // Game thread side.
+        CommandBuffer mPendingCommands;
+        std::vector<PhysicsTransform> mTransforms;
+        std::vector<glm::vec2> mDimensions;
+        std::vector<uint32_t> mMovedHandles;
+        std::vector<uint32_t> mFreeHandles;
+        uint64_t mNumMigrations;
+
+        // Stepping thread side. The game thread only touches these while no step is in flight.
+        CommandBuffer mSubmittedCommands;
+        float mTimeStep;
+        std::vector<BodyRecord> mBodies;
+        std::vector<PhysicsTransform> mSimTransforms;
+        std::vector<uint32_t> mSimMovedHandles;
+        uint64_t mSimNumMigrations;
+        // Set when a finished step hasn't been published yet.
+        bool mHasResults;
+        // Scratch for spawning one batch per shard.
+        std::vector<glm::vec2> mBatchPositions;
+        std::vector<glm::vec2> mBatchDimensions;
+        std::vector<uint32_t> mBatchHandles;
+        std::vector<uint32_t> mBatchPoolHandles;
+
+        std::thread mThread;
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        bool mStepInFlight;
+        bool mQuit;
+    };
+
+}
+
+#endif // !PHYSICSSERVICE_H
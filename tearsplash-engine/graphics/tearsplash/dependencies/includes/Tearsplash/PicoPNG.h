@@ -3,6 +3,7 @@
 #ifndef PICOPNG_H
 #define PICOPNG_H
 
+#include <cstddef>
 #include <vector>
 
 namespace Tearsplash
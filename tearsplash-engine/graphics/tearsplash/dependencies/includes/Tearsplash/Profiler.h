@@ -0,0 +1,111 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Profiling is on in debug builds and compiled out in release builds, unless
+// TEARSPLASH_PROFILE is defined to 0 or 1 by the build.
+#ifndef TEARSPLASH_PROFILE
+#ifdef NDEBUG
+#define TEARSPLASH_PROFILE 0
+#else
+#define TEARSPLASH_PROFILE 1
+#endif
+#endif
+
+#define TS_PROFILE_CONCAT_IMPL(a, b) a##b
+#define TS_PROFILE_CONCAT(a, b) TS_PROFILE_CONCAT_IMPL(a, b)
+
+#if TEARSPLASH_PROFILE
+// Times the enclosing scope. The name must be a string literal, only the pointer is stored.
+#define TS_PROFILE_SCOPE(name) Tearsplash::ProfileScope TS_PROFILE_CONCAT(tsProfileScope, __LINE__)(name)
+// Marks the start of a new frame. Call once per frame from the main thread.
+#define TS_PROFILE_FRAME() Tearsplash::Profiler::newFrame()
+#else
+#define TS_PROFILE_SCOPE(name) do {} while (0)
+#define TS_PROFILE_FRAME() do {} while (0)
+#endif
+
+namespace Tearsplash {
+
+    struct ProfileEvent {
+        const char* name;
+        int64_t startNs;
+        int64_t endNs;
+        int depth;
+    };
+
+    // Fixed size ring of finished events. Only the owning thread writes to it,
+    // readers on other threads pick up everything published before the write index.
+    // Every slot is a small seqlock, so a reader racing the writer around the ring
+    // skips the slots being overwritten instead of copying them torn.
+    class ProfileThreadBuffer {
+    public:
+        static const uint64_t CAPACITY = 1 << 16;
+
+        explicit ProfileThreadBuffer(const uint32_t threadIndex);
+
+        void push(const ProfileEvent& event);
+
+        // Appends the events that overlap [fromNs, toNs] to out.
+        void collect(const int64_t fromNs, const int64_t toNs, std::vector<ProfileEvent>& out) const;
+
+        uint32_t getThreadIndex() const { return mThreadIndex; }
+
+        // Nesting depth of the currently open scopes on the owning thread.
+        int depth;
+
+    private:
+        struct Slot {
+            // Ring index + 1 of the event held, 0 while the slot is being written.
+            std::atomic<uint64_t> sequence;
+            std::atomic<const char*> name;
+            std::atomic<int64_t> startNs;
+            std::atomic<int64_t> endNs;
+            std::atomic<int> depth;
+        };
+
+        uint32_t mThreadIndex;
+        std::vector<Slot> mSlots;
+        std::atomic<uint64_t> mWriteIndex;
+    };
+
+    class Profiler {
+    public:
+        // Monotonic time in nanoseconds.
+        static int64_t now();
+
+        static void newFrame();
+
+        // Writes every event still held in the thread buffers as Chrome trace_event
+        // JSON, viewable in chrome://tracing or Perfetto. Returns false if the
+        // file couldn't be opened.
+        static bool writeChromeTrace(const std::string& filePath);
+
+        // Draws the last finished frame as a flame graph, one lane per thread.
+        // Must be called within an ImGui frame.
+        static void drawImGuiFlameGraph();
+
+        // Buffer of the calling thread, taken the first time a thread asks for it. A
+        // buffer holds CAPACITY events (about 2.5 MB) and is reused by a new thread once
+        // its thread exits, it is never freed.
+        static ProfileThreadBuffer& getThreadBuffer();
+    };
+
+    class ProfileScope {
+    public:
+        explicit ProfileScope(const char* name);
+        ~ProfileScope();
+
+    private:
+        ProfileThreadBuffer& mBuffer;
+        const char* mName;
+        int64_t mStartNs;
+    };
+
+}
+
+#endif // !PROFILER_H
@@ -0,0 +1,78 @@
+#ifndef PROJECTILEPOOL_H
+#define PROJECTILEPOOL_H
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Tearsplash/AABB.h"
+#include "Tearsplash/GLTexture.h"
+#include "Tearsplash/SpatialGrid.h"
+#include "Tearsplash/Spritebatch.h"
+#include "Tearsplash/Vertex.h"
+
+namespace Tearsplash {
+
+    struct ProjectileHit {
+        glm::vec2 position;
+        glm::vec2 velocity;
+        // userData of the grid entry that was hit.
+        uint32_t userData;
+    };
+
+    // Projectiles that share a size and texture, stored as one array per field
+    // so updating and culling them streams through memory. Projectiles have no
+    // identity, removing one moves the last projectile into its slot.
+    class ProjectilePool {
+    public:
+        ProjectilePool();
+        ~ProjectilePool();
+
+        void init(const size_t maxProjectiles, const glm::vec2& size, const GLTexture& texture, const ColorRGBA8& color);
+
+        // Position is the bottom left corner of the sprite, velocity is in units per second
+        // and lifeTime in seconds. Returns false if the pool is full.
+        bool spawn(const glm::vec2& position, const glm::vec2& velocity, const float lifeTime);
+        void clear();
+
+        // Moves every projectile and removes the ones whose lifetime ran out.
+        void update(const float deltaTime);
+
+        // Removes every projectile that overlaps an entry in world and appends a hit for it to outHits.
+        void collide(const SpatialGrid& world, std::vector<ProjectileHit>& outHits);
+
+        // Culls against view and builds the sprite rectangles of the visible projectiles,
+        // interpolated alpha of the way from their previous to their current position.
+        // Returns the number of visible projectiles.
+        size_t buildDrawData(const AABB& view, const float alpha);
+
+        // Adds the rectangles from the last buildDrawData to spriteBatch.
+        void draw(Spritebatch& spriteBatch, const int depth = 0) const;
+
+        size_t size() const { return mPositions.size(); }
+        size_t capacity() const { return mMaxProjectiles; }
+
+    private:
+        void removeDead();
+
+        std::vector<glm::vec2> mPositions;
+        std::vector<glm::vec2> mPrevPositions;
+        std::vector<glm::vec2> mVelocities;
+        std::vector<float> mLifeTimes;
+        // Bounds swept from the previous to the current position, refreshed by update.
+        std::vector<AABB> mBounds;
+
+        std::vector<uint32_t> mCullMask;
+        std::vector<glm::vec4> mDestRects;
+        std::vector<uint32_t> mHitCandidates;
+
+        size_t mMaxProjectiles;
+        glm::vec2 mSize;
+        GLTexture mTexture;
+        ColorRGBA8 mColor;
+    };
+
+}
+
+#endif // !PROJECTILEPOOL_H
@@ -0,0 +1,87 @@
+#ifndef RENDERLAYER_H
+#define RENDERLAYER_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "Tearsplash/AABB.h"
+
+namespace Tearsplash {
+
+    class Spritebatch;
+
+    // A fixed region of world space rendered into an offscreen texture, for content
+    // that rarely changes such as backgrounds and static geometry. The layer is only
+    // redrawn after part of it was invalidated, and then only that part, and is
+    // otherwise composited as a single quad every frame.
+    //
+    //     if (layer.isDirty()) {
+    //         const glm::mat4 projection = layer.begin();
+    //         // Set projection on the shader and draw whatever overlaps layer.getDirtyRect().
+    //         layer.end();
+    //     }
+    //     layer.draw(spriteBatch);
+    //
+    // The texture holds premultiplied alpha, so render the quad with
+    // glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA).
+    class RenderLayer {
+    public:
+        RenderLayer();
+        ~RenderLayer();
+
+        // Covers bounds with pixelsPerUnit texels per world unit, grown to a whole number of
+        // texels. The whole layer starts dirty.
+        void init(const AABB& bounds, const float pixelsPerUnit = 1.0f);
+        void destroy();
+
+        // Marks the whole layer, or the texels region touches, for redrawing. Regions
+        // invalidated before the next redraw are merged into one rect.
+        void invalidate();
+        void invalidate(const AABB& region);
+
+        bool isDirty() const { return mDirtyMin.x < mDirtyMax.x && mDirtyMin.y < mDirtyMax.y; }
+        // World space rect covering the dirty texels. Everything overlapping it has to be
+        // redrawn between begin() and end().
+        AABB getDirtyRect() const;
+
+        // Makes the layer the render target, clears its dirty texels and limits drawing
+        // to them. Returns the projection from world space to the layer.
+        glm::mat4 begin();
+        // Restores the previous render target and state and marks the layer clean.
+        void end();
+
+        // Adds the layer texture as one quad covering its bounds.
+        void draw(Spritebatch& spriteBatch, const int depth = 0) const;
+
+        GLuint getTexture() const { return mTexture; }
+        const AABB& getBounds() const { return mBounds; }
+        int getWidth() const { return mWidth; }
+        int getHeight() const { return mHeight; }
+        // Times begin() was called, i.e. how often the layer was actually redrawn.
+        int getNumRedraws() const { return mNumRedraws; }
+
+    private:
+        GLuint mFramebuffer;
+        GLuint mTexture;
+        int mWidth;
+        int mHeight;
+        AABB mBounds;
+        float mPixelsPerUnit;
+
+        // Dirty texels, max exclusive. Empty when min >= max.
+        glm::ivec2 mDirtyMin;
+        glm::ivec2 mDirtyMax;
+        int mNumRedraws;
+
+        // State replaced by begin() and put back by end().
+        GLint mPrevFramebuffer;
+        GLint mPrevViewport[4];
+        GLfloat mPrevClearColor[4];
+        GLint mPrevBlend[4];
+        GLint mPrevScissorBox[4];
+        GLboolean mPrevScissorTest;
+    };
+
+}
+
+#endif // !RENDERLAYER_H
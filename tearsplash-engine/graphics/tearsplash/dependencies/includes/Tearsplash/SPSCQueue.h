@@ -0,0 +1,52 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+namespace Tearsplash {
+
+    // Fixed size lock free queue for exactly one producer thread and one consumer
+    // thread. Neither side ever blocks or allocates, so it is safe to use from an
+    // audio callback. Capacity must be a power of two.
+    template<typename T, size_t Capacity>
+    class SPSCQueue {
+        static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "SPSCQueue capacity must be a power of two");
+
+    public:
+        SPSCQueue() : mHead(0), mTail(0) {}
+
+        // Producer side. Returns false, dropping item, when the queue is full.
+        bool push(const T& item) {
+            const size_t tail = mTail.load(std::memory_order_relaxed);
+            if (tail - mHead.load(std::memory_order_acquire) == Capacity) {
+                return false;
+            }
+            mItems[tail & (Capacity - 1)] = item;
+            mTail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side. Returns false when the queue is empty.
+        bool pop(T& item) {
+            const size_t head = mHead.load(std::memory_order_relaxed);
+            if (head == mTail.load(std::memory_order_acquire)) {
+                return false;
+            }
+            item = mItems[head & (Capacity - 1)];
+            mHead.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        // Head and tail are written by different threads, keep them on separate cache lines.
+        std::atomic<size_t> mHead;
+        char mHeadPadding[64 - sizeof(std::atomic<size_t>)];
+        std::atomic<size_t> mTail;
+        char mTailPadding[64 - sizeof(std::atomic<size_t>)];
+        T mItems[Capacity];
+    };
+
+}
+
+#endif // !SPSCQUEUE_H
@@ -4,6 +4,7 @@
 #define SHADERPROGRAM_H
 
 #include <string>
+#include <vector>
 #include <GL/glew.h>
 
 namespace Tearsplash
@@ -17,6 +18,12 @@ namespace Tearsplash
 
 		// Functions
 		void compileShaders(const std::string &vertexShaderFilePath, const std::string &fragmentShaderFilePath);
+		void compileShaders(const std::string &vertexShaderFilePath, const std::string &geometryShaderFilePath, const std::string &fragmentShaderFilePath);
+		void compileShaders(const std::string &vertexShaderFilePath);
+
+		// Captures the named vertex shader outputs interleaved into a transform feedback
+		// buffer. Must be called before linkShaders.
+		void setTransformFeedbackVaryings(const std::vector<const char*>& varyings);
 		void linkShaders();
 		void addAttribute(const std::string& attributeName);
 		void use();
@@ -28,8 +35,10 @@ namespace Tearsplash
 		int	   mNumAttributes;
 		GLuint mProgramID;
 		GLuint mVertexShaderID;
+		GLuint mGeometryShaderID;
 		GLuint mFragmentShaderID;
 
+		GLuint createShader(GLenum shaderType);
 		void compileShader(const std::string& shaderFilePath, GLuint id);
 	};
 
@@ -0,0 +1,78 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Tearsplash/AABB.h"
+
+namespace Tearsplash {
+
+    // Uniform grid broad phase. Entries are bucketed into every cell their bounds
+    // touch, and only cells that hold something are allocated. Moving an entry
+    // only touches the grid when it crosses into other cells, and a cell is
+    // recycled as soon as its last entry leaves.
+    class SpatialGrid {
+    public:
+        SpatialGrid();
+        ~SpatialGrid();
+
+        // Cells are square. Pick a size a few times larger than a typical entry.
+        void init(const float cellSize);
+        void clear();
+
+        // Returns a handle that stays valid until the entry is removed.
+        // userData is what queries report back, typically an index into the caller's storage.
+        int insert(const AABB& bounds, const uint32_t userData);
+        void update(const int handle, const AABB& bounds);
+        void remove(const int handle);
+        void setUserData(const int handle, const uint32_t userData) { mEntries[handle].userData = userData; }
+
+        // Appends the userData of every entry overlapping region to out, each entry once.
+        void query(const AABB& region, std::vector<uint32_t>& out) const;
+
+        size_t size() const { return mEntries.size() - mFreeHandles.size(); }
+
+    private:
+        // Slot in the open addressing table that maps cell coordinates to a list of handles.
+        struct CellSlot {
+            uint64_t key;
+            int list;   // -1 for an unused slot
+        };
+
+        struct Entry {
+            AABB bounds;
+            glm::ivec4 cells;   // Min x, min y, max x, max y cell covered
+            uint32_t userData;
+            mutable uint32_t queryStamp;
+        };
+
+        glm::ivec4 cellRange(const AABB& bounds) const;
+        static uint64_t cellKey(const int x, const int y);
+        // Index into mCellLists, or -1 if the cell holds nothing.
+        int findCell(const uint64_t key) const;
+        std::vector<int>& findOrAddCell(const uint64_t key);
+        // Unmaps an empty cell and keeps its list for the next cell added.
+        void freeCell(const uint64_t key);
+        void growCellTable();
+        void addToCells(const int handle, const glm::ivec4& cells);
+        void removeFromCells(const int handle, const glm::ivec4& cells);
+
+        float mInvCellSize;
+        std::vector<Entry> mEntries;
+        std::vector<int> mFreeHandles;
+        // Cells are looked up for every cell an entry or query touches, mostly missing,
+        // so they live in a flat power of two table with linear probing.
+        std::vector<CellSlot> mCellSlots;
+        std::vector<std::vector<int>> mCellLists;
+        // Lists of freed cells, reused with their capacity.
+        std::vector<int> mFreeCellLists;
+        int mCellSlotShift;
+        mutable uint32_t mQueryStamp;
+    };
+
+}
+
+#endif // !SPATIALGRID_H
@@ -0,0 +1,83 @@
+#ifndef SPRITEANIMATOR_H
+#define SPRITEANIMATOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "Tearsplash/TileSheet.h"
+
+namespace Tearsplash {
+
+    // Plays Tilesheet animations for many sprites at once. Clips are baked into
+    // flat UV and duration tables when added, and the playback state of every
+    // sprite is kept in one array per field, so update() streams through memory
+    // and looking up a sprite's current UV rect is a table read.
+    class SpriteAnimator {
+    public:
+        SpriteAnimator();
+        ~SpriteAnimator();
+
+        // Frame i shows tile tiles[i] of tilesheet for durations[i] seconds. Durations
+        // must be positive. Returns the id of the clip.
+        int addClip(const Tilesheet& tilesheet, const std::vector<int>& tiles, const std::vector<float>& durations,
+                    const bool loop = true);
+        // numFrames consecutive tiles starting at firstTile, each shown for frameDuration seconds.
+        int addClip(const Tilesheet& tilesheet, const int firstTile, const int numFrames, const float frameDuration,
+                    const bool loop = true);
+
+        // Removes every clip and player.
+        void clear();
+
+        // Starts a player startTime seconds into clip, on its first frame by default.
+        // Returns a handle that stays valid until the player is removed.
+        int play(const int clip, const float startTime = 0.0f);
+        // Restarts handle on clip, unless it is already playing it.
+        void setClip(const int handle, const int clip);
+        void remove(const int handle);
+
+        // Advances every player. Looping clips wrap around, the others stop on their last frame.
+        void update(const float deltaTime);
+
+        const glm::vec4& getUV(const int handle) const { return mFrameUVs[mFrames[mIndices[handle]]]; }
+        GLuint getTexture(const int handle) const { return mClips[mClipIds[mIndices[handle]]].texture; }
+        int getClip(const int handle) const { return static_cast<int>(mClipIds[mIndices[handle]]); }
+        // True once a non-looping clip has shown its last frame for its full duration.
+        bool isFinished(const int handle) const;
+
+        size_t size() const { return mTimes.size(); }
+        int getNumClips() const { return static_cast<int>(mClips.size()); }
+
+    private:
+        struct Clip {
+            uint32_t firstFrame;    // Index into mFrameUVs and mFrameDurations
+            uint32_t numFrames;
+            GLuint texture;
+            bool loop;
+        };
+
+        // Steps frame past every frame that time has run through. Leaves time as the
+        // seconds into the new frame, or stops on the last frame of a non-looping clip.
+        void advance(const Clip& clip, uint32_t& frame, float& time) const;
+
+        // Frames of every clip back to back.
+        std::vector<glm::vec4> mFrameUVs;
+        std::vector<float> mFrameDurations;
+        std::vector<Clip> mClips;
+
+        // Players, packed so that indices [0, size()) are all in use.
+        std::vector<float> mTimes;          // Seconds into the current frame
+        std::vector<uint32_t> mClipIds;
+        std::vector<uint32_t> mFrames;      // Index into mFrameUVs
+        std::vector<int> mHandles;          // Handle of each player
+
+        // Player index of each handle, -1 for a free handle.
+        std::vector<int> mIndices;
+        std::vector<int> mFreeHandles;
+    };
+
+}
+
+#endif // !SPRITEANIMATOR_H
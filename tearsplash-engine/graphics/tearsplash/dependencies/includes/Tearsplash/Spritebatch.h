@@ -137,7 +137,14 @@ namespace Tearsplash
         void draw(const glm::vec4& destRect, const glm::vec4& uvRect, GLuint texture, int depth, const ColorRGBA8& color);
         void draw(const glm::vec4& destRect, const glm::vec4& uvRect, GLuint texture, int depth, const ColorRGBA8& color, const float radianAngle);
         void draw(const glm::vec4& destRect, const glm::vec4& uvRect, GLuint texture, int depth, const ColorRGBA8& color, const glm::vec2& direction);
+        // Adds count sprites that share everything but their destRect.
+        void draw(const glm::vec4* destRects, size_t count, const glm::vec4& uvRect, GLuint texture, int depth, const ColorRGBA8& color);
 
+        // Adds count glyphs built ahead of time, e.g. by a TextLayout.
+        void draw(const Glyph* glyphs, size_t count);
+
+        // Draw calls renderBatch issues, one per run of glyphs sharing a texture.
+        size_t getNumBatches() const { return mRenderBatches.size(); }
 
     private:
         void createVertexArray();
@@ -1,20 +1,37 @@
 #ifndef SPRITEFONT_H
 #define SPRITEFONT_H
 
-#include <map>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <glm/glm.hpp>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include <Tearsplash/GlyphAtlas.h>
 #include <Tearsplash/Spritebatch.h>
 #include <Tearsplash/ShaderProgram.h>
+#include <Tearsplash/TextLayout.h>
 
 namespace Tearsplash {
+    enum class FontRenderMode {
+        // Glyphs are coverage bitmaps, sharpest at the size they were rasterized at.
+        BITMAP,
+        // Glyphs are signed distance fields, one rasterization stays crisp at any scale.
+        SIGNED_DISTANCE_FIELD
+    };
+
     struct Character {
-        unsigned int textureID; // ID handle of the glyph texture
-        unsigned int advance;   // Offset to advance to next glyph
-        glm::ivec2   size;      // Size of glyph
-        glm::ivec2   bearing;   // Offset from baseline to left/top of glyph
+        GlyphAtlasRegion region;    // Where the glyph's bitmap is in the atlas
+        unsigned int advance;       // Offset to advance to next glyph
+        glm::ivec2   size;          // Size of glyph
+        glm::ivec2   bearing;       // Offset from baseline to left/top of glyph
+        bool         loaded;        // Rasterized once, the bitmap may have been evicted since
     };
 
     class Spritefont {
@@ -24,31 +41,94 @@ namespace Tearsplash {
         ~Spritefont();
 
         // Creates a font library with a TrueType font (.ttf).
-        // The font library supports ascii characters 0-128.
+        // Printable ascii is rasterized up front, any other codepoint in the UTF-8
+        // text is rasterized the first time it is drawn. Glyphs share atlas pages and
+        // the least recently used page is reused once maxAtlasPages are full.
         // @param fontPath: Path to the .ttf font.
         // @param pixelWidth: Width of the font. Default 0 means that the width is
         //                    dynamically calculated from the height.
         // @param pixelWidth: Height of the font.
-        void init(const char* fontPath, unsigned int pixelWidth = 0, unsigned int pixelHeight = 48);
+        // @param maxAtlasPages: Number of 1024x1024 glyph pages kept at most.
+        // @param renderMode: With SIGNED_DISTANCE_FIELD the pixel size only sets the
+        //                    quality, every drawText scale renders from the same glyphs.
+        void init(const char* fontPath, unsigned int pixelWidth = 0, unsigned int pixelHeight = 48, const int maxAtlasPages = 4,
+                  const FontRenderMode renderMode = FontRenderMode::BITMAP);
+
+        // When deferred, new glyphs are rasterized in batches on a worker thread
+        // and text is drawn without them until they are ready, a frame or so later.
+        void setDeferredRasterization(const bool deferred);
 
-        // Draw a text string with the help of the Spritebatch sb.
+        // Draw a UTF-8 text string with the help of the Spritebatch sb.
         // @param sb: Spritebatch to render to.
         // @param text: The text string that is to be displayed.
+        // The layout of the last string is kept, so drawing the same one again
+        // next frame doesn't lay it out again.
         void drawText(const std::string& text,
                       const glm::vec4& position,
                       const glm::mat4& cameraMatrix,
                       const glm::vec3& textColor,
                       const float scale);
 
+        // Draws text laid out ahead of time, laying it out only if it changed.
+        void drawText(TextLayout& layout, const glm::mat4& cameraMatrix);
+
         // Renders all the text.
         void render();
 
+        // Draw calls the last render() issued, one per atlas page in use.
+        size_t getNumDrawCalls() const { return mSpritebatchText.getNumBatches(); }
+
     private:
+        // A glyph's bitmap and metrics, ready to go into the atlas.
+        struct RasterizedGlyph {
+            uint32_t codepoint;
+            std::vector<unsigned char> pixels;  // Tightly packed rows
+            glm::ivec2 size;
+            glm::ivec2 bearing;
+            unsigned int advance;
+        };
+
+        void layoutText(TextLayout& layout);
+
+        // The glyph for codepoint with its bitmap in the atlas, or nullptr if it is
+        // waiting on the worker thread or didn't fit.
+        const Character* findGlyph(const uint32_t codepoint);
+        Character& getCharacter(const uint32_t codepoint);
+        void rasterize(const uint32_t codepoint, RasterizedGlyph& glyph);
+        bool addGlyph(const RasterizedGlyph& glyph);
+
+        void requestGlyph(const uint32_t codepoint);
+        // Moves glyphs the worker finished into the atlas.
+        void collectRasterizedGlyphs();
+        void rasterizerLoop();
+        void stopRasterizer();
+
         FT_UInt mPixelWidth, mPixelHeight;
-        std::map<char, Character> mCharacters;
+        FontRenderMode mRenderMode;
+        FT_Library mLibrary;
+        FT_Face mFace;
+        // Only one thread may use the face at a time.
+        std::mutex mFaceMutex;
+
+        // Indexed by codepoint below 256, unused entries are all zero.
+        Character mCharacters[256];
+        std::unordered_map<uint32_t, Character> mExtendedCharacters;
+        TextLayout mLastLayout;
+        Tearsplash::GlyphAtlas    mAtlas;
         Tearsplash::ShaderProgram mTextShader;
         Tearsplash::Spritebatch   mSpritebatchText;
+
+        // Deferred rasterization. The pending set is only used by the game thread,
+        // the requests and results are shared with the worker.
+        bool mDeferred;
+        std::unordered_set<uint32_t> mPendingGlyphs;
+        std::thread mRasterizer;
+        std::mutex mRasterMutex;
+        std::condition_variable mRasterCondition;
+        std::vector<uint32_t> mRasterRequests;
+        std::vector<RasterizedGlyph> mRasterResults;
+        bool mRasterQuit;
     };
 }
 
-#endif // SPRITEFONT_H
\ No newline at end of file
+#endif // SPRITEFONT_H
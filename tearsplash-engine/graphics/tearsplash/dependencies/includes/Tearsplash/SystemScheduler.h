@@ -0,0 +1,58 @@
+#ifndef SYSTEMSCHEDULER_H
+#define SYSTEMSCHEDULER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Tearsplash/ECS.h"
+#include "Tearsplash/JobSystem.h"
+
+namespace Tearsplash {
+
+    // Runs systems over a World, each declaring which component types it reads and writes.
+    // Systems are grouped into stages: a system lands in the first stage after every
+    // earlier system it conflicts with, i.e. where either one writes what the other
+    // touches. Systems within a stage run in parallel on the scheduler's workers, stages
+    // run in order.
+    // A system may only touch the components it declared, and may only change the
+    // world structurally through World::queueDestroy.
+    class SystemScheduler {
+    public:
+        typedef std::function<void(World& world, const float deltaTime)> SystemFunction;
+
+        SystemScheduler();
+        ~SystemScheduler();
+
+        // Starts numWorkers threads that run systems next to the calling thread. Without
+        // workers every system runs on the calling thread.
+        void init(const size_t numWorkers);
+        void destroy();
+
+        void add(const std::string& name, const ComponentMask reads, const ComponentMask writes, SystemFunction function);
+
+        // Runs every system once, then applies the destroys they queued.
+        void run(World& world, const float deltaTime);
+
+        size_t getNumStages();
+
+    private:
+        struct System {
+            std::string name;
+            ComponentMask reads;
+            ComponentMask writes;
+            SystemFunction function;
+        };
+
+        void buildStages();
+
+        std::vector<System> mSystems;
+        // Indices into mSystems.
+        std::vector<std::vector<size_t>> mStages;
+        bool mNeedsStageUpdate;
+        JobSystem mJobs;
+    };
+
+}
+
+#endif // !SYSTEMSCHEDULER_H
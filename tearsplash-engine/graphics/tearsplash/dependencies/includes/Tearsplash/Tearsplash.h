@@ -6,7 +6,8 @@
 namespace Tearsplash
 {
 
-	extern int init();
+	// headless skips SDL video and audio, for use with Window's HEADLESS flag.
+	extern int init(bool headless = false);
 
 }
 
@@ -0,0 +1,50 @@
+#ifndef TEXTLAYOUT_H
+#define TEXTLAYOUT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <Tearsplash/Spritebatch.h>
+
+namespace Tearsplash {
+
+    class Spritefont;
+
+    // A string laid out once into sprite glyphs. Spritefont::drawText reuses the
+    // glyphs every frame and only lays the text out again after set() changed the
+    // text, position, color or scale, when it is drawn with another font, or when
+    // the font evicted glyphs or was still rasterizing some.
+    class TextLayout {
+    public:
+        friend class Spritefont;
+
+        TextLayout();
+        ~TextLayout();
+
+        // Cheap when nothing changed, so it can be called every frame.
+        void set(const std::string& text, const glm::vec2& position, const glm::vec3& color, const float scale);
+
+        const std::string& getText() const { return mText; }
+
+    private:
+        // Font the glyphs were laid out with, nullptr when they need laying out again.
+        const Spritefont* mFont;
+        std::string mText;
+        glm::vec2 mPosition;
+        glm::vec3 mColor;
+        float mScale;
+        std::vector<Glyph> mGlyphs;
+        // Atlas pages the glyphs are on, kept alive while the layout is drawn.
+        std::vector<int> mPages;
+        // False if glyphs were left out since they weren't rasterized yet.
+        bool mComplete;
+        // The font atlas' eviction count when the text was laid out.
+        uint32_t mAtlasEvictions;
+    };
+
+}
+
+#endif // !TEXTLAYOUT_H
@@ -3,6 +3,8 @@
 
 #include "Tearsplash/GLTexture.h"
 
+#include <vector>
+
 #include <glm/glm.hpp>
 
 namespace Tearsplash {
@@ -10,30 +12,35 @@ namespace Tearsplash {
     class Tilesheet {
     public:
 
-        void init(const Tearsplash::GLTexture& texture, glm::ivec3& dims) {
+        // Precomputes the UV rect of every tile, so lookups are a table read.
+        void init(const Tearsplash::GLTexture& texture, const glm::ivec3& dims) {
             mTexture = texture;
             mDimensions = dims;
+
+            const glm::vec2 tileSize(1.0f / mDimensions.x, 1.0f / mDimensions.y);
+            mUVs.resize(static_cast<size_t>(mDimensions.x) * mDimensions.y);
+            for (int yTile = 0; yTile < mDimensions.y; yTile++) {
+                for (int xTile = 0; xTile < mDimensions.x; xTile++) {
+                    mUVs[yTile * mDimensions.x + xTile] = glm::vec4(xTile * tileSize.x, yTile * tileSize.y, tileSize.x, tileSize.y);
+                }
+            }
         }
 
         // A tile sheet has it's indices calculated as following:
         // ^   8 9 ...
         // y   4 5 6 7
         // x>  0 1 2 3
-        glm::vec4 getUV(const int tileIndex) {
-            const int xTile = tileIndex % mDimensions.x;
-            const int yTile = tileIndex / mDimensions.x; // Rounding down, just like flooring.
-
-            glm::vec4 result;
-            result.x = static_cast<float>(xTile) / mDimensions.x;
-            result.y = static_cast<float>(yTile) / mDimensions.y;
-            result.z = 1.0f / mDimensions.x; // width
-            result.w = 1.0f / mDimensions.y; // height
-
-            return result;
+        const glm::vec4& getUV(const int tileIndex) const {
+            return mUVs[tileIndex];
         }
 
+        int getNumTiles() const { return static_cast<int>(mUVs.size()); }
+
         glm::ivec3 mDimensions;
         Tearsplash::GLTexture mTexture;
+
+    private:
+        std::vector<glm::vec4> mUVs;
     };
 
 }
@@ -0,0 +1,89 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include <cstdint>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "Tearsplash/AABB.h"
+#include "Tearsplash/Camera2D.h"
+#include "Tearsplash/TileSheet.h"
+#include "Tearsplash/Vertex.h"
+
+namespace Tearsplash {
+
+    // A grid of tiles from one Tilesheet, split into square chunks. Each chunk keeps
+    // its quads in a static VBO that is only rebuilt after one of its tiles changed,
+    // and only the chunks the camera sees are drawn, one draw call each. The CPU cost
+    // of a frame follows the number of chunks on screen, not the size of the map.
+    class Tilemap {
+    public:
+        static const uint16_t EMPTY_TILE = 0xFFFF;
+
+        Tilemap();
+        ~Tilemap();
+
+        // @param tilesheet: Must outlive the tilemap.
+        // @param width, height: Size of the map in tiles, all empty to begin with.
+        // @param tileSize: Side of a tile in world units.
+        // @param origin: World position of the bottom left corner of tile (0, 0).
+        // @param chunkSize: Side of a chunk in tiles.
+        void init(const Tilesheet* tilesheet, const int width, const int height, const float tileSize,
+                  const glm::vec2& origin = glm::vec2(0.0f), const int chunkSize = 32);
+        void destroy();
+
+        // tile is a Tilesheet index, or EMPTY_TILE.
+        void setTile(const int x, const int y, const uint16_t tile);
+        uint16_t getTile(const int x, const int y) const { return mTiles[static_cast<size_t>(y) * mWidth + x]; }
+
+        // Draws the chunks overlapping the camera's view, rebuilding the dirty ones.
+        // Expects a shader taking Vertex attributes 0-2, like Spritebatch's, to be in use.
+        void draw(const Camera2D& camera);
+
+        // Chunk coordinates of the first and last chunk overlapping view. Returns false
+        // if view misses the map.
+        bool getVisibleChunks(const AABB& view, glm::ivec2& first, glm::ivec2& last) const;
+
+        // Quads of every non-empty tile in a chunk, six vertices each in the same
+        // winding as Spritebatch.
+        void buildChunkVertices(const int chunkX, const int chunkY, std::vector<Vertex>& vertices) const;
+
+        int getNumChunksX() const { return mNumChunksX; }
+        int getNumChunksY() const { return mNumChunksY; }
+        // Chunks drawn, and of those rebuilt, by the last draw.
+        int getNumDrawnChunks() const { return mNumDrawnChunks; }
+        int getNumRebuiltChunks() const { return mNumRebuiltChunks; }
+
+    private:
+        struct Chunk {
+            GLuint vao;     // 0 until the chunk is first seen
+            GLuint vbo;
+            GLsizei numVertices;
+            bool dirty;
+        };
+
+        void rebuildChunk(const int chunkX, const int chunkY, Chunk& chunk);
+
+        const Tilesheet* mTilesheet;
+        int mWidth;
+        int mHeight;
+        float mTileSize;
+        glm::vec2 mOrigin;
+        int mChunkSize;
+        int mNumChunksX;
+        int mNumChunksY;
+
+        std::vector<uint16_t> mTiles;
+        std::vector<Chunk> mChunks;
+        // Reused by every rebuild.
+        std::vector<Vertex> mScratchVertices;
+
+        int mNumDrawnChunks;
+        int mNumRebuiltChunks;
+    };
+
+}
+
+#endif // !TILEMAP_H
@@ -3,6 +3,10 @@
 #ifndef TIMING_H
 #define TIMING_H
 
+#include <cstdint>
+
+#include "Tearsplash/FrameStats.h"
+
 namespace Tearsplash
 {
     class FPSLimiter
@@ -18,15 +22,77 @@ namespace Tearsplash
         // Returns the current fps
         float end();
 
+        // Last measured frame time in milliseconds
+        float getFrameTime() const { return mFrameTime; }
+
+        // Frame time statistics over the last FrameStats::NUM_SAMPLES frames
+        const FrameStats& getFrameStats() const { return mFrameStats; }
+
     private:
         // Functions
         void calcFPS();
 
+        // Sleeps for the bulk of the remaining time and spins the rest,
+        // since SDL_Delay alone can oversleep by several milliseconds.
+        void waitUntil(const uint64_t targetCounter) const;
+
         // Member variables
         float        mMaxFPS;
         float        mFPS;
         float        mFrameTime;
-        unsigned int mStartTicks;
+        uint64_t     mStartCounter;
+        uint64_t     mPreviousCounter;
+        FrameStats   mFrameStats;
+    };
+
+    // Accumulates real frame time and hands it out in fixed simulation steps,
+    // which decouples the simulation rate from the render rate. Usage:
+    //
+    //   loop.beginFrame();
+    //   while (loop.step()) { simulate(loop.getTimeStep()); }
+    //   render(loop.getAlpha());
+    class FixedTimestep
+    {
+    public:
+        FixedTimestep();
+        ~FixedTimestep();
+
+        // @param stepsPerSecond: Rate of the simulation.
+        // @param maxStepsPerFrame: Upper bound on steps taken in one frame. Time beyond
+        //                          this is dropped so a slow frame can't cause an ever
+        //                          growing backlog of steps (spiral of death).
+        void init(const float stepsPerSecond, const int maxStepsPerFrame = 5);
+
+        // Measures the time since the last frame and adds it to the accumulator.
+        void beginFrame();
+
+        // In lockstep every frame takes a set number of steps, whatever time it really took.
+        // Makes a run independent of the machine, e.g. when replaying recorded input.
+        void setLockstep(const bool lockstep) { mLockstep = lockstep; }
+        // Steps the next frames take in lockstep, 1 by default. A replay sets the count
+        // each recorded frame took.
+        void setLockstepSteps(const int steps) { mLockstepSteps = steps; }
+
+        // Returns true, and consumes one step, while a full step is accumulated.
+        bool step();
+
+        float getTimeStep() const { return mTimeStep; }
+
+        // Real time the last frame took, in seconds.
+        float getFrameTime() const { return static_cast<float>(mFrameTime); }
+
+        // How far, in [0, 1), the real time is between the previous and the current
+        // simulation state. Used to interpolate when rendering.
+        float getAlpha() const { return static_cast<float>(mAccumulator / mTimeStep); }
+
+    private:
+        float    mTimeStep;
+        int      mMaxStepsPerFrame;
+        bool     mLockstep;
+        int      mLockstepSteps;
+        double   mAccumulator;
+        double   mFrameTime;
+        uint64_t mPreviousCounter;
     };
 }
 #endif // !TIMING_H
@@ -0,0 +1,73 @@
+#ifndef VOICEMANAGER_H
+#define VOICEMANAGER_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <SDL/SDL_mixer.h>
+
+namespace Tearsplash {
+
+    struct VoiceStats {
+        int numChannels = 0;
+        int activeVoices = 0;
+        int peakVoices = 0;
+        uint64_t played = 0;
+        // Played by cutting off a lower priority voice.
+        uint64_t stolen = 0;
+        // Not played since every channel held a voice of higher priority, or the mixer failed.
+        uint64_t dropped = 0;
+        // Not played since the same sound had already started this frame.
+        uint64_t rateLimited = 0;
+    };
+
+    // Hands out SDL_mixer channels to sound effects. When every channel is busy
+    // the voice with the lowest priority is stolen, the oldest one on ties, as long
+    // as it doesn't outrank the new sound. The same chunk only starts a limited
+    // number of times per frame, so a burst of identical sounds costs one voice.
+    // Playing never fails loudly, a sound that doesn't fit is just dropped.
+    class VoiceManager {
+    public:
+        VoiceManager();
+        ~VoiceManager();
+
+        // Allocates numChannels mixer channels. Call after Mix_OpenAudio.
+        void init(const int numChannels, const int maxStartsPerFramePerSound = 1);
+
+        // Returns the channel the chunk plays on, or -1 if it was dropped or rate limited.
+        int play(Mix_Chunk* chunk, const int loops = 0, const int priority = 0);
+        void stop(const int channel);
+        void stopAll();
+
+        // Call once per frame. Frees the channels whose voices finished and
+        // resets the per frame limits.
+        void update();
+
+        const VoiceStats& getStats() const { return mStats; }
+
+        // Draws the stats into the current ImGui window.
+        void drawImGui() const;
+
+    private:
+        struct Voice {
+            Mix_Chunk* chunk;
+            int priority;
+            // Order the voice started in, lower is older.
+            uint64_t sequence;
+            bool active;
+        };
+
+        int findChannel(const int priority);
+
+        std::vector<Voice> mVoices;
+        // Chunks started this frame and how many times.
+        std::vector<std::pair<Mix_Chunk*, int>> mStartedThisFrame;
+        int mMaxStartsPerFramePerSound;
+        uint64_t mNextSequence;
+        VoiceStats mStats;
+    };
+
+}
+
+#endif // !VOICEMANAGER_H
@@ -5,10 +5,13 @@
 #include <GL/glew.h>
 #include <string>
 
+#include "Tearsplash/HeadlessContext.h"
+
 namespace Tearsplash
 {
 
-	enum WindowFlags { INVISIBLE = 0x1, FULLSCREEN = 0x2, BORDERLESS = 0x4, RESIZABLE = 0x8};
+	// HEADLESS creates no window, see HeadlessContext.
+	enum WindowFlags { INVISIBLE = 0x1, FULLSCREEN = 0x2, BORDERLESS = 0x4, RESIZABLE = 0x8, HEADLESS = 0x10};
 
 	class Window
 	{
@@ -20,6 +23,11 @@ namespace Tearsplash
 		int getScreenWidth() const { return mWindowWidth; }
 		int getScreenHeight() const { return mWindowHeight; }
 		void swapBuffer();
+    bool isHeadless() const {
+      return mHeadlessContext.isCreated();
+    }
+
+    // nullptr when headless.
     SDL_Window* getSDLWindow() {
       return mSDLWindow;
     }
@@ -33,11 +41,15 @@ namespace Tearsplash
     }
 
 	private:
+		int createHeadless(int windowWidth, int windowHeight);
+		void initGLState();
+
 		SDL_Window* mSDLWindow;
     SDL_GLContext mGLContext;
+    HeadlessContext mHeadlessContext;
 		int mWindowWidth;
 		int mWindowHeight;
-    const char* mGLSLVersion = "#version 460";
+    const char* mGLSLVersion = "#version 330 core";
 	};
 
 }
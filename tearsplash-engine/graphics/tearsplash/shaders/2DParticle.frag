@@ -0,0 +1,13 @@
+#version 330 core
+
+in vec4 color;
+in vec2 uv;
+
+out vec4 fragmentColor;
+
+uniform sampler2D texSampler;
+
+void main()
+{
+    fragmentColor = texture(texSampler, uv) * color;
+}
@@ -0,0 +1,19 @@
+#version 330 core
+
+in vec2  particlePosition;
+in vec2  particleVelocity;
+in vec4  particleColor;
+in float particleWidth;
+in float particleLifeTime;
+
+out vec4  vertexColor;
+out float vertexWidth;
+out float vertexLifeTime;
+
+void main()
+{
+    gl_Position    = vec4(particlePosition, 0.0, 1.0);
+    vertexColor    = particleColor;
+    vertexWidth    = particleWidth;
+    vertexLifeTime = particleLifeTime;
+}
@@ -0,0 +1,34 @@
+#version 330 core
+
+// Particle state read from the source buffer.
+in vec2  particlePosition;
+in vec2  particleVelocity;
+in vec4  particleColor;
+in float particleWidth;
+in float particleLifeTime;
+
+// Particle state captured into the destination buffer by transform feedback.
+out vec2  outPosition;
+out vec2  outVelocity;
+out vec4  outColor;
+out float outWidth;
+out float outLifeTime;
+
+uniform float deltaTime;
+uniform float decayRate;
+
+void main()
+{
+    outVelocity = particleVelocity;
+    outColor    = particleColor;
+    outWidth    = particleWidth;
+    outPosition = particlePosition;
+    outLifeTime = particleLifeTime;
+
+    // Dead particles are copied as is until the emitter reuses their slot.
+    if (particleLifeTime > 0.0)
+    {
+        outPosition = particlePosition + particleVelocity * deltaTime;
+        outLifeTime = particleLifeTime - decayRate * deltaTime;
+    }
+}
@@ -0,0 +1,16 @@
+#version 330 core
+in vec2 texCoords;
+out vec4 color;
+
+uniform sampler2D text;
+uniform vec3 textColor;
+
+// The glyph texture holds a signed distance field, the edge is at 0.5.
+void main()
+{
+    float distance = texture(text, texCoords).r;
+    // Screen space smoothing, so edges stay crisp at any scale.
+    float smoothing = fwidth(distance) * 0.5;
+    float alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);
+    color = vec4(textColor, alpha);
+}
@@ -0,0 +1,50 @@
+#include "Tearsplash/AABB.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEARSPLASH_CULL_SSE 1
+#include <xmmintrin.h>
+#endif
+
+using namespace Tearsplash;
+
+static_assert(sizeof(AABB) == 4 * sizeof(float), "AABB must be four packed floats");
+
+void Tearsplash::cullAABBs(const AABB* aabbs, const size_t count, const AABB& view, uint32_t* outMask) {
+    std::memset(outMask, 0, cullMaskWords(count) * sizeof(uint32_t));
+
+    size_t i = 0;
+
+#ifdef TEARSPLASH_CULL_SSE
+    const __m128 viewMinX = _mm_set1_ps(view.min.x);
+    const __m128 viewMinY = _mm_set1_ps(view.min.y);
+    const __m128 viewMaxX = _mm_set1_ps(view.max.x);
+    const __m128 viewMaxY = _mm_set1_ps(view.max.y);
+    const float* data = &aabbs[0].min.x;
+
+    // Four boxes per iteration. Transposing turns four (minX, minY, maxX, maxY)
+    // rows into one register per component.
+    for (; i + 4 <= count; i += 4) {
+        __m128 minX = _mm_loadu_ps(data + i * 4);
+        __m128 minY = _mm_loadu_ps(data + i * 4 + 4);
+        __m128 maxX = _mm_loadu_ps(data + i * 4 + 8);
+        __m128 maxY = _mm_loadu_ps(data + i * 4 + 12);
+        _MM_TRANSPOSE4_PS(minX, minY, maxX, maxY);
+
+        const __m128 overlapX = _mm_and_ps(_mm_cmple_ps(minX, viewMaxX), _mm_cmpge_ps(maxX, viewMinX));
+        const __m128 overlapY = _mm_and_ps(_mm_cmple_ps(minY, viewMaxY), _mm_cmpge_ps(maxY, viewMinY));
+        const uint32_t bits = static_cast<uint32_t>(_mm_movemask_ps(_mm_and_ps(overlapX, overlapY)));
+
+        // i is a multiple of 4, so the four bits never straddle two words.
+        outMask[i >> 5] |= bits << (i & 31);
+    }
+#endif
+
+    // Whatever is left, or everything without SSE.
+    for (; i < count; i++) {
+        if (aabbs[i].overlaps(view)) {
+            outMask[i >> 5] |= 1u << (i & 31);
+        }
+    }
+}
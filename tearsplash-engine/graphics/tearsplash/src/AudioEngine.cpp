@@ -1,21 +1,22 @@
-#include <Tearsplash/Audioengine.h>
+#include <Tearsplash/AudioEngine.h>
 #include <Tearsplash/Errors.h>
 
 using namespace Tearsplash;
 
-void SoundEffect::play(const int loop) {
-    if (Mix_PlayChannel(-1, mChunk, loop) == -1) {
-        // If this fails, use channel 0.
-        if (Mix_PlayChannel(0, mChunk, loop) == -1) {
-            fatalError("Mix_PlayChannel error playing channel -1 " + std::to_string(loop) + " number of times. Mixer error: " + Mix_GetError());
-        }
+int SoundEffect::play(const int loop, const int priority) {
+    // Running out of channels is normal during rapid fire, the voice manager
+    // drops or steals instead of failing.
+    if (mVoices == nullptr || mChunk == nullptr) {
+        return -1;
     }
+    return mVoices->play(mChunk, loop, priority);
 }
 
-void Music::play(const int loop) {
-    if (Mix_PlayMusic(mMusic, loop) == -1) {
-        fatalError("Mix_PlayMusic error playing channel -1 " + std::to_string(loop) + " number of times. Mixer error: " + Mix_GetError());
+void Music::play(const int loop, const int fadeMs) {
+    if (mStreamer == nullptr) {
+        return;
     }
+    mStreamer->play(mFilePath, loop, fadeMs);
 }
 
 void Music::pause() {
@@ -37,7 +38,7 @@ AudioEngine::~AudioEngine() {
     destroy();
 }
 
-void AudioEngine::init() {
+void AudioEngine::init(const int numChannels) {
    // Initialize SDL_mixer with a bitwise combination of
     // MIX_INIT_FLAC
     // MIX_INIT_MOD
@@ -52,27 +53,36 @@ void AudioEngine::init() {
         fatalError("Mix init error " + std::string(Mix_GetError()));
     }
 
+    mVoices.init(numChannels);
+    mMusicStreamer.init();
+
     mInitialized = true;
 }
 
+void AudioEngine::update() {
+    if (mInitialized) {
+        mVoices.update();
+        mMusicStreamer.update();
+    }
+}
+
 void AudioEngine::destroy() {
     if (mInitialized) {
         mInitialized = false;
 
+        // Stop what's playing before the chunks go away.
+        mVoices.stopAll();
+        mMusicStreamer.destroy();
+
         // Free all allocated data.
         for (auto& effect : mEffectMap) {
             Mix_FreeChunk(effect.second);
         }
 
-        for (auto& music : mMusicMap) {
-            Mix_FreeMusic(music.second);
-        }
-
         Mix_CloseAudio();
         Mix_Quit();
 
         mEffectMap.clear();
-        mMusicMap.clear();
     }
 }
 
@@ -90,35 +100,23 @@ SoundEffect AudioEngine::loadSoundEffect(const std::string& filePath) {
         }
         // Store the effect in the cache map.
         effect.mChunk = chunk;
+        effect.mVoices = &mVoices;
         mEffectMap[filePath] = chunk;
     }
     else {
         // Effect already cached.
         effect.mChunk = it->second;
+        effect.mVoices = &mVoices;
     }
 
     return effect;
 }
 
 Music AudioEngine::loadMusic(const std::string& filePath) {
-    // See if filePath sound effect already exists.
-    auto it = mMusicMap.find(filePath);
-
+    // SDL_mixer has a single music channel, the streamer owns it. Opening the file
+    // waits until the track is played.
     Music music;
-    if (it == mMusicMap.end()) {
-        // Need to load the effect.
-        Mix_Music* mixMusic = Mix_LoadMUS(filePath.c_str());
-        if (!mixMusic) {
-            fatalError("Mix_LoadMUS failed to load effect at " + filePath);
-        }
-        // Store the effect in the cache map.
-        music.mMusic = mixMusic;
-        mMusicMap[filePath] = mixMusic;
-    }
-    else {
-        // Effect already cached.
-        music.mMusic = it->second;
-    }
-
+    music.mFilePath = filePath;
+    music.mStreamer = &mMusicStreamer;
     return music;
 }
\ No newline at end of file
@@ -0,0 +1,314 @@
+#include "Tearsplash/AudioMixer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "Tearsplash/Errors.h"
+#include "Tearsplash/Profiler.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEARSPLASH_MIX_SSE 1
+#include <xmmintrin.h>
+#endif
+
+using namespace Tearsplash;
+
+namespace {
+    // Keeps the summed voices inside the range the device expects.
+    void clampSamples(float* samples, const size_t count) {
+        size_t i = 0;
+#ifdef TEARSPLASH_MIX_SSE
+        const __m128 low = _mm_set1_ps(-1.0f);
+        const __m128 high = _mm_set1_ps(1.0f);
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_ps(samples + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(samples + i), low), high));
+        }
+#endif
+        for (; i < count; i++) {
+            samples[i] = std::min(std::max(samples[i], -1.0f), 1.0f);
+        }
+    }
+
+    // Constant power pan, so a sound keeps its loudness as it moves across.
+    void panGains(const float gain, const float pan, float& leftGain, float& rightGain) {
+        const float angle = (std::min(std::max(pan, -1.0f), 1.0f) + 1.0f) * 0.25f * 3.14159265f;
+        leftGain = gain * std::cos(angle);
+        rightGain = gain * std::sin(angle);
+    }
+}
+
+void Tearsplash::mixIntoStereo(float* out, const float* samples, const size_t count, const int channels, const float leftGain, const float rightGain) {
+    size_t i = 0;
+#ifdef TEARSPLASH_MIX_SSE
+    const __m128 gains = _mm_setr_ps(leftGain, rightGain, leftGain, rightGain);
+    if (channels == 1) {
+        // Four mono samples fill two registers of left right pairs.
+        for (; i + 4 <= count; i += 4) {
+            const __m128 in = _mm_loadu_ps(samples + i);
+            float* destination = out + i * 2;
+            _mm_storeu_ps(destination, _mm_add_ps(_mm_loadu_ps(destination), _mm_mul_ps(_mm_unpacklo_ps(in, in), gains)));
+            _mm_storeu_ps(destination + 4, _mm_add_ps(_mm_loadu_ps(destination + 4), _mm_mul_ps(_mm_unpackhi_ps(in, in), gains)));
+        }
+    }
+    else {
+        for (; i + 2 <= count; i += 2) {
+            float* destination = out + i * 2;
+            _mm_storeu_ps(destination, _mm_add_ps(_mm_loadu_ps(destination), _mm_mul_ps(_mm_loadu_ps(samples + i * 2), gains)));
+        }
+    }
+#endif
+
+    // Whatever is left, or everything without SSE.
+    if (channels == 1) {
+        for (; i < count; i++) {
+            out[i * 2] += samples[i] * leftGain;
+            out[i * 2 + 1] += samples[i] * rightGain;
+        }
+    }
+    else {
+        for (; i < count; i++) {
+            out[i * 2] += samples[i * 2] * leftGain;
+            out[i * 2 + 1] += samples[i * 2 + 1] * rightGain;
+        }
+    }
+}
+
+AudioMixer::AudioMixer() :
+    mDevice(0), mNextHandle(NO_VOICE + 1), mNumVoices(0),
+    mNumActiveVoices(0), mNumDroppedVoices(0), mLastMixMicroseconds(0) {
+}
+
+AudioMixer::~AudioMixer() {
+    destroy();
+}
+
+void AudioMixer::init(const AudioMixerConfig& config) {
+    destroy();
+
+    mConfig = config;
+    mVoices.resize(mConfig.maxVoices);
+    mNumVoices = 0;
+
+    if (mConfig.openDevice) {
+        SDL_AudioSpec desired = {};
+        desired.freq = mConfig.sampleRate;
+        desired.format = AUDIO_F32SYS;
+        desired.channels = 2;
+        desired.samples = static_cast<Uint16>(mConfig.bufferFrames);
+        desired.callback = audioCallback;
+        desired.userdata = this;
+
+        // No changes allowed, SDL converts to whatever the hardware wants.
+        mDevice = SDL_OpenAudioDevice(nullptr, 0, &desired, nullptr, 0);
+        if (mDevice == 0) {
+            fatalError("SDL_OpenAudioDevice error " + std::string(SDL_GetError()));
+        }
+        SDL_PauseAudioDevice(mDevice, 0);
+    }
+}
+
+void AudioMixer::destroy() {
+    // Stop the callback before the sounds it reads go away.
+    if (mDevice != 0) {
+        SDL_CloseAudioDevice(mDevice);
+        mDevice = 0;
+    }
+
+    Command command;
+    while (mCommands.pop(command)) {
+        // Drain.
+    }
+    mNumVoices = 0;
+    mNumActiveVoices.store(0);
+    mSoundCache.clear();
+    mSounds.clear();
+}
+
+const MixerSound* AudioMixer::loadSound(const std::string& filePath) {
+    auto it = mSoundCache.find(filePath);
+    if (it != mSoundCache.end()) {
+        return it->second;
+    }
+
+    SDL_AudioSpec spec;
+    Uint8* buffer = nullptr;
+    Uint32 length = 0;
+    if (SDL_LoadWAV(filePath.c_str(), &spec, &buffer, &length) == nullptr) {
+        fatalError("SDL_LoadWAV failed to load sound at " + filePath + " " + SDL_GetError());
+    }
+
+    // Decode to float at the mixer rate once, so mixing is only multiply and add.
+    const int channels = spec.channels == 1 ? 1 : 2;
+    SDL_AudioCVT converter;
+    if (SDL_BuildAudioCVT(&converter, spec.format, spec.channels, spec.freq, AUDIO_F32SYS, static_cast<Uint8>(channels), mConfig.sampleRate) < 0) {
+        SDL_FreeWAV(buffer);
+        fatalError("SDL_BuildAudioCVT failed for sound at " + filePath + " " + SDL_GetError());
+    }
+
+    std::vector<Uint8> converted(static_cast<size_t>(length) * converter.len_mult);
+    std::memcpy(converted.data(), buffer, length);
+    SDL_FreeWAV(buffer);
+    converter.len = static_cast<int>(length);
+    converter.buf = converted.data();
+    if (converter.needed != 0 && SDL_ConvertAudio(&converter) < 0) {
+        fatalError("SDL_ConvertAudio failed for sound at " + filePath + " " + SDL_GetError());
+    }
+    const size_t convertedLength = converter.needed != 0 ? static_cast<size_t>(converter.len_cvt) : length;
+
+    const size_t numFrames = convertedLength / (sizeof(float) * channels);
+    const MixerSound* sound = createSound(reinterpret_cast<const float*>(converted.data()), numFrames, channels);
+    mSoundCache[filePath] = sound;
+    return sound;
+}
+
+const MixerSound* AudioMixer::createSound(const float* samples, const size_t numFrames, const int channels) {
+    std::unique_ptr<MixerSound> sound = std::make_unique<MixerSound>();
+    sound->samples.assign(samples, samples + numFrames * channels);
+    sound->channels = channels;
+    sound->numFrames = numFrames;
+    mSounds.push_back(std::move(sound));
+    return mSounds.back().get();
+}
+
+AudioMixer::VoiceHandle AudioMixer::play(const MixerSound* sound, const float gain, const float pan, const bool loop) {
+    Command command = {};
+    command.type = CommandType::PLAY;
+    command.voice = mNextHandle;
+    command.sound = sound;
+    command.loop = loop;
+    panGains(gain, pan, command.leftGain, command.rightGain);
+    if (!pushCommand(command)) {
+        return NO_VOICE;
+    }
+
+    mNextHandle++;
+    if (mNextHandle == NO_VOICE) {
+        mNextHandle++;
+    }
+    return command.voice;
+}
+
+void AudioMixer::stop(const VoiceHandle voice) {
+    Command command = {};
+    command.type = CommandType::STOP;
+    command.voice = voice;
+    pushCommand(command);
+}
+
+void AudioMixer::setGainAndPan(const VoiceHandle voice, const float gain, const float pan) {
+    Command command = {};
+    command.type = CommandType::SET_GAIN_AND_PAN;
+    command.voice = voice;
+    panGains(gain, pan, command.leftGain, command.rightGain);
+    pushCommand(command);
+}
+
+void AudioMixer::stopAll() {
+    Command command = {};
+    command.type = CommandType::STOP_ALL;
+    pushCommand(command);
+}
+
+void AudioMixer::mix(float* out, const int numFrames) {
+    // No profile scope, the first one on a thread allocates its event buffer under a lock.
+    const int64_t startNs = Profiler::now();
+
+    processCommands();
+
+    std::memset(out, 0, sizeof(float) * 2 * numFrames);
+    for (int i = 0; i < mNumVoices; i++) {
+        Voice& voice = mVoices[i];
+        const MixerSound& sound = *voice.sound;
+
+        // A looping voice may wrap around the end of its sound within one buffer.
+        size_t written = 0;
+        bool finished = false;
+        while (written < static_cast<size_t>(numFrames)) {
+            const size_t count = std::min(static_cast<size_t>(numFrames) - written, sound.numFrames - voice.position);
+            mixIntoStereo(out + written * 2, sound.samples.data() + voice.position * sound.channels, count,
+                sound.channels, voice.leftGain, voice.rightGain);
+            written += count;
+            voice.position += count;
+
+            if (voice.position == sound.numFrames) {
+                if (!voice.loop || sound.numFrames == 0) {
+                    finished = true;
+                    break;
+                }
+                voice.position = 0;
+            }
+        }
+
+        if (finished) {
+            // Swap in the last voice and mix it next.
+            mVoices[i] = mVoices[mNumVoices - 1];
+            mNumVoices--;
+            i--;
+        }
+    }
+
+    clampSamples(out, static_cast<size_t>(numFrames) * 2);
+
+    mNumActiveVoices.store(mNumVoices, std::memory_order_relaxed);
+    mLastMixMicroseconds.store(static_cast<uint32_t>((Profiler::now() - startNs) / 1000), std::memory_order_relaxed);
+}
+
+void SDLCALL AudioMixer::audioCallback(void* userData, Uint8* stream, int length) {
+    AudioMixer* mixer = static_cast<AudioMixer*>(userData);
+    mixer->mix(reinterpret_cast<float*>(stream), length / static_cast<int>(sizeof(float) * 2));
+}
+
+bool AudioMixer::pushCommand(const Command& command) {
+    if (!mCommands.push(command)) {
+        // Only a lost PLAY loses a voice.
+        if (command.type == CommandType::PLAY) {
+            mNumDroppedVoices.fetch_add(1, std::memory_order_relaxed);
+        }
+        return false;
+    }
+    return true;
+}
+
+void AudioMixer::processCommands() {
+    Command command;
+    while (mCommands.pop(command)) {
+        switch (command.type) {
+        case CommandType::PLAY:
+            if (mNumVoices == static_cast<int>(mVoices.size())) {
+                mNumDroppedVoices.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+            mVoices[mNumVoices++] = { command.voice, command.sound, 0, command.leftGain, command.rightGain, command.loop };
+            break;
+        case CommandType::STOP: {
+            const int index = findVoice(command.voice);
+            if (index != -1) {
+                mVoices[index] = mVoices[mNumVoices - 1];
+                mNumVoices--;
+            }
+            break;
+        }
+        case CommandType::SET_GAIN_AND_PAN: {
+            const int index = findVoice(command.voice);
+            if (index != -1) {
+                mVoices[index].leftGain = command.leftGain;
+                mVoices[index].rightGain = command.rightGain;
+            }
+            break;
+        }
+        case CommandType::STOP_ALL:
+            mNumVoices = 0;
+            break;
+        }
+    }
+}
+
+int AudioMixer::findVoice(const VoiceHandle voice) const {
+    for (int i = 0; i < mNumVoices; i++) {
+        if (mVoices[i].handle == voice) {
+            return i;
+        }
+    }
+    return -1;
+}
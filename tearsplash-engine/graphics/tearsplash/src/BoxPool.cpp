@@ -0,0 +1,144 @@
+#include "Tearsplash/BoxPool.h"
+
+#include "Tearsplash/Profiler.h"
+
+using namespace Tearsplash;
+
+namespace {
+    const uint32_t NO_HANDLE = UINT32_MAX;
+}
+
+BoxPool::BoxPool() : mPhysicsWorld(nullptr), mNumFree(0) {
+}
+
+BoxPool::~BoxPool() {
+    // Do nothing. The bodies are owned by the b2World.
+}
+
+void BoxPool::init(b2World* physicsWorld, const size_t reserveBoxes) {
+    mPhysicsWorld = physicsWorld;
+    mBoxes.reserve(reserveBoxes);
+    mShapeIndices.reserve(reserveBoxes);
+    mAlive.reserve(reserveBoxes);
+}
+
+void BoxPool::spawn(const glm::vec2* positions,
+    const glm::vec2* dimensions,
+    const size_t count,
+    const b2BodyType type,
+    uint32_t* outHandles) {
+    TS_PROFILE_SCOPE("BoxPool::spawn");
+
+    // Grow once for the whole batch, some of it may be covered by free boxes.
+    const size_t required = mBoxes.size() + (count > mNumFree ? count - mNumFree : 0);
+    if (required > mBoxes.capacity()) {
+        mBoxes.reserve(required);
+        mShapeIndices.reserve(required);
+        mAlive.reserve(required);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const uint32_t shapeIndex = findOrAddShape(dimensions[i]);
+        uint32_t handle = takeFreeHandle(shapeIndex);
+
+        if (handle == NO_HANDLE) {
+            handle = static_cast<uint32_t>(mBoxes.size());
+            mBoxes.emplace_back();
+            mShapeIndices.push_back(shapeIndex);
+            mAlive.push_back(1);
+            createBox(handle, shapeIndex, positions[i], type);
+        }
+        else {
+            Box& box = mBoxes[handle];
+            b2Body* body = box.mBody;
+
+            // A box freed with other dimensions only needs its fixture swapped.
+            if (mShapeIndices[handle] != shapeIndex) {
+                body->DestroyFixture(box.mFixture);
+                b2FixtureDef fixtureDef;
+                fixtureDef.shape = &mShapes[shapeIndex].shape;
+                fixtureDef.density = 1.0f;
+                fixtureDef.friction = 0.3f;
+                box.mFixture = body->CreateFixture(&fixtureDef);
+                box.mDimensions = dimensions[i];
+                mShapeIndices[handle] = shapeIndex;
+            }
+
+            body->SetType(type);
+            body->SetTransform(b2Vec2(positions[i].x, positions[i].y), 0.0f);
+            body->SetLinearVelocity(b2Vec2(0.0f, 0.0f));
+            body->SetAngularVelocity(0.0f);
+            body->SetEnabled(true);
+            body->SetAwake(true);
+            mAlive[handle] = 1;
+        }
+
+        outHandles[i] = handle;
+    }
+}
+
+void BoxPool::destroy(const uint32_t handle) {
+    if (!mAlive[handle]) {
+        return;
+    }
+
+    // Disabling removes the body from the broad phase and its contacts, but keeps its memory.
+    mBoxes[handle].mBody->SetEnabled(false);
+    mAlive[handle] = 0;
+    mShapes[mShapeIndices[handle]].freeHandles.push_back(handle);
+    mNumFree++;
+}
+
+uint32_t BoxPool::findOrAddShape(const glm::vec2& dimensions) {
+    // Few distinct sizes in practice, a linear search beats hashing here.
+    for (size_t i = 0; i < mShapes.size(); i++) {
+        if (mShapes[i].dimensions == dimensions) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+
+    ShapeEntry entry;
+    entry.dimensions = dimensions;
+    entry.shape.SetAsBox(dimensions.x * 0.5f, dimensions.y * 0.5f);
+    mShapes.push_back(entry);
+    return static_cast<uint32_t>(mShapes.size() - 1);
+}
+
+uint32_t BoxPool::takeFreeHandle(const uint32_t shapeIndex) {
+    if (mNumFree == 0) {
+        return NO_HANDLE;
+    }
+
+    // Prefer a box that already has the right fixture.
+    std::vector<uint32_t>* freeHandles = &mShapes[shapeIndex].freeHandles;
+    if (freeHandles->empty()) {
+        for (ShapeEntry& entry : mShapes) {
+            if (!entry.freeHandles.empty()) {
+                freeHandles = &entry.freeHandles;
+                break;
+            }
+        }
+    }
+
+    const uint32_t handle = freeHandles->back();
+    freeHandles->pop_back();
+    mNumFree--;
+    return handle;
+}
+
+void BoxPool::createBox(const uint32_t handle, const uint32_t shapeIndex, const glm::vec2& position, const b2BodyType type) {
+    Box& box = mBoxes[handle];
+    box.mDimensions = mShapes[shapeIndex].dimensions;
+
+    b2BodyDef bodyDef;
+    bodyDef.type = type;
+    bodyDef.position.Set(position.x, position.y);
+    box.mBody = mPhysicsWorld->CreateBody(&bodyDef);
+
+    // Same fixture settings as Box::init.
+    b2FixtureDef fixtureDef;
+    fixtureDef.shape = &mShapes[shapeIndex].shape;
+    fixtureDef.density = 1.0f;
+    fixtureDef.friction = 0.3f;
+    box.mFixture = box.mBody->CreateFixture(&fixtureDef);
+}
@@ -16,7 +16,29 @@
 
 using namespace Tearsplash;
 
-Camera2D::Camera2D() : mPosition(0, 0), mCameraMatrix(1.0), mScale(1.0f), mNeedsMatrixUpdate(true), mScreenWidth(480), mScreenHeight(480), mOrthoMatrix(0.0f)
+namespace
+{
+    inline glm::vec2 transformPoint(const glm::mat3& transform, const glm::vec2& point)
+    {
+        return glm::vec2(transform[0][0] * point.x + transform[1][0] * point.y + transform[2][0],
+                         transform[0][1] * point.x + transform[1][1] * point.y + transform[2][1]);
+    }
+
+    void transformPoints(const glm::mat3& transform, const glm::vec2* points, const size_t count, glm::vec2* outPoints)
+    {
+        const float xx = transform[0][0], yx = transform[1][0], tx = transform[2][0];
+        const float xy = transform[0][1], yy = transform[1][1], ty = transform[2][1];
+        for (size_t i = 0; i < count; i++)
+        {
+            const float x = points[i].x;
+            const float y = points[i].y;
+            outPoints[i] = glm::vec2(xx * x + yx * y + tx, xy * x + yy * y + ty);
+        }
+    }
+}
+
+Camera2D::Camera2D() : mScale(1.0f), mScreenWidth(480), mScreenHeight(480), mNeedsMatrixUpdate(true), mPosition(0, 0), mHalfViewDimensions(240.0f, 240.0f),
+                       mCameraMatrix(1.0), mInverseCameraMatrix(1.0f), mOrthoMatrix(0.0f), mWorldToScreen(1.0f), mScreenToWorld(1.0f), mViewAABB{ glm::vec2(-240.0f), glm::vec2(240.0f) }
 {
     // Create identity matrix
     mCameraMatrix = glm::mat4(1, 0, 0, 0,
@@ -34,6 +56,8 @@ void Camera2D::init(int screenWidth, int screenHeight)
     mScreenWidth = screenWidth;
     mScreenHeight = screenHeight;
     mOrthoMatrix = glm::ortho(0.0f, static_cast<float>(mScreenWidth), 0.0f, static_cast<float>(mScreenHeight));
+    mHalfViewDimensions = glm::vec2(mScreenWidth, mScreenHeight) * 0.5f / mScale;
+    mNeedsMatrixUpdate = true;
 }
 
 void Camera2D::update()
@@ -42,12 +66,28 @@ void Camera2D::update()
     {
         // Adjust focal point for scaling
         glm::vec3 translate(-mPosition.x + mScreenWidth * 0.5 , -mPosition.y + mScreenHeight * 0.5, 0.0f);
-        glm::vec3 scale(mScale, mScale, 0.0f);
+        // z is left at 1 so the matrix stays invertible.
+        glm::vec3 scale(mScale, mScale, 1.0f);
 
         // Translate and scale camera
         mCameraMatrix = glm::translate(mOrthoMatrix, translate);
         mCameraMatrix = glm::scale(glm::mat4(1.0f), scale) * mCameraMatrix;
 
+        // Cached for culling so it isn't recomputed for every object tested
+        mHalfViewDimensions = glm::vec2(mScreenWidth, mScreenHeight) * 0.5f / mScale;
+        mViewAABB = { mPosition - mHalfViewDimensions, mPosition + mHalfViewDimensions };
+
+        // Cached for picking. Clip space to pixels flips y, since the screen origin is top left.
+        mInverseCameraMatrix = glm::inverse(mCameraMatrix);
+        const glm::mat3 worldToClip(mCameraMatrix[0][0], mCameraMatrix[0][1], 0.0f,
+                                    mCameraMatrix[1][0], mCameraMatrix[1][1], 0.0f,
+                                    mCameraMatrix[3][0], mCameraMatrix[3][1], 1.0f);
+        const glm::mat3 clipToScreen(mScreenWidth * 0.5f, 0.0f, 0.0f,
+                                     0.0f, -mScreenHeight * 0.5f, 0.0f,
+                                     mScreenWidth * 0.5f, mScreenHeight * 0.5f, 1.0f);
+        mWorldToScreen = clipToScreen * worldToClip;
+        mScreenToWorld = glm::inverse(mWorldToScreen);
+
         mNeedsMatrixUpdate = false;
     }
 }
@@ -56,43 +96,40 @@ void Camera2D::update()
 // Returns true if the primitive is within the camera frustrum, false otherwise.
 // The position is assumed to in the center of the object, and the dimensions is the size of the collider
 // surrounding the primitive.
-bool Camera2D::isInView(const glm::vec2& position, const glm::vec2& dimensions) {
+bool Camera2D::isInView(const glm::vec2& position, const glm::vec2& dimensions) const {
 
-    const glm::vec2 scaledScreenDimensions = glm::vec2(mScreenWidth, mScreenHeight) / mScale;
+    // Half the size of the primitive. The position of the primitive is assumed to be in the center.
+    const glm::vec2 halfDims = dimensions * 0.5f;
 
-    // Calculate the minimum distance between the primitive and the camera for them to be considered seperated.
-    // The position of the primitive is assumed to be in the center.
-    const float minX = dimensions.x * 0.5f + scaledScreenDimensions.x * 0.5f;
-    const float minY = dimensions.y * 0.5f + scaledScreenDimensions.y * 0.5f;
+    // Separated unless the primitive reaches past both edges of the cached view rect on each axis.
+    return position.x + halfDims.x > mViewAABB.min.x && position.x - halfDims.x < mViewAABB.max.x &&
+           position.y + halfDims.y > mViewAABB.min.y && position.y - halfDims.y < mViewAABB.max.y;
+}
 
-    // Center of the primitive.
-    const glm::vec2 centerPos = position;
+void Camera2D::isInView(const AABB* boxes, const size_t count, uint32_t* outMask) const
+{
+    cullAABBs(boxes, count, mViewAABB, outMask);
+}
 
-    // Distance from camera center to primitive center. Camera position is already centered.
-    const float xDistance = centerPos.x - mPosition.x;
-    const float yDistance = centerPos.y - mPosition.y;
+// This function converts screen coordinates to engine world coordinates
+glm::vec2 Camera2D::convertScreen2World(const glm::vec2& screenCoords) const
+{
+    return transformPoint(mScreenToWorld, screenCoords);
+}
 
-    const float collisionDepthX = minX - abs(xDistance);
-    const float collisionDepthY = minY - abs(yDistance);
+// This function converts engine world coordinates to screen coordinates
+glm::vec2 Camera2D::convertWorld2Screen(const glm::vec2& worldCoords) const
+{
+    return transformPoint(mWorldToScreen, worldCoords);
+}
 
-    if (collisionDepthX > 0 && collisionDepthY > 0) {
-        return true;
-    }
-    return false;
+void Camera2D::convertScreen2World(const glm::vec2* screenCoords, const size_t count, glm::vec2* outWorldCoords) const
+{
+    transformPoints(mScreenToWorld, screenCoords, count, outWorldCoords);
 }
 
-// This function converts screen coordinates to engine world coordinates
-glm::vec2 Camera2D::convertScreen2World(glm::vec2& screenCoords)
+void Camera2D::convertWorld2Screen(const glm::vec2* worldCoords, const size_t count, glm::vec2* outScreenCoords) const
 {
-    // Invert Y direction
-    screenCoords.y = mScreenHeight - screenCoords.y;
-    // Convert origin to middle of screen
-    screenCoords -= glm::vec2(mScreenWidth >> 1, mScreenHeight >> 1);
-    // Take zooming (scale) into account
-    screenCoords /= mScale;
-    // Translate
-    screenCoords += mPosition;
-
-    return screenCoords;
+    transformPoints(mWorldToScreen, worldCoords, count, outScreenCoords);
 }
 
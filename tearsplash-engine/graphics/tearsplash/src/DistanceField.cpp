@@ -0,0 +1,137 @@
+#include "Tearsplash/DistanceField.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEARSPLASH_SDF_SSE 1
+#include <emmintrin.h>
+#endif
+
+using namespace Tearsplash;
+
+namespace {
+    const float FAR_AWAY = 1e20f;
+
+    struct TransformScratch {
+        std::vector<float> f;
+        std::vector<float> d;
+        std::vector<int> v;
+        std::vector<float> z;
+    };
+
+    // Squared distance transform of n samples stride apart, in place, after
+    // Felzenszwalb and Huttenlocher: the lower envelope of the parabolas rooted at
+    // each sample.
+    void transform1D(float* grid, const int n, const int stride, TransformScratch& scratch) {
+        float* f = scratch.f.data();
+        float* d = scratch.d.data();
+        int* v = scratch.v.data();
+        float* z = scratch.z.data();
+
+        for (int q = 0; q < n; q++) {
+            f[q] = grid[q * stride];
+        }
+
+        int k = 0;
+        v[0] = 0;
+        z[0] = -FAR_AWAY;
+        z[1] = FAR_AWAY;
+        for (int q = 1; q < n; q++) {
+            float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+            while (s <= z[k]) {
+                k--;
+                s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+            }
+            k++;
+            v[k] = q;
+            z[k] = s;
+            z[k + 1] = FAR_AWAY;
+        }
+
+        k = 0;
+        for (int q = 0; q < n; q++) {
+            while (z[k + 1] < q) {
+                k++;
+            }
+            const float offset = static_cast<float>(q - v[k]);
+            d[q] = offset * offset + f[v[k]];
+        }
+
+        for (int q = 0; q < n; q++) {
+            grid[q * stride] = d[q];
+        }
+    }
+
+    void transform2D(std::vector<float>& grid, const int width, const int height, TransformScratch& scratch) {
+        for (int x = 0; x < width; x++) {
+            transform1D(grid.data() + x, height, width, scratch);
+        }
+        for (int y = 0; y < height; y++) {
+            transform1D(grid.data() + y * width, width, 1, scratch);
+        }
+    }
+
+    // Pixel centers are half a pixel from the edge between inside and outside,
+    // hence the 0.5 taken off both distances.
+    unsigned char quantize(const float outside, const float inside, const float scale) {
+        const float distance = std::max(std::sqrt(outside) - 0.5f, 0.0f) - std::max(std::sqrt(inside) - 0.5f, 0.0f);
+        const float value = 128.0f - distance * scale;
+        return static_cast<unsigned char>(std::min(std::max(value + 0.5f, 0.0f), 255.0f));
+    }
+}
+
+void Tearsplash::generateSignedDistanceField(const unsigned char* coverage, const int width, const int height, const int pitch,
+                                             const int spread, std::vector<unsigned char>& out) {
+    const int fieldWidth = width + 2 * spread;
+    const int fieldHeight = height + 2 * spread;
+    const size_t count = static_cast<size_t>(fieldWidth) * fieldHeight;
+
+    // Squared distance to the nearest inside pixel, and to the nearest outside one.
+    std::vector<float> outside(count, FAR_AWAY);
+    std::vector<float> inside(count, 0.0f);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (coverage[y * pitch + x] >= 128) {
+                const size_t i = static_cast<size_t>(y + spread) * fieldWidth + x + spread;
+                outside[i] = 0.0f;
+                inside[i] = FAR_AWAY;
+            }
+        }
+    }
+
+    TransformScratch scratch;
+    const int longest = std::max(fieldWidth, fieldHeight);
+    scratch.f.resize(longest);
+    scratch.d.resize(longest);
+    scratch.v.resize(longest);
+    scratch.z.resize(longest + 1);
+    transform2D(outside, fieldWidth, fieldHeight, scratch);
+    transform2D(inside, fieldWidth, fieldHeight, scratch);
+
+    out.resize(count);
+    const float scale = 127.0f / spread;
+    size_t i = 0;
+#ifdef TEARSPLASH_SDF_SSE
+    // Eight pixels per step, the sqrt and clamping dominate once the transforms are done.
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 scaleVector = _mm_set1_ps(scale);
+    const __m128 edge = _mm_set1_ps(128.0f);
+    const __m128 white = _mm_set1_ps(255.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m128i values[2];
+        for (int part = 0; part < 2; part++) {
+            const __m128 outsideDistance = _mm_max_ps(_mm_sub_ps(_mm_sqrt_ps(_mm_loadu_ps(&outside[i + part * 4])), half), zero);
+            const __m128 insideDistance = _mm_max_ps(_mm_sub_ps(_mm_sqrt_ps(_mm_loadu_ps(&inside[i + part * 4])), half), zero);
+            const __m128 value = _mm_sub_ps(edge, _mm_mul_ps(_mm_sub_ps(outsideDistance, insideDistance), scaleVector));
+            values[part] = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(value, zero), white));
+        }
+        const __m128i words = _mm_packs_epi32(values[0], values[1]);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&out[i]), _mm_packus_epi16(words, words));
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = quantize(outside[i], inside[i], scale);
+    }
+}
@@ -0,0 +1,240 @@
+#include "Tearsplash/ECS.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Tearsplash/Errors.h"
+
+using namespace Tearsplash;
+
+namespace {
+    // Small enough that a chunk stays resident in L1/L2 while a system walks it.
+    const uint32_t CHUNK_BYTES = 16 * 1024;
+    const uint32_t COLUMN_ALIGNMENT = 16;
+
+    struct ComponentInfo {
+        size_t size;
+        size_t alignment;
+    };
+
+    std::vector<ComponentInfo>& getComponentInfos() {
+        static std::vector<ComponentInfo> infos;
+        return infos;
+    }
+
+    std::mutex gRegistryMutex;
+
+    uint32_t alignUp(const uint32_t value, const uint32_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+uint32_t ComponentRegistry::registerType(const size_t size, const size_t alignment) {
+    std::lock_guard<std::mutex> lock(gRegistryMutex);
+    std::vector<ComponentInfo>& infos = getComponentInfos();
+    if (infos.size() >= MAX_COMPONENT_TYPES) {
+        fatalError("Too many component types, at most " + std::to_string(MAX_COMPONENT_TYPES) + " are supported");
+    }
+    if (alignment > COLUMN_ALIGNMENT) {
+        fatalError("Component alignment of " + std::to_string(alignment) + " is not supported");
+    }
+    infos.push_back({ size, alignment });
+    return static_cast<uint32_t>(infos.size() - 1);
+}
+
+size_t ComponentRegistry::getSize(const uint32_t id) {
+    std::lock_guard<std::mutex> lock(gRegistryMutex);
+    return getComponentInfos()[id].size;
+}
+
+size_t ComponentRegistry::getAlignment(const uint32_t id) {
+    std::lock_guard<std::mutex> lock(gRegistryMutex);
+    return getComponentInfos()[id].alignment;
+}
+
+Archetype::Archetype(const ComponentMask mask) : mMask(mask), mChunkCapacity(0), mChunkBytes(0) {
+    mColumns.fill(-1);
+
+    mColumnSizes.push_back(sizeof(Entity));
+    for (uint32_t id = 0; id < MAX_COMPONENT_TYPES; id++) {
+        if ((mask >> id) & 1u) {
+            mColumns[id] = static_cast<int>(mColumnSizes.size());
+            mColumnSizes.push_back(static_cast<uint32_t>(ComponentRegistry::getSize(id)));
+        }
+    }
+
+    uint32_t rowBytes = 0;
+    for (const uint32_t size : mColumnSizes) {
+        rowBytes += size;
+    }
+
+    // As many rows as fit once every column is padded to its alignment, at least one.
+    const auto layoutBytes = [this](const uint32_t capacity) {
+        uint32_t bytes = 0;
+        for (const uint32_t size : mColumnSizes) {
+            bytes = alignUp(bytes, COLUMN_ALIGNMENT) + size * capacity;
+        }
+        return bytes;
+    };
+    mChunkCapacity = std::max(CHUNK_BYTES / rowBytes, 1u);
+    while (mChunkCapacity > 1 && layoutBytes(mChunkCapacity) > CHUNK_BYTES) {
+        mChunkCapacity--;
+    }
+
+    uint32_t offset = 0;
+    for (const uint32_t size : mColumnSizes) {
+        offset = alignUp(offset, COLUMN_ALIGNMENT);
+        mColumnOffsets.push_back(offset);
+        offset += size * mChunkCapacity;
+    }
+    mChunkBytes = offset;
+}
+
+void Archetype::allocateRow(const Entity entity, uint32_t& outChunk, uint32_t& outRow) {
+    if (mChunks.empty() || mChunks.back().count == mChunkCapacity) {
+        ArchetypeChunk chunk;
+        chunk.data.reset(new uint8_t[mChunkBytes]);
+        chunk.count = 0;
+        mChunks.push_back(std::move(chunk));
+    }
+
+    outChunk = static_cast<uint32_t>(mChunks.size() - 1);
+    ArchetypeChunk& chunk = mChunks.back();
+    outRow = chunk.count++;
+    getEntities(chunk)[outRow] = entity;
+}
+
+Entity Archetype::removeRow(const uint32_t chunkIndex, const uint32_t row) {
+    ArchetypeChunk& last = mChunks.back();
+    const uint32_t lastChunkIndex = static_cast<uint32_t>(mChunks.size() - 1);
+    const uint32_t lastRow = last.count - 1;
+
+    Entity moved = NULL_ENTITY;
+    if (chunkIndex != lastChunkIndex || row != lastRow) {
+        ArchetypeChunk& chunk = mChunks[chunkIndex];
+        for (size_t column = 0; column < mColumnSizes.size(); column++) {
+            const uint32_t size = mColumnSizes[column];
+            std::memcpy(chunk.data.get() + mColumnOffsets[column] + row * size,
+                        last.data.get() + mColumnOffsets[column] + lastRow * size, size);
+        }
+        moved = getEntities(chunk)[row];
+    }
+
+    last.count--;
+    if (last.count == 0) {
+        mChunks.pop_back();
+    }
+    return moved;
+}
+
+World::World() : mNumAlive(0) {
+}
+
+World::~World() {
+    // Do nothing.
+}
+
+Entity World::create() {
+    uint32_t index;
+    if (mFreeIndices.empty()) {
+        index = static_cast<uint32_t>(mRecords.size());
+        mRecords.push_back({ nullptr, 0, 0, 0 });
+    }
+    else {
+        index = mFreeIndices.back();
+        mFreeIndices.pop_back();
+    }
+
+    EntityRecord& record = mRecords[index];
+    const Entity entity = { index, record.generation };
+    record.archetype = getArchetype(0);
+    record.archetype->allocateRow(entity, record.chunk, record.row);
+    mNumAlive++;
+
+    return entity;
+}
+
+void World::destroy(const Entity entity) {
+    if (!isAlive(entity)) {
+        return;
+    }
+
+    EntityRecord& record = mRecords[entity.index];
+    removeFromArchetype(record);
+    record.archetype = nullptr;
+    record.generation++;
+    mFreeIndices.push_back(entity.index);
+    mNumAlive--;
+}
+
+bool World::isAlive(const Entity entity) const {
+    return entity.index < mRecords.size() &&
+           mRecords[entity.index].generation == entity.generation &&
+           mRecords[entity.index].archetype != nullptr;
+}
+
+void World::queueDestroy(const Entity entity) {
+    std::lock_guard<std::mutex> lock(mDestroyQueueMutex);
+    mDestroyQueue.push_back(entity);
+}
+
+void World::flushDestroyed() {
+    std::lock_guard<std::mutex> lock(mDestroyQueueMutex);
+    // destroy ignores stale handles, so queueing an entity twice is harmless.
+    for (const Entity entity : mDestroyQueue) {
+        destroy(entity);
+    }
+    mDestroyQueue.clear();
+}
+
+Archetype* World::getArchetype(const ComponentMask mask) {
+    auto it = mArchetypesByMask.find(mask);
+    if (it != mArchetypesByMask.end()) {
+        return it->second;
+    }
+
+    mArchetypes.push_back(std::make_unique<Archetype>(mask));
+    Archetype* archetype = mArchetypes.back().get();
+    mArchetypesByMask[mask] = archetype;
+    return archetype;
+}
+
+void World::moveEntity(const Entity entity, Archetype* archetype) {
+    EntityRecord& record = mRecords[entity.index];
+    Archetype* source = record.archetype;
+    ArchetypeChunk& sourceChunk = source->getChunks()[record.chunk];
+
+    uint32_t chunk;
+    uint32_t row;
+    archetype->allocateRow(entity, chunk, row);
+    ArchetypeChunk& destinationChunk = archetype->getChunks()[chunk];
+
+    // Copy the components both archetypes have, the caller initializes any new one.
+    const ComponentMask shared = source->getMask() & archetype->getMask();
+    for (uint32_t id = 0; id < MAX_COMPONENT_TYPES; id++) {
+        if ((shared >> id) & 1u) {
+            std::memcpy(archetype->getComponent(destinationChunk, id, row),
+                        source->getComponent(sourceChunk, id, record.row),
+                        archetype->getComponentSize(id));
+        }
+    }
+
+    removeFromArchetype(record);
+    record.archetype = archetype;
+    record.chunk = chunk;
+    record.row = row;
+}
+
+void World::removeFromArchetype(const EntityRecord& record) {
+    const Entity moved = record.archetype->removeRow(record.chunk, record.row);
+    if (moved != NULL_ENTITY) {
+        // The last entity of the archetype took over the removed row.
+        mRecords[moved.index].chunk = record.chunk;
+        mRecords[moved.index].row = record.row;
+    }
+}
+
+void* World::getComponentPointer(const Entity entity, const uint32_t componentId) {
+    const EntityRecord& record = mRecords[entity.index];
+    return record.archetype->getComponent(record.archetype->getChunks()[record.chunk], componentId, record.row);
+}
@@ -0,0 +1,114 @@
+#include "Tearsplash/ECSSystems.h"
+
+#include "Tearsplash/Profiler.h"
+#include "Tearsplash/SpriteAnimator.h"
+#include "Tearsplash/Spritebatch.h"
+
+using namespace Tearsplash;
+
+namespace {
+    void drawSprite(Spritebatch& spriteBatch, const TransformComponent& transform, const SpriteComponent& sprite, const glm::vec2& position, const float alpha) {
+        const float angle = glm::mix(transform.prevAngle, transform.angle, alpha);
+        const glm::vec4 destRect(position - sprite.dimensions * 0.5f, sprite.dimensions);
+        spriteBatch.draw(destRect, sprite.uvRect, sprite.texture, sprite.depth, sprite.color, angle);
+    }
+}
+
+void Tearsplash::integrateVelocities(World& world, const float deltaTime) {
+    TS_PROFILE_SCOPE("integrateVelocities");
+
+    world.eachChunk<TransformComponent, const VelocityComponent>(
+        [deltaTime](const size_t count, const Entity*, TransformComponent* transforms, const VelocityComponent* velocities) {
+            for (size_t i = 0; i < count; i++) {
+                transforms[i].prevPosition = transforms[i].position;
+                transforms[i].prevAngle = transforms[i].angle;
+                transforms[i].position += velocities[i].velocity * deltaTime;
+            }
+        });
+}
+
+void Tearsplash::updateLifetimes(World& world, const float deltaTime) {
+    TS_PROFILE_SCOPE("updateLifetimes");
+
+    world.eachChunk<LifetimeComponent>([&world, deltaTime](const size_t count, const Entity* entities, LifetimeComponent* lifetimes) {
+        for (size_t i = 0; i < count; i++) {
+            lifetimes[i].remaining -= deltaTime;
+            if (lifetimes[i].remaining <= 0.0f) {
+                world.queueDestroy(entities[i]);
+            }
+        }
+    });
+}
+
+void Tearsplash::syncPhysicsBodies(World& world, const std::vector<PhysicsTransform>& physicsTransforms) {
+    TS_PROFILE_SCOPE("syncPhysicsBodies");
+
+    const PhysicsTransform* sources = physicsTransforms.data();
+    world.eachChunk<TransformComponent, const PhysicsBodyComponent>(
+        [sources](const size_t count, const Entity*, TransformComponent* transforms, const PhysicsBodyComponent* bodies) {
+            for (size_t i = 0; i < count; i++) {
+                const PhysicsTransform& source = sources[bodies[i].physicsHandle];
+                transforms[i].position = source.position;
+                transforms[i].prevPosition = source.prevPosition;
+                transforms[i].angle = source.angle;
+                transforms[i].prevAngle = source.prevAngle;
+            }
+        });
+}
+
+void Tearsplash::applyAnimations(World& world, const SpriteAnimator& animator) {
+    TS_PROFILE_SCOPE("applyAnimations");
+
+    world.eachChunk<SpriteComponent, const AnimationComponent>(
+        [&animator](const size_t count, const Entity*, SpriteComponent* sprites, const AnimationComponent* animations) {
+            for (size_t i = 0; i < count; i++) {
+                sprites[i].uvRect = animator.getUV(animations[i].animation);
+                sprites[i].texture = animator.getTexture(animations[i].animation);
+            }
+        });
+}
+
+void Tearsplash::drawSprites(World& world, Spritebatch& spriteBatch, const AABB& view, const float alpha, const ComponentMask excluded) {
+    TS_PROFILE_SCOPE("drawSprites");
+
+    world.eachChunkExcluding<const TransformComponent, const SpriteComponent>(excluded,
+        [&spriteBatch, &view, alpha](const size_t count, const Entity*, const TransformComponent* transforms, const SpriteComponent* sprites) {
+            for (size_t i = 0; i < count; i++) {
+                const glm::vec2 position = glm::mix(transforms[i].prevPosition, transforms[i].position, alpha);
+                const SpriteComponent& sprite = sprites[i];
+
+                // Rotated sprites reach at most half the diagonal from their center.
+                const float diagonal = glm::length(sprite.dimensions);
+                if (!AABB::fromCenter(position, glm::vec2(diagonal)).overlaps(view)) {
+                    continue;
+                }
+
+                drawSprite(spriteBatch, transforms[i], sprite, position, alpha);
+            }
+        });
+}
+
+void Tearsplash::drawSprites(World& world, Spritebatch& spriteBatch, const std::vector<Entity>& entities, const float alpha) {
+    TS_PROFILE_SCOPE("drawSprites");
+
+    for (const Entity entity : entities) {
+        const TransformComponent& transform = *world.get<TransformComponent>(entity);
+        const glm::vec2 position = glm::mix(transform.prevPosition, transform.position, alpha);
+        drawSprite(spriteBatch, transform, *world.get<SpriteComponent>(entity), position, alpha);
+    }
+}
+
+void Tearsplash::addDefaultSystems(SystemScheduler& scheduler, const std::vector<PhysicsTransform>& physicsTransforms) {
+    scheduler.add("integrateVelocities",
+        ComponentRegistry::mask<VelocityComponent>(),
+        ComponentRegistry::mask<TransformComponent>(),
+        integrateVelocities);
+    scheduler.add("updateLifetimes",
+        0,
+        ComponentRegistry::mask<LifetimeComponent>(),
+        updateLifetimes);
+    scheduler.add("syncPhysicsBodies",
+        ComponentRegistry::mask<PhysicsBodyComponent>(),
+        ComponentRegistry::mask<TransformComponent>(),
+        [&physicsTransforms](World& world, const float) { syncPhysicsBodies(world, physicsTransforms); });
+}
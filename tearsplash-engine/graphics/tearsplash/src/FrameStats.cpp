@@ -0,0 +1,127 @@
+#include "Tearsplash/FrameStats.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <imgui/imgui.h>
+
+using namespace Tearsplash;
+
+namespace {
+    float toMs(const uint64_t microseconds) {
+        return static_cast<float>(microseconds) * 0.001f;
+    }
+
+    // Index of the sample at the given fraction of the sorted samples (nearest rank).
+    int percentileIndex(const int numSamples, const float fraction) {
+        const int index = static_cast<int>(fraction * numSamples + 0.5f) - 1;
+        return std::max(0, std::min(index, numSamples - 1));
+    }
+}
+
+FrameStats::FrameStats() : mNextSample(0), mNumSamples(0), mDirty(true) {
+    mFrameTimesUs.fill(0);
+    mHistogram.fill(0.0f);
+    mSortScratch.reserve(NUM_SAMPLES);
+}
+
+FrameStats::~FrameStats() {
+    // Do nothing.
+}
+
+void FrameStats::addSample(const uint64_t frameTimeMicroseconds) {
+    mFrameTimesUs[mNextSample] = static_cast<uint32_t>(std::min<uint64_t>(frameTimeMicroseconds, std::numeric_limits<uint32_t>::max()));
+    mNextSample = (mNextSample + 1) % NUM_SAMPLES;
+    mNumSamples = std::min(mNumSamples + 1, static_cast<int>(NUM_SAMPLES));
+    mDirty = true;
+}
+
+void FrameStats::reset() {
+    mNextSample = 0;
+    mNumSamples = 0;
+    mDirty = true;
+}
+
+uint32_t FrameStats::getSampleMicroseconds(const int i) const {
+    // Once the ring is full the oldest sample is the one about to be overwritten.
+    const int oldest = mNumSamples < NUM_SAMPLES ? 0 : mNextSample;
+    return mFrameTimesUs[(oldest + i) % NUM_SAMPLES];
+}
+
+const FrameStatsSummary& FrameStats::getSummary() const {
+    if (mDirty) {
+        updateSummary();
+    }
+    return mSummary;
+}
+
+const std::array<float, FrameStats::NUM_HISTOGRAM_BUCKETS>& FrameStats::getHistogram() const {
+    if (mDirty) {
+        updateSummary();
+    }
+    return mHistogram;
+}
+
+void FrameStats::updateSummary() const {
+    mSummary = FrameStatsSummary();
+    mHistogram.fill(0.0f);
+    mDirty = false;
+
+    if (mNumSamples == 0) {
+        return;
+    }
+
+    mSortScratch.assign(mFrameTimesUs.begin(), mFrameTimesUs.begin() + mNumSamples);
+
+    uint64_t totalUs = 0;
+    for (const uint32_t sample : mSortScratch) {
+        totalUs += sample;
+
+        const int bucket = std::min(static_cast<int>(toMs(sample) / getHistogramBucketMs()), NUM_HISTOGRAM_BUCKETS - 1);
+        mHistogram[bucket] += 1.0f;
+    }
+
+    std::sort(mSortScratch.begin(), mSortScratch.end());
+
+    mSummary.numSamples = mNumSamples;
+    mSummary.minMs = toMs(mSortScratch.front());
+    mSummary.maxMs = toMs(mSortScratch.back());
+    mSummary.p95Ms = toMs(mSortScratch[percentileIndex(mNumSamples, 0.95f)]);
+    mSummary.p99Ms = toMs(mSortScratch[percentileIndex(mNumSamples, 0.99f)]);
+    mSummary.avgMs = toMs(totalUs) / mNumSamples;
+    if (totalUs > 0) {
+        mSummary.fps = 1000.0f / mSummary.avgMs;
+    }
+}
+
+void FrameStats::drawImGuiOverlay(const char* title) const {
+    if (beginImGuiOverlay(title)) {
+        drawImGui();
+    }
+    ImGui::End();
+}
+
+void FrameStats::drawImGui() const {
+    const FrameStatsSummary& summary = getSummary();
+
+    ImGui::Text("%.1f fps (%d frames)", summary.fps, summary.numSamples);
+    ImGui::Text("avg %.2f ms  min %.2f ms  max %.2f ms", summary.avgMs, summary.minMs, summary.maxMs);
+    ImGui::Text("p95 %.2f ms  p99 %.2f ms", summary.p95Ms, summary.p99Ms);
+
+    ImGui::PlotLines("##frametimes",
+        [](void* data, int i) { return toMs(static_cast<const FrameStats*>(data)->getSampleMicroseconds(i)); },
+        const_cast<FrameStats*>(this), mNumSamples, 0, "frame time (ms)", 0.0f, 2.0f * summary.p99Ms, ImVec2(256.0f, 48.0f));
+
+    const std::array<float, NUM_HISTOGRAM_BUCKETS>& histogram = getHistogram();
+    ImGui::PlotHistogram("##histogram", histogram.data(), NUM_HISTOGRAM_BUCKETS, 0, "histogram, 1 ms buckets", 0.0f, FLT_MAX, ImVec2(256.0f, 48.0f));
+}
+
+bool FrameStats::beginImGuiOverlay(const char* title) {
+    // Pin the overlay to the top right corner.
+    const ImVec2 displaySize = ImGui::GetIO().DisplaySize;
+    ImGui::SetNextWindowPos(ImVec2(displaySize.x - 10.0f, 10.0f), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+    ImGui::SetNextWindowBgAlpha(0.35f);
+    const ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize |
+                                   ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav;
+    return ImGui::Begin(title, nullptr, flags);
+}
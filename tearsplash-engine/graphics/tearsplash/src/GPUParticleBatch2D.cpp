@@ -0,0 +1,178 @@
+#include "Tearsplash/GPUParticleBatch2D.h"
+
+#include <algorithm>
+#include <cstddef>
+
+using namespace Tearsplash;
+
+GPUParticleBatch2D::GPUParticleBatch2D() :
+    mVAOs{ 0, 0 }, mVBOs{ 0, 0 },
+    mDeltaTimeLocation(-1), mDecayRateLocation(-1), mCameraMatrixLocation(-1), mTextureLocation(-1),
+    mCurrentBuffer(0), mSpawnIndex(0), mDecayRate(0), mMaxParticles(0) {
+}
+
+GPUParticleBatch2D::~GPUParticleBatch2D() {
+    destroy();
+}
+
+void GPUParticleBatch2D::init(const int numParticles, const float decayRate, Tearsplash::GLTexture& texture) {
+    mDecayRate = decayRate;
+    mMaxParticles = numParticles;
+    mCurrentBuffer = 0;
+    mSpawnIndex = 0;
+    mTexture = texture;
+
+    initShaders();
+    createBuffers();
+}
+
+void GPUParticleBatch2D::destroy() {
+    if (mVBOs[0] != 0) {
+        glDeleteBuffers(2, mVBOs);
+        mVBOs[0] = mVBOs[1] = 0;
+    }
+    if (mVAOs[0] != 0) {
+        glDeleteVertexArrays(2, mVAOs);
+        mVAOs[0] = mVAOs[1] = 0;
+    }
+    mSpawnQueue.clear();
+}
+
+void GPUParticleBatch2D::addParticle(const glm::vec2& position,
+    const glm::vec2& velocity,
+    ColorRGBA8& color,
+    const float width,
+    const float lifeTime) {
+    GPUParticle2D particle;
+    particle.position = position;
+    particle.velocity = velocity;
+    particle.color = glm::vec4(color.r, color.g, color.b, color.a) / 255.0f;
+    particle.width = width;
+    particle.lifeTime = lifeTime;
+    mSpawnQueue.push_back(particle);
+}
+
+void GPUParticleBatch2D::update(const float deltaTime) {
+    uploadSpawnedParticles();
+
+    const int source = mCurrentBuffer;
+    const int destination = 1 - mCurrentBuffer;
+
+    // Read from the source buffer and capture the simulated state into the destination.
+    // Nothing is rasterized during this pass.
+    glBindVertexArray(mVAOs[source]);
+    mUpdateShader.use();
+    glUniform1f(mDeltaTimeLocation, deltaTime);
+    glUniform1f(mDecayRateLocation, mDecayRate);
+
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, mVBOs[destination]);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, mMaxParticles);
+    glEndTransformFeedback();
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glDisable(GL_RASTERIZER_DISCARD);
+
+    mUpdateShader.dontuse();
+    glBindVertexArray(0);
+
+    mCurrentBuffer = destination;
+}
+
+void GPUParticleBatch2D::draw(const glm::mat4& cameraMatrix) {
+    glBindVertexArray(mVAOs[mCurrentBuffer]);
+    mRenderShader.use();
+    glUniformMatrix4fv(mCameraMatrixLocation, 1, GL_FALSE, &(cameraMatrix[0][0]));
+    glUniform1i(mTextureLocation, 0);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, mTexture.id);
+
+    // Each point is expanded into a quad by the geometry shader, dead ones are dropped there.
+    glDrawArrays(GL_POINTS, 0, mMaxParticles);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    mRenderShader.dontuse();
+    glBindVertexArray(0);
+}
+
+void GPUParticleBatch2D::createBuffers() {
+    // Both buffers start out with only dead particles.
+    std::vector<GPUParticle2D> particles(mMaxParticles, GPUParticle2D());
+
+    glGenVertexArrays(2, mVAOs);
+    glGenBuffers(2, mVBOs);
+
+    for (int i = 0; i < 2; i++) {
+        glBindVertexArray(mVAOs[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, mVBOs[i]);
+        glBufferData(GL_ARRAY_BUFFER, particles.size() * sizeof(GPUParticle2D), particles.data(), GL_DYNAMIC_COPY);
+
+        // The attribute indices follow the order the attributes were added to the shaders.
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glEnableVertexAttribArray(2);
+        glEnableVertexAttribArray(3);
+        glEnableVertexAttribArray(4);
+
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GPUParticle2D), (void*)offsetof(GPUParticle2D, position));
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GPUParticle2D), (void*)offsetof(GPUParticle2D, velocity));
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(GPUParticle2D), (void*)offsetof(GPUParticle2D, color));
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(GPUParticle2D), (void*)offsetof(GPUParticle2D, width));
+        glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, sizeof(GPUParticle2D), (void*)offsetof(GPUParticle2D, lifeTime));
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GPUParticleBatch2D::initShaders() {
+    // Simulation pass, captures the vertex shader outputs in the same layout as GPUParticle2D.
+    mUpdateShader.compileShaders("tearsplash/shaders/2DParticleUpdate.vert");
+    mUpdateShader.addAttribute("particlePosition");
+    mUpdateShader.addAttribute("particleVelocity");
+    mUpdateShader.addAttribute("particleColor");
+    mUpdateShader.addAttribute("particleWidth");
+    mUpdateShader.addAttribute("particleLifeTime");
+    mUpdateShader.setTransformFeedbackVaryings({ "outPosition", "outVelocity", "outColor", "outWidth", "outLifeTime" });
+    mUpdateShader.linkShaders();
+
+    mDeltaTimeLocation = mUpdateShader.getUniformLocation("deltaTime");
+    mDecayRateLocation = mUpdateShader.getUniformLocation("decayRate");
+
+    // Render pass.
+    mRenderShader.compileShaders("tearsplash/shaders/2DParticle.vert", "tearsplash/shaders/2DParticle.geom", "tearsplash/shaders/2DParticle.frag");
+    mRenderShader.addAttribute("particlePosition");
+    mRenderShader.addAttribute("particleVelocity");
+    mRenderShader.addAttribute("particleColor");
+    mRenderShader.addAttribute("particleWidth");
+    mRenderShader.addAttribute("particleLifeTime");
+    mRenderShader.linkShaders();
+
+    mCameraMatrixLocation = mRenderShader.getUniformLocation("P");
+    mTextureLocation = mRenderShader.getUniformLocation("texSampler");
+}
+
+void GPUParticleBatch2D::uploadSpawnedParticles() {
+    if (mSpawnQueue.empty()) {
+        return;
+    }
+
+    // If more particles were spawned than fit in the batch, only the newest ones survive.
+    const int numSpawned = static_cast<int>(std::min(mSpawnQueue.size(), static_cast<size_t>(mMaxParticles)));
+    const GPUParticle2D* spawned = mSpawnQueue.data() + (mSpawnQueue.size() - numSpawned);
+
+    glBindBuffer(GL_ARRAY_BUFFER, mVBOs[mCurrentBuffer]);
+
+    // Write into the ring, split in two uploads when wrapping around the end of the buffer.
+    const int firstCount = std::min(numSpawned, mMaxParticles - mSpawnIndex);
+    glBufferSubData(GL_ARRAY_BUFFER, mSpawnIndex * sizeof(GPUParticle2D), firstCount * sizeof(GPUParticle2D), spawned);
+    if (firstCount < numSpawned) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, (numSpawned - firstCount) * sizeof(GPUParticle2D), spawned + firstCount);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    mSpawnIndex = (mSpawnIndex + numSpawned) % mMaxParticles;
+    mSpawnQueue.clear();
+}
@@ -0,0 +1,142 @@
+#include "Tearsplash/GPUTimer.h"
+#include "Tearsplash/Errors.h"
+
+#include <imgui/imgui.h>
+
+using namespace Tearsplash;
+
+namespace {
+    // Weight of the newest sample in the moving average.
+    const float AVERAGE_WEIGHT = 0.1f;
+
+    // Frames the GPU may lag behind before we stop issuing new queries, so a
+    // stuck driver can't make the pool grow without bound.
+    const size_t MAX_FRAMES_IN_FLIGHT = 8;
+}
+
+GPUTimer::GPUTimer() : mPassActive(false), mFirstFrameRead(false) {
+}
+
+GPUTimer::~GPUTimer() {
+    // Do nothing. Call destroy() while the GL context is alive.
+}
+
+void GPUTimer::destroy() {
+    for (auto& frame : mPendingFrames) {
+        for (auto& pass : frame) {
+            mFreeQueries.push_back(pass.query);
+        }
+    }
+    mPendingFrames.clear();
+
+    if (!mFreeQueries.empty()) {
+        glDeleteQueries(static_cast<GLsizei>(mFreeQueries.size()), mFreeQueries.data());
+        mFreeQueries.clear();
+    }
+    mResults.clear();
+    mFirstFrameRead = false;
+}
+
+void GPUTimer::beginFrame() {
+    if (mPassActive) {
+        softError("GPUTimer::beginFrame called with a pass still active");
+        endPass();
+    }
+
+    // Frames finish in order, so stop at the first one that isn't done.
+    while (!mPendingFrames.empty() && isFrameAvailable(mPendingFrames.front())) {
+        readFrame(mPendingFrames.front());
+        for (auto& pass : mPendingFrames.front()) {
+            mFreeQueries.push_back(pass.query);
+        }
+        mPendingFrames.pop_front();
+    }
+
+    mPendingFrames.emplace_back();
+}
+
+void GPUTimer::beginPass(const char* name) {
+    if (mPendingFrames.empty() || mPendingFrames.size() > MAX_FRAMES_IN_FLIGHT) {
+        // No frame begun, or the GPU is too far behind. Skip measuring this pass.
+        return;
+    }
+    if (mPassActive) {
+        softError("GPUTimer passes can't be nested");
+        return;
+    }
+
+    const GLuint query = acquireQuery();
+    mPendingFrames.back().push_back({ name, query });
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    mPassActive = true;
+}
+
+void GPUTimer::endPass() {
+    if (mPassActive) {
+        glEndQuery(GL_TIME_ELAPSED);
+        mPassActive = false;
+    }
+}
+
+void GPUTimer::drawImGui() const {
+    ImGui::Text("GPU (%d frames in flight)", getFramesInFlight());
+    for (const GPUPassTime& pass : mResults) {
+        ImGui::Text("  %-12s %6.3f ms (avg %6.3f ms)", pass.name, pass.ms, pass.avgMs);
+    }
+}
+
+GLuint GPUTimer::acquireQuery() {
+    if (mFreeQueries.empty()) {
+        GLuint query;
+        glGenQueries(1, &query);
+        return query;
+    }
+
+    const GLuint query = mFreeQueries.back();
+    mFreeQueries.pop_back();
+    return query;
+}
+
+bool GPUTimer::isFrameAvailable(const FrameQueries& frame) const {
+    for (const PassQuery& pass : frame) {
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(pass.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void GPUTimer::readFrame(const FrameQueries& frame) {
+    std::vector<GPUPassTime> results;
+    results.reserve(frame.size());
+
+    for (const PassQuery& pass : frame) {
+        GLuint64 elapsedNs = 0;
+        glGetQueryObjectui64v(pass.query, GL_QUERY_RESULT, &elapsedNs);
+        const float ms = static_cast<float>(elapsedNs) * 1e-6f;
+
+        // Carry the average over from the pass with the same name last time.
+        float avgMs = ms;
+        for (const GPUPassTime& previous : mResults) {
+            if (previous.name == pass.name) {
+                avgMs = previous.avgMs + (ms - previous.avgMs) * AVERAGE_WEIGHT;
+                break;
+            }
+        }
+        results.push_back({ pass.name, ms, avgMs });
+    }
+
+    // Some drivers, llvmpipe among them, report nonsense for the very first
+    // time elapsed query, so the first frame is thrown away.
+    if (!mFirstFrameRead) {
+        mFirstFrameRead = !frame.empty();
+        return;
+    }
+
+    // Frames with no passes keep the previous results on screen.
+    if (!results.empty()) {
+        mResults.swap(results);
+    }
+}
@@ -0,0 +1,146 @@
+#include "Tearsplash/GlyphAtlas.h"
+
+using namespace Tearsplash;
+
+GlyphAtlas::GlyphAtlas() :
+    mCurrentPage(-1), mPageSize(1024), mPadding(1), mMaxPages(4), mFrame(0), mNumEvictions(0) {
+}
+
+GlyphAtlas::~GlyphAtlas() {
+    // Do nothing.
+}
+
+void GlyphAtlas::init(const int pageSize, const int padding, const int maxPages) {
+    destroy();
+    mPageSize = pageSize;
+    mPadding = padding;
+    mMaxPages = maxPages;
+}
+
+void GlyphAtlas::destroy() {
+    for (Page& page : mPages) {
+        glDeleteTextures(1, &page.texture);
+    }
+    mPages.clear();
+    mCurrentPage = -1;
+}
+
+bool GlyphAtlas::insert(const int width, const int height, const unsigned char* pixels, const int pitch, GlyphAtlasRegion& region) {
+    region.texture = 0;
+    region.page = -1;
+    region.generation = 0;
+    region.uvRect = glm::vec4(0.0f);
+    if (width <= 0 || height <= 0) {
+        return true;
+    }
+
+    const int paddedWidth = width + mPadding;
+    const int paddedHeight = height + mPadding;
+    if (paddedWidth + mPadding > mPageSize || paddedHeight + mPadding > mPageSize) {
+        return false;
+    }
+
+    int x = 0;
+    int y = 0;
+    if (mCurrentPage == -1 || !allocate(mPages[mCurrentPage], paddedWidth, paddedHeight, x, y)) {
+        if (static_cast<int>(mPages.size()) < mMaxPages) {
+            addPage();
+        }
+        else if (!evictPage()) {
+            return false;
+        }
+        allocate(mPages[mCurrentPage], paddedWidth, paddedHeight, x, y);
+    }
+
+    Page& page = mPages[mCurrentPage];
+    page.lastUsedFrame = mFrame;
+    glBindTexture(GL_TEXTURE_2D, page.texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RED, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Bitmap rows run top down from y, 2DText.vert samples at 1 - v.
+    const float size = static_cast<float>(mPageSize);
+    region.texture = page.texture;
+    region.page = mCurrentPage;
+    region.generation = page.generation;
+    region.uvRect = glm::vec4(x / size, 1.0f - (y + height) / size, width / size, height / size);
+    return true;
+}
+
+bool GlyphAtlas::allocate(Page& page, const int width, const int height, int& x, int& y) {
+    // The lowest shelf the block fits on wastes the least space.
+    Shelf* best = nullptr;
+    for (Shelf& shelf : page.shelves) {
+        if (shelf.height >= height && shelf.x + width <= mPageSize &&
+            (best == nullptr || shelf.height < best->height)) {
+            best = &shelf;
+        }
+    }
+
+    if (best == nullptr) {
+        if (page.nextShelfY + height > mPageSize) {
+            return false;
+        }
+        page.shelves.push_back({ page.nextShelfY, height, mPadding });
+        page.nextShelfY += height;
+        best = &page.shelves.back();
+    }
+
+    x = best->x;
+    y = best->y;
+    best->x += width;
+    return true;
+}
+
+void GlyphAtlas::addPage() {
+    Page page;
+    page.nextShelfY = mPadding;
+    page.generation = 0;
+    page.lastUsedFrame = mFrame;
+
+    // Cleared to zero so the padding around each bitmap is transparent.
+    const std::vector<unsigned char> zeros(static_cast<size_t>(mPageSize) * mPageSize, 0);
+    glGenTextures(1, &page.texture);
+    glBindTexture(GL_TEXTURE_2D, page.texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, mPageSize, mPageSize, 0, GL_RED, GL_UNSIGNED_BYTE, zeros.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    mPages.push_back(page);
+    mCurrentPage = static_cast<int>(mPages.size()) - 1;
+}
+
+bool GlyphAtlas::evictPage() {
+    int victim = -1;
+    for (int i = 0; i < static_cast<int>(mPages.size()); i++) {
+        if (mPages[i].lastUsedFrame < mFrame &&
+            (victim == -1 || mPages[i].lastUsedFrame < mPages[victim].lastUsedFrame)) {
+            victim = i;
+        }
+    }
+    if (victim == -1) {
+        return false;
+    }
+
+    Page& page = mPages[victim];
+    page.shelves.clear();
+    page.nextShelfY = mPadding;
+    page.generation++;
+    mNumEvictions++;
+
+    const std::vector<unsigned char> zeros(static_cast<size_t>(mPageSize) * mPageSize, 0);
+    glBindTexture(GL_TEXTURE_2D, page.texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, mPageSize, mPageSize, GL_RED, GL_UNSIGNED_BYTE, zeros.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    mCurrentPage = victim;
+    return true;
+}
@@ -0,0 +1,174 @@
+#include "Tearsplash/HeadlessContext.h"
+
+#include <cstring>
+
+#include "Tearsplash/Errors.h"
+
+#ifdef TEARSPLASH_HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+using namespace Tearsplash;
+
+#ifdef TEARSPLASH_HEADLESS_EGL
+namespace {
+    bool hasExtension(const char* extensions, const char* name) {
+        if (extensions == nullptr) {
+            return false;
+        }
+        const size_t length = std::strlen(name);
+        for (const char* found = std::strstr(extensions, name); found != nullptr; found = std::strstr(found + length, name)) {
+            const bool startsWord = found == extensions || found[-1] == ' ';
+            const bool endsWord = found[length] == ' ' || found[length] == '\0';
+            if (startsWord && endsWord) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    EGLDisplay openDisplay() {
+        // Surfaceless needs no window system at all, try it before the default display.
+        const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+            PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+                reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+            if (getPlatformDisplay != nullptr) {
+                EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+                if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+                    return display;
+                }
+            }
+        }
+
+        EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+            return display;
+        }
+        return EGL_NO_DISPLAY;
+    }
+}
+#endif
+
+HeadlessContext::HeadlessContext() :
+    mDisplay(nullptr), mSurface(nullptr), mContext(nullptr), mFramebuffer(0), mColorBuffer(0), mDepthBuffer(0) {
+}
+
+HeadlessContext::~HeadlessContext() {
+    // Do nothing.
+}
+
+bool HeadlessContext::create() {
+#ifdef TEARSPLASH_HEADLESS_EGL
+    EGLDisplay display = openDisplay();
+    if (display == EGL_NO_DISPLAY || !eglBindAPI(EGL_OPENGL_API)) {
+        return false;
+    }
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint numConfigs = 0;
+    eglChooseConfig(display, configAttributes, &config, 1, &numConfigs);
+
+    // Surfaceless displays may offer no configs, which is fine if contexts don't need one.
+    const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+    const bool surfaceless = hasExtension(extensions, "EGL_KHR_surfaceless_context");
+    if (numConfigs == 0) {
+        if (!surfaceless || !hasExtension(extensions, "EGL_KHR_no_config_context")) {
+            eglTerminate(display);
+            return false;
+        }
+        config = EGL_NO_CONFIG_KHR;
+    }
+
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT) {
+        eglTerminate(display);
+        return false;
+    }
+
+    // Everything is drawn to the offscreen framebuffer, a pbuffer is only needed to make
+    // the context current where surfaceless contexts aren't supported.
+    EGLSurface surface = EGL_NO_SURFACE;
+    if (!surfaceless) {
+        const EGLint surfaceAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+    }
+    if (!eglMakeCurrent(display, surface, surface, context)) {
+        if (surface != EGL_NO_SURFACE) {
+            eglDestroySurface(display, surface);
+        }
+        eglDestroyContext(display, context);
+        eglTerminate(display);
+        return false;
+    }
+
+    mDisplay = display;
+    mSurface = surface;
+    mContext = context;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void HeadlessContext::initFramebuffer(const int width, const int height) {
+    glGenRenderbuffers(1, &mColorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, mColorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &mDepthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, mDepthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &mFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, mColorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, mDepthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        Tearsplash::fatalError("Headless framebuffer is incomplete");
+    }
+    glViewport(0, 0, width, height);
+}
+
+void HeadlessContext::destroy() {
+#ifdef TEARSPLASH_HEADLESS_EGL
+    if (mContext == nullptr) {
+        return;
+    }
+
+    if (mFramebuffer != 0) {
+        glDeleteFramebuffers(1, &mFramebuffer);
+        glDeleteRenderbuffers(1, &mColorBuffer);
+        glDeleteRenderbuffers(1, &mDepthBuffer);
+        mFramebuffer = 0;
+        mColorBuffer = 0;
+        mDepthBuffer = 0;
+    }
+
+    eglMakeCurrent(mDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (mSurface != nullptr) {
+        eglDestroySurface(mDisplay, mSurface);
+    }
+    eglDestroyContext(mDisplay, mContext);
+    eglTerminate(mDisplay);
+    mDisplay = nullptr;
+    mSurface = nullptr;
+    mContext = nullptr;
+#endif
+}
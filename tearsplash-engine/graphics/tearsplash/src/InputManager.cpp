@@ -8,74 +8,141 @@
 // Author:	Oscar Mrtensson
 // -------------------------------------------
 // Log:	    2019-03-24 File created
+//          2026-10-19 Key state kept in bitsets, edge queries and actions
 /**********************************************************************/
 
 #include "Tearsplash/InputManager.h"
 
+#include <cstring>
+
 using namespace Tearsplash;
 
-InputManager::InputManager() : mMouseCoords(0.0f) {}
+InputManager::InputManager() : mMouseCoords(0.0f)
+{
+    std::memset(&mKeys, 0, sizeof(mKeys));
+    std::memset(&mPrevKeys, 0, sizeof(mPrevKeys));
+}
 
 InputManager::~InputManager() {}
 
 void InputManager::update()
 {
-    for (auto it = mKeyMap.begin(); it != mKeyMap.end(); it++)
-    {
-        // Copies current keyMap to previous
-        mPrevKeyMap[it->first] = it->second;
-    }
+    // A fixed number of words, however many keys have been seen.
+    mPrevKeys = mKeys;
 }
 
 void InputManager::pressKey(const unsigned int keyID)
 {
-    // First checks if keyID exists, if not, creates new entry
-    mKeyMap[keyID] = true;
+    if (keyID < NUM_KEYS)
+    {
+        mKeys.words[keyID / 64] |= uint64_t(1) << (keyID % 64);
+    }
 }
 
 void InputManager::releaseKey(const unsigned int keyID)
 {
-    mKeyMap[keyID] = false;
+    if (keyID < NUM_KEYS)
+    {
+        mKeys.words[keyID / 64] &= ~(uint64_t(1) << (keyID % 64));
+    }
+}
+
+bool InputManager::isKeyDown(const unsigned int keyID) const
+{
+    return testBit(mKeys, keyID);
 }
 
-bool InputManager::isKeyDown(const unsigned int keyID)
+bool InputManager::isKeyPressed(const unsigned int keyID) const
 {
-    auto it = mKeyMap.find(keyID);
-    if (it != mKeyMap.end())
+    if (keyID >= NUM_KEYS)
     {
-        return it->second;
+        return false;
     }
-    else
+
+    // Changed since last frame and down now.
+    const unsigned int word = keyID / 64;
+    const uint64_t changed = mKeys.words[word] ^ mPrevKeys.words[word];
+    return ((changed & mKeys.words[word]) >> (keyID % 64) & 1) != 0;
+}
+
+bool InputManager::isKeyReleased(const unsigned int keyID) const
+{
+    if (keyID >= NUM_KEYS)
     {
         return false;
     }
+
+    // Changed since last frame and down before.
+    const unsigned int word = keyID / 64;
+    const uint64_t changed = mKeys.words[word] ^ mPrevKeys.words[word];
+    return ((changed & mPrevKeys.words[word]) >> (keyID % 64) & 1) != 0;
 }
 
-bool InputManager::wasKeyDown(const unsigned int keyID)
+bool InputManager::isKeyHeld(const unsigned int keyID) const
 {
-    auto it = mPrevKeyMap.find(keyID);
-    if (it != mPrevKeyMap.end())
+    return testBit(mKeys, keyID) && testBit(mPrevKeys, keyID);
+}
+
+void InputManager::bindAction(const unsigned int actionID, const unsigned int keyID)
+{
+    if (actionID >= mActionMasks.size())
     {
-        return it->second;
+        KeyBits empty;
+        std::memset(&empty, 0, sizeof(empty));
+        mActionMasks.resize(actionID + 1, empty);
     }
-    else
+    if (keyID < NUM_KEYS)
     {
-        return false;
+        mActionMasks[actionID].words[keyID / 64] |= uint64_t(1) << (keyID % 64);
     }
 }
 
-bool InputManager::isKeyPressed(const unsigned int keyID)
+void InputManager::unbindAction(const unsigned int actionID)
 {
-    if (isKeyDown(keyID) && wasKeyDown(keyID))
+    if (actionID < mActionMasks.size())
     {
-        // Key is pressed
-        return true;
+        std::memset(&mActionMasks[actionID], 0, sizeof(KeyBits));
     }
-    return false;
+}
+
+bool InputManager::isActionDown(const unsigned int actionID) const
+{
+    return actionID < mActionMasks.size() && testAny(mKeys, mActionMasks[actionID]);
+}
+
+bool InputManager::isActionPressed(const unsigned int actionID) const
+{
+    // Pressing a second key of an action that is already down doesn't press it again.
+    return actionID < mActionMasks.size() && testAny(mKeys, mActionMasks[actionID]) && !testAny(mPrevKeys, mActionMasks[actionID]);
+}
+
+bool InputManager::isActionReleased(const unsigned int actionID) const
+{
+    return actionID < mActionMasks.size() && !testAny(mKeys, mActionMasks[actionID]) && testAny(mPrevKeys, mActionMasks[actionID]);
+}
+
+bool InputManager::isActionHeld(const unsigned int actionID) const
+{
+    return actionID < mActionMasks.size() && testAny(mKeys, mActionMasks[actionID]) && testAny(mPrevKeys, mActionMasks[actionID]);
 }
 
 void InputManager::setMouseCoords(const float x, const float y)
 {
     mMouseCoords.x = x;
     mMouseCoords.y = y;
-}
\ No newline at end of file
+}
+
+bool InputManager::testBit(const KeyBits& bits, const unsigned int keyID)
+{
+    return keyID < NUM_KEYS && ((bits.words[keyID / 64] >> (keyID % 64)) & 1) != 0;
+}
+
+bool InputManager::testAny(const KeyBits& bits, const KeyBits& mask)
+{
+    uint64_t any = 0;
+    for (unsigned int i = 0; i < NUM_WORDS; i++)
+    {
+        any |= bits.words[i] & mask.words[i];
+    }
+    return any != 0;
+}
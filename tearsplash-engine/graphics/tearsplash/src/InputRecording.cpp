@@ -0,0 +1,272 @@
+#include "Tearsplash/InputRecording.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace Tearsplash;
+
+namespace {
+    const char MAGIC[4] = { 'T', 'S', 'I', 'R' };
+    const uint8_t VERSION = 2;
+
+    void writeU32(std::vector<uint8_t>& out, const uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+        }
+    }
+
+    void writeVarint(std::vector<uint8_t>& out, uint32_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    // Zigzag maps small negative numbers to small varints too.
+    void writeSignedVarint(std::vector<uint8_t>& out, const int32_t value) {
+        writeVarint(out, (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+    }
+
+    // Reads from a byte buffer, every read fails once the end has been passed.
+    class Reader {
+    public:
+        explicit Reader(const std::vector<uint8_t>& data) : mData(data), mPosition(0), mFailed(false) {}
+
+        uint8_t readU8() {
+            if (mPosition >= mData.size()) {
+                mFailed = true;
+                return 0;
+            }
+            return mData[mPosition++];
+        }
+
+        uint32_t readU32() {
+            uint32_t value = 0;
+            for (int i = 0; i < 4; i++) {
+                value |= static_cast<uint32_t>(readU8()) << (i * 8);
+            }
+            return value;
+        }
+
+        uint32_t readVarint() {
+            uint32_t value = 0;
+            for (int shift = 0; shift < 35; shift += 7) {
+                const uint8_t byte = readU8();
+                value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return value;
+                }
+            }
+            mFailed = true;
+            return 0;
+        }
+
+        int32_t readSignedVarint() {
+            const uint32_t value = readVarint();
+            return static_cast<int32_t>((value >> 1) ^ (0u - (value & 1)));
+        }
+
+        bool hasFailed() const { return mFailed; }
+
+    private:
+        const std::vector<uint8_t>& mData;
+        size_t mPosition;
+        bool mFailed;
+    };
+
+    bool isMouseEvent(const RecordedInputEvent::Kind kind) {
+        return kind == RecordedInputEvent::Kind::MOUSE_MOTION ||
+            kind == RecordedInputEvent::Kind::MOUSE_BUTTON_DOWN ||
+            kind == RecordedInputEvent::Kind::MOUSE_BUTTON_UP;
+    }
+}
+
+InputRecorder::InputRecorder() : mSeed(0) {
+}
+
+InputRecorder::~InputRecorder() {
+    // Do nothing.
+}
+
+void InputRecorder::begin(const uint32_t seed) {
+    mSeed = seed;
+    mEvents.clear();
+    mFrameSteps.clear();
+}
+
+bool InputRecorder::record(const uint32_t frame, const SDL_Event& event) {
+    RecordedInputEvent recorded = {};
+    recorded.frame = frame;
+
+    switch (event.type) {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        // Key repeats carry no new state.
+        if (event.key.repeat != 0) {
+            return false;
+        }
+        recorded.kind = event.type == SDL_KEYDOWN ? RecordedInputEvent::Kind::KEY_DOWN : RecordedInputEvent::Kind::KEY_UP;
+        recorded.code = static_cast<uint32_t>(event.key.keysym.scancode);
+        break;
+    case SDL_MOUSEMOTION:
+        recorded.kind = RecordedInputEvent::Kind::MOUSE_MOTION;
+        recorded.x = event.motion.x;
+        recorded.y = event.motion.y;
+        break;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+        recorded.kind = event.type == SDL_MOUSEBUTTONDOWN ? RecordedInputEvent::Kind::MOUSE_BUTTON_DOWN : RecordedInputEvent::Kind::MOUSE_BUTTON_UP;
+        recorded.code = event.button.button;
+        recorded.x = event.button.x;
+        recorded.y = event.button.y;
+        break;
+    default:
+        return false;
+    }
+
+    mEvents.push_back(recorded);
+    return true;
+}
+
+void InputRecorder::recordSteps(const int steps) {
+    mFrameSteps.push_back(static_cast<uint8_t>(steps));
+}
+
+bool InputRecorder::save(const std::string& filePath) const {
+    std::vector<uint8_t> data(MAGIC, MAGIC + sizeof(MAGIC));
+    data.push_back(VERSION);
+    writeU32(data, mSeed);
+    writeU32(data, static_cast<uint32_t>(mFrameSteps.size()));
+    writeU32(data, static_cast<uint32_t>(mEvents.size()));
+
+    uint32_t previousFrame = 0;
+    for (const RecordedInputEvent& event : mEvents) {
+        writeVarint(data, event.frame - previousFrame);
+        previousFrame = event.frame;
+        data.push_back(static_cast<uint8_t>(event.kind));
+        writeVarint(data, event.code);
+        if (isMouseEvent(event.kind)) {
+            writeSignedVarint(data, event.x);
+            writeSignedVarint(data, event.y);
+        }
+    }
+
+    // Mostly long runs of one step per frame.
+    std::vector<uint8_t> runs;
+    uint32_t numRuns = 0;
+    for (size_t first = 0; first < mFrameSteps.size();) {
+        size_t end = first + 1;
+        while (end < mFrameSteps.size() && mFrameSteps[end] == mFrameSteps[first]) {
+            end++;
+        }
+        writeVarint(runs, static_cast<uint32_t>(end - first));
+        runs.push_back(mFrameSteps[first]);
+        numRuns++;
+        first = end;
+    }
+    writeU32(data, numRuns);
+    data.insert(data.end(), runs.begin(), runs.end());
+
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    return static_cast<bool>(file);
+}
+
+InputReplay::InputReplay() : mSeed(0), mNumFrames(0), mNextEvent(0) {
+}
+
+InputReplay::~InputReplay() {
+    // Do nothing.
+}
+
+bool InputReplay::load(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    Reader reader(data);
+    bool isInputLog = true;
+    for (const char c : MAGIC) {
+        isInputLog = static_cast<char>(reader.readU8()) == c && isInputLog;
+    }
+    if (!isInputLog || reader.readU8() != VERSION) {
+        return false;
+    }
+
+    mSeed = reader.readU32();
+    mNumFrames = reader.readU32();
+    const uint32_t numEvents = reader.readU32();
+
+    mEvents.clear();
+    mNextEvent = 0;
+    uint32_t frame = 0;
+    for (uint32_t i = 0; i < numEvents && !reader.hasFailed(); i++) {
+        RecordedInputEvent event = {};
+        frame += reader.readVarint();
+        event.frame = frame;
+        const uint8_t kind = reader.readU8();
+        if (kind > static_cast<uint8_t>(RecordedInputEvent::Kind::MOUSE_BUTTON_UP)) {
+            return false;
+        }
+        event.kind = static_cast<RecordedInputEvent::Kind>(kind);
+        event.code = reader.readVarint();
+        if (isMouseEvent(event.kind)) {
+            event.x = reader.readSignedVarint();
+            event.y = reader.readSignedVarint();
+        }
+        mEvents.push_back(event);
+    }
+
+    mFrameSteps.clear();
+    const uint32_t numRuns = reader.readU32();
+    for (uint32_t i = 0; i < numRuns && !reader.hasFailed(); i++) {
+        const uint32_t length = reader.readVarint();
+        const uint8_t steps = reader.readU8();
+        if (length > mNumFrames - mFrameSteps.size()) {
+            return false;
+        }
+        mFrameSteps.insert(mFrameSteps.end(), length, steps);
+    }
+
+    return !reader.hasFailed() && mFrameSteps.size() == mNumFrames;
+}
+
+bool InputReplay::poll(const uint32_t frame, SDL_Event& event) {
+    if (mNextEvent >= mEvents.size() || mEvents[mNextEvent].frame > frame) {
+        return false;
+    }
+
+    const RecordedInputEvent& recorded = mEvents[mNextEvent++];
+    std::memset(&event, 0, sizeof(event));
+    switch (recorded.kind) {
+    case RecordedInputEvent::Kind::KEY_DOWN:
+    case RecordedInputEvent::Kind::KEY_UP:
+        event.type = recorded.kind == RecordedInputEvent::Kind::KEY_DOWN ? SDL_KEYDOWN : SDL_KEYUP;
+        event.key.state = recorded.kind == RecordedInputEvent::Kind::KEY_DOWN ? SDL_PRESSED : SDL_RELEASED;
+        event.key.keysym.scancode = static_cast<SDL_Scancode>(recorded.code);
+        event.key.keysym.sym = SDL_GetKeyFromScancode(event.key.keysym.scancode);
+        break;
+    case RecordedInputEvent::Kind::MOUSE_MOTION:
+        event.type = SDL_MOUSEMOTION;
+        event.motion.x = recorded.x;
+        event.motion.y = recorded.y;
+        break;
+    case RecordedInputEvent::Kind::MOUSE_BUTTON_DOWN:
+    case RecordedInputEvent::Kind::MOUSE_BUTTON_UP:
+        event.type = recorded.kind == RecordedInputEvent::Kind::MOUSE_BUTTON_DOWN ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+        event.button.state = recorded.kind == RecordedInputEvent::Kind::MOUSE_BUTTON_DOWN ? SDL_PRESSED : SDL_RELEASED;
+        event.button.button = static_cast<uint8_t>(recorded.code);
+        event.button.clicks = 1;
+        event.button.x = recorded.x;
+        event.button.y = recorded.y;
+        break;
+    }
+    return true;
+}
@@ -0,0 +1,96 @@
+#include "Tearsplash/JobSystem.h"
+
+#include "Tearsplash/Profiler.h"
+
+using namespace Tearsplash;
+
+JobSystem::JobSystem() :
+    mGeneration(0), mNumActiveWorkers(0), mQuit(false), mJob(nullptr), mJobCount(0), mNextIndex(0) {
+}
+
+JobSystem::~JobSystem() {
+    destroy();
+}
+
+void JobSystem::init(const size_t numWorkers) {
+    destroy();
+
+    mQuit = false;
+    for (size_t i = 0; i < numWorkers; i++) {
+        mWorkers.emplace_back(&JobSystem::workerLoop, this);
+    }
+}
+
+void JobSystem::destroy() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mQuit = true;
+    }
+    mWakeCondition.notify_all();
+
+    for (std::thread& worker : mWorkers) {
+        worker.join();
+    }
+    mWorkers.clear();
+}
+
+void JobSystem::parallelFor(const size_t count, const Job& job) {
+    if (mWorkers.empty() || count <= 1) {
+        for (size_t i = 0; i < count; i++) {
+            job(i);
+        }
+        return;
+    }
+
+    {
+        // A worker that woke up late for the last loop may still be on its way out.
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDoneCondition.wait(lock, [this]() { return mNumActiveWorkers == 0; });
+
+        mJob = &job;
+        mJobCount = count;
+        mNextIndex.store(0);
+        mGeneration++;
+    }
+    mWakeCondition.notify_all();
+
+    runJobs();
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mDoneCondition.wait(lock, [this]() { return mNumActiveWorkers == 0; });
+    mJob = nullptr;
+}
+
+void JobSystem::workerLoop() {
+    uint64_t seenGeneration = 0;
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+        mWakeCondition.wait(lock, [this, seenGeneration]() { return mQuit || mGeneration != seenGeneration; });
+        if (mQuit) {
+            return;
+        }
+
+        seenGeneration = mGeneration;
+        mNumActiveWorkers++;
+        lock.unlock();
+
+        runJobs();
+
+        lock.lock();
+        mNumActiveWorkers--;
+        if (mNumActiveWorkers == 0) {
+            mDoneCondition.notify_all();
+        }
+    }
+}
+
+void JobSystem::runJobs() {
+    TS_PROFILE_SCOPE("JobSystem::runJobs");
+
+    // Every index past the end is a no-op, so late workers never touch the job.
+    size_t index = mNextIndex.fetch_add(1);
+    while (index < mJobCount) {
+        (*mJob)(index);
+        index = mNextIndex.fetch_add(1);
+    }
+}
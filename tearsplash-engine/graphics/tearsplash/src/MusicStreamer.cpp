@@ -0,0 +1,197 @@
+#include "Tearsplash/MusicStreamer.h"
+
+#include "Tearsplash/Errors.h"
+#include "Tearsplash/Profiler.h"
+
+using namespace Tearsplash;
+
+MusicStreamer::MusicStreamer() :
+    mCurrent(nullptr), mNext(nullptr), mNextLoops(-1), mFadeMs(0),
+    mLatestRequest(0), mLoading(false), mQuit(false) {
+}
+
+MusicStreamer::~MusicStreamer() {
+    destroy();
+}
+
+void MusicStreamer::init() {
+    destroy();
+
+    mQuit = false;
+    mLoader = std::thread(&MusicStreamer::loaderLoop, this);
+}
+
+void MusicStreamer::destroy() {
+    if (!mLoader.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mQuit = true;
+        mRequests.clear();
+    }
+    mCondition.notify_one();
+    mLoader.join();
+
+    Mix_HaltMusic();
+    for (LoadResult& result : mResults) {
+        if (result.music != nullptr) {
+            Mix_FreeMusic(result.music);
+        }
+    }
+    mResults.clear();
+
+    if (mCurrent != nullptr) {
+        mFadingOut.push_back(mCurrent);
+    }
+    if (mNext != nullptr) {
+        mFadingOut.push_back(mNext);
+    }
+    for (Mix_Music* music : mFadingOut) {
+        Mix_FreeMusic(music);
+    }
+    mFadingOut.clear();
+    mCurrent = nullptr;
+    mNext = nullptr;
+    mCurrentPath.clear();
+    mNextPath.clear();
+    mLoading = false;
+}
+
+void MusicStreamer::play(const std::string& filePath, const int loops, const int fadeMs) {
+    // Replaying the current track restarts it once it was halted.
+    if (filePath == mCurrentPath && mNext == nullptr && !mLoading && Mix_PlayingMusic() != 0) {
+        return;
+    }
+
+    if (mNext != nullptr) {
+        Mix_FreeMusic(mNext);
+        mNext = nullptr;
+        mNextPath.clear();
+    }
+
+    mNextLoops = loops;
+    mFadeMs = fadeMs;
+    mLatestRequest++;
+    mLoading = true;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mRequests.push_back({ mLatestRequest, filePath });
+    }
+    mCondition.notify_one();
+}
+
+void MusicStreamer::stop(const int fadeMs) {
+    // Whatever is still loading is freed when it arrives.
+    mLatestRequest++;
+    mLoading = false;
+    if (mNext != nullptr) {
+        Mix_FreeMusic(mNext);
+        mNext = nullptr;
+        mNextPath.clear();
+    }
+
+    if (Mix_PlayingMusic() != 0 && Mix_FadingMusic() != MIX_FADING_OUT) {
+        Mix_FadeOutMusic(fadeMs);
+    }
+    if (mCurrent != nullptr) {
+        mFadingOut.push_back(mCurrent);
+        mCurrent = nullptr;
+        mCurrentPath.clear();
+    }
+}
+
+void MusicStreamer::update() {
+    TS_PROFILE_SCOPE("MusicStreamer::update");
+
+    std::vector<LoadResult> results;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        results.swap(mResults);
+    }
+
+    for (LoadResult& result : results) {
+        if (result.id != mLatestRequest) {
+            if (result.music != nullptr) {
+                Mix_FreeMusic(result.music);
+            }
+            continue;
+        }
+
+        mLoading = false;
+        if (result.music == nullptr) {
+            fatalError("Mix_LoadMUS failed to load music at " + result.filePath + " " + result.error);
+        }
+        mNext = result.music;
+        mNextPath = result.filePath;
+    }
+
+    if (mNext != nullptr) {
+        if (Mix_PlayingMusic() != 0) {
+            // SDL_mixer plays one track at a time, so the old one fades out first.
+            if (Mix_FadingMusic() != MIX_FADING_OUT) {
+                Mix_FadeOutMusic(mFadeMs);
+            }
+            if (mCurrent != nullptr) {
+                mFadingOut.push_back(mCurrent);
+                mCurrent = nullptr;
+                mCurrentPath.clear();
+            }
+        }
+        else {
+            freeStoppedTracks();
+            if (Mix_FadeInMusic(mNext, mNextLoops, mFadeMs) == -1) {
+                fatalError("Mix_FadeInMusic error playing " + mNextPath + ". Mixer error: " + Mix_GetError());
+            }
+            mCurrent = mNext;
+            mCurrentPath = mNextPath;
+            mNext = nullptr;
+            mNextPath.clear();
+        }
+    }
+
+    freeStoppedTracks();
+}
+
+void MusicStreamer::loaderLoop() {
+    while (true) {
+        LoadRequest request;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this]() { return mQuit || !mRequests.empty(); });
+            if (mQuit) {
+                return;
+            }
+            request = std::move(mRequests.front());
+            mRequests.pop_front();
+        }
+
+        // Opening an MP3 scans the file, which is what used to stall the game thread.
+        LoadResult result = { request.id, request.filePath, Mix_LoadMUS(request.filePath.c_str()), std::string() };
+        if (result.music == nullptr) {
+            result.error = Mix_GetError();
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mResults.push_back(std::move(result));
+    }
+}
+
+void MusicStreamer::freeStoppedTracks() {
+    if (Mix_PlayingMusic() != 0) {
+        return;
+    }
+
+    for (Mix_Music* music : mFadingOut) {
+        Mix_FreeMusic(music);
+    }
+    mFadingOut.clear();
+
+    // The current track ran out of loops.
+    if (mCurrent != nullptr) {
+        Mix_FreeMusic(mCurrent);
+        mCurrent = nullptr;
+        mCurrentPath.clear();
+    }
+}
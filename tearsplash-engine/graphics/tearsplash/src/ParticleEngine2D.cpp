@@ -1,4 +1,5 @@
 #include "Tearsplash/ParticleEngine2D.h"
+#include "Tearsplash/Profiler.h"
 
 using namespace Tearsplash;
 
@@ -15,13 +16,24 @@ void ParticleEngine2D::addParticleBatch(ParticleBatch2D& pb, Spritebatch& sb) {
     mBatches.push_back(std::pair<ParticleBatch2D&, Spritebatch&>(pb, sb));
 }
 
+void ParticleEngine2D::addParticleBatch(GPUParticleBatch2D& pb) {
+    mGPUBatches.push_back(&pb);
+}
+
 void ParticleEngine2D::updateBatches(const float deltaTime) {
+    TS_PROFILE_SCOPE("ParticleEngine2D::updateBatches");
+
     for (auto& batch : mBatches) {
         batch.first.update(deltaTime);
     }
+    for (auto batch : mGPUBatches) {
+        batch->update(deltaTime);
+    }
 }
 
-void ParticleEngine2D::drawBatches() const {
+void ParticleEngine2D::drawBatches(const glm::mat4& cameraMatrix) const {
+    TS_PROFILE_SCOPE("ParticleEngine2D::drawBatches");
+
     for (auto& batch : mBatches) {
         // Draw the ParitcleBatch2D with the Spritebatch it was assigned.
         batch.second.begin(Tearsplash::GlyphSortType::TEXTURE);
@@ -29,4 +41,7 @@ void ParticleEngine2D::drawBatches() const {
         batch.second.end();
         batch.second.renderBatch();
     }
+    for (auto batch : mGPUBatches) {
+        batch->draw(cameraMatrix);
+    }
 }
\ No newline at end of file
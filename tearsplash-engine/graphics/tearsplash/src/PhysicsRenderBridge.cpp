@@ -0,0 +1,62 @@
+#include "Tearsplash/PhysicsRenderBridge.h"
+
+#include <box2d/box2d.h>
+
+#include "Tearsplash/Profiler.h"
+
+using namespace Tearsplash;
+
+PhysicsRenderBridge::PhysicsRenderBridge() {
+}
+
+PhysicsRenderBridge::~PhysicsRenderBridge() {
+    // Do nothing.
+}
+
+uint32_t PhysicsRenderBridge::add(b2Body* body) {
+    const b2Vec2& position = body->GetPosition();
+    const glm::vec2 glmPosition(position.x, position.y);
+    const float angle = body->GetAngle();
+
+    mBodies.push_back(body);
+    mTransforms.push_back({ glmPosition, glmPosition, angle, angle });
+    mSettled.push_back(0);
+    return static_cast<uint32_t>(mBodies.size() - 1);
+}
+
+void PhysicsRenderBridge::clear() {
+    mBodies.clear();
+    mTransforms.clear();
+    mSettled.clear();
+    mMovedSlots.clear();
+}
+
+void PhysicsRenderBridge::sync() {
+    TS_PROFILE_SCOPE("PhysicsRenderBridge::sync");
+
+    mMovedSlots.clear();
+    for (size_t i = 0; i < mBodies.size(); i++) {
+        // Box2D 2.4 keeps no list of awake bodies, the flag is the cheapest thing to read.
+        const b2Body* body = mBodies[i];
+        const bool awake = body->IsAwake();
+        if (!awake && mSettled[i]) {
+            continue;
+        }
+
+        PhysicsTransform& transform = mTransforms[i];
+        const b2Vec2& position = body->GetPosition();
+        transform.prevPosition = transform.position;
+        transform.prevAngle = transform.angle;
+        transform.position = glm::vec2(position.x, position.y);
+        transform.angle = body->GetAngle();
+
+        // A body falls asleep at the end of a step, after its last move. Draw it
+        // at rest from then on instead of between its last two states.
+        if (!awake) {
+            transform.prevPosition = transform.position;
+            transform.prevAngle = transform.angle;
+        }
+        mSettled[i] = awake ? 0 : 1;
+        mMovedSlots.push_back(static_cast<uint32_t>(i));
+    }
+}
@@ -0,0 +1,408 @@
+#include "Tearsplash/PhysicsService.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Tearsplash/Profiler.h"
+
+using namespace Tearsplash;
+
+namespace {
+    const uint32_t NO_HANDLE = UINT32_MAX;
+}
+
+void PhysicsService::CommandBuffer::clear() {
+    commands.clear();
+    handles.clear();
+    positions.clear();
+    dimensions.clear();
+    destroyedHandles.clear();
+}
+
+PhysicsService::PhysicsService() :
+    mNumMigrations(0), mTimeStep(0.0f), mSimNumMigrations(0), mHasResults(false), mStepInFlight(false), mQuit(false) {
+}
+
+PhysicsService::~PhysicsService() {
+    destroy();
+}
+
+void PhysicsService::init(const PhysicsServiceConfig& config) {
+    destroy();
+
+    mConfig = config;
+    mConfig.numShards = std::max(mConfig.numShards, 1);
+    for (int i = 0; i < mConfig.numShards; i++) {
+        mShards.push_back(std::make_unique<Shard>());
+        Shard& shard = *mShards.back();
+        shard.world = std::make_unique<b2World>(mConfig.gravity);
+        shard.boxes.init(shard.world.get());
+    }
+
+    if (mConfig.threaded) {
+        // The stepping thread takes a shard itself, the workers take the rest.
+        const size_t numCores = std::max(std::thread::hardware_concurrency(), 2u);
+        mJobs.init(std::min(static_cast<size_t>(mConfig.numShards - 1), numCores - 2));
+
+        mQuit = false;
+        mThread = std::thread(&PhysicsService::threadLoop, this);
+    }
+}
+
+void PhysicsService::destroy() {
+    if (mThread.joinable()) {
+        waitForStep();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mQuit = true;
+        }
+        mCondition.notify_all();
+        mThread.join();
+    }
+    mJobs.destroy();
+
+    mShards.clear();
+    mPendingCommands.clear();
+    mSubmittedCommands.clear();
+    mTransforms.clear();
+    mDimensions.clear();
+    mMovedHandles.clear();
+    mFreeHandles.clear();
+    mBodies.clear();
+    mSimTransforms.clear();
+    mSimMovedHandles.clear();
+    mNumMigrations = 0;
+    mSimNumMigrations = 0;
+    mHasResults = false;
+}
+
+void PhysicsService::addStaticBox(const glm::vec2& position, const glm::vec2& dimensions) {
+    Command command = {};
+    command.type = CommandType::ADD_STATIC_BOXES;
+    command.count = 1;
+    command.dataIndex = static_cast<uint32_t>(mPendingCommands.positions.size());
+    mPendingCommands.commands.push_back(command);
+    mPendingCommands.handles.push_back(NO_HANDLE);
+    mPendingCommands.positions.push_back(position);
+    mPendingCommands.dimensions.push_back(dimensions);
+}
+
+void PhysicsService::spawnBoxes(const glm::vec2* positions,
+    const glm::vec2* dimensions,
+    const size_t count,
+    const b2BodyType type,
+    uint32_t* outHandles) {
+    Command command = {};
+    command.type = CommandType::SPAWN_BOXES;
+    command.count = static_cast<uint32_t>(count);
+    command.dataIndex = static_cast<uint32_t>(mPendingCommands.positions.size());
+    command.bodyType = type;
+    mPendingCommands.commands.push_back(command);
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t handle;
+        if (!mFreeHandles.empty()) {
+            handle = mFreeHandles.back();
+            mFreeHandles.pop_back();
+        }
+        else {
+            handle = static_cast<uint32_t>(mTransforms.size());
+            mTransforms.emplace_back();
+            mDimensions.emplace_back();
+        }
+
+        mTransforms[handle] = { positions[i], positions[i], 0.0f, 0.0f };
+        mDimensions[handle] = dimensions[i];
+        mPendingCommands.handles.push_back(handle);
+        mPendingCommands.positions.push_back(positions[i]);
+        mPendingCommands.dimensions.push_back(dimensions[i]);
+        outHandles[i] = handle;
+    }
+}
+
+void PhysicsService::destroyBox(const uint32_t handle) {
+    Command command = {};
+    command.type = CommandType::DESTROY_BOX;
+    command.handle = handle;
+    mPendingCommands.commands.push_back(command);
+    mPendingCommands.destroyedHandles.push_back(handle);
+}
+
+void PhysicsService::applyLinearImpulse(const uint32_t handle, const glm::vec2& impulse, const glm::vec2& point) {
+    Command command = {};
+    command.type = CommandType::APPLY_LINEAR_IMPULSE;
+    command.handle = handle;
+    command.impulse = impulse;
+    command.point = point;
+    mPendingCommands.commands.push_back(command);
+}
+
+void PhysicsService::applyLinearImpulseToCenter(const uint32_t handle, const glm::vec2& impulse) {
+    Command command = {};
+    command.type = CommandType::APPLY_LINEAR_IMPULSE_TO_CENTER;
+    command.handle = handle;
+    command.impulse = impulse;
+    mPendingCommands.commands.push_back(command);
+}
+
+void PhysicsService::step(const float timeStep) {
+    TS_PROFILE_SCOPE("PhysicsService::step");
+
+    waitForStep();
+    publish();
+
+    // The stepping thread is idle, hand it everything queued since the last step.
+    std::swap(mPendingCommands, mSubmittedCommands);
+    mPendingCommands.clear();
+    mTimeStep = timeStep;
+
+    if (mConfig.threaded) {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStepInFlight = true;
+        }
+        mCondition.notify_all();
+    }
+    else {
+        runStep();
+        publish();
+    }
+}
+
+void PhysicsService::finish() {
+    waitForStep();
+    publish();
+}
+
+void PhysicsService::threadLoop() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+        mCondition.wait(lock, [this]() { return mQuit || mStepInFlight; });
+        if (mQuit) {
+            return;
+        }
+
+        lock.unlock();
+        runStep();
+        lock.lock();
+
+        mStepInFlight = false;
+        mCondition.notify_all();
+    }
+}
+
+void PhysicsService::waitForStep() {
+    if (!mConfig.threaded) {
+        return;
+    }
+
+    TS_PROFILE_SCOPE("PhysicsService::waitForStep");
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [this]() { return !mStepInFlight; });
+}
+
+void PhysicsService::publish() {
+    if (!mHasResults) {
+        return;
+    }
+
+    // Handles spawned since the step started aren't in its moved list, they keep their spawn transform.
+    for (const uint32_t handle : mSimMovedHandles) {
+        mTransforms[handle] = mSimTransforms[handle];
+    }
+    mMovedHandles = mSimMovedHandles;
+    mNumMigrations = mSimNumMigrations;
+
+    // The published transforms no longer mention these, so they can be handed out again.
+    mFreeHandles.insert(mFreeHandles.end(), mSubmittedCommands.destroyedHandles.begin(), mSubmittedCommands.destroyedHandles.end());
+    mSubmittedCommands.destroyedHandles.clear();
+
+    mHasResults = false;
+}
+
+void PhysicsService::runStep() {
+    TS_PROFILE_SCOPE("PhysicsService::runStep");
+
+    applyCommands();
+
+    // Shards share nothing, so they can be stepped at the same time.
+    mJobs.parallelFor(mShards.size(), [this](const size_t index) {
+        TS_PROFILE_SCOPE("PhysicsService::stepShard");
+        mShards[index]->world->Step(mTimeStep, mConfig.velocityIterations, mConfig.positionIterations);
+    });
+
+    migrateAndSync();
+    mHasResults = true;
+}
+
+void PhysicsService::applyCommands() {
+    TS_PROFILE_SCOPE("PhysicsService::applyCommands");
+
+    const CommandBuffer& buffer = mSubmittedCommands;
+    for (const Command& command : buffer.commands) {
+        switch (command.type) {
+        case CommandType::ADD_STATIC_BOXES:
+            for (std::unique_ptr<Shard>& shard : mShards) {
+                for (uint32_t i = command.dataIndex; i < command.dataIndex + command.count; i++) {
+                    shard->staticBoxes.emplace_back();
+                    shard->staticBoxes.back().init(shard->world.get(), buffer.positions[i], buffer.dimensions[i]);
+                }
+            }
+            break;
+        case CommandType::SPAWN_BOXES:
+            spawnBodies(command);
+            break;
+        case CommandType::DESTROY_BOX: {
+            BodyRecord& record = mBodies[command.handle];
+            if (record.alive) {
+                mShards[record.shard]->boxes.destroy(record.poolHandle);
+                record.alive = 0;
+            }
+            break;
+        }
+        case CommandType::APPLY_LINEAR_IMPULSE: {
+            const BodyRecord& record = mBodies[command.handle];
+            if (record.alive) {
+                b2Body* body = mShards[record.shard]->boxes.getBox(record.poolHandle).getBody();
+                body->ApplyLinearImpulse(b2Vec2(command.impulse.x, command.impulse.y), b2Vec2(command.point.x, command.point.y), true);
+            }
+            break;
+        }
+        case CommandType::APPLY_LINEAR_IMPULSE_TO_CENTER: {
+            const BodyRecord& record = mBodies[command.handle];
+            if (record.alive) {
+                b2Body* body = mShards[record.shard]->boxes.getBox(record.poolHandle).getBody();
+                body->ApplyLinearImpulseToCenter(b2Vec2(command.impulse.x, command.impulse.y), true);
+            }
+            break;
+        }
+        }
+    }
+}
+
+void PhysicsService::spawnBodies(const Command& command) {
+    const CommandBuffer& buffer = mSubmittedCommands;
+    const uint32_t begin = command.dataIndex;
+    const uint32_t end = command.dataIndex + command.count;
+
+    uint32_t maxHandle = 0;
+    for (uint32_t i = begin; i < end; i++) {
+        maxHandle = std::max(maxHandle, buffer.handles[i]);
+    }
+    if (maxHandle >= mBodies.size()) {
+        mBodies.resize(maxHandle + 1);
+        mSimTransforms.resize(maxHandle + 1);
+    }
+
+    // One pool spawn per shard the batch touches.
+    for (int shardIndex = 0; shardIndex < static_cast<int>(mShards.size()); shardIndex++) {
+        mBatchPositions.clear();
+        mBatchDimensions.clear();
+        mBatchHandles.clear();
+        for (uint32_t i = begin; i < end; i++) {
+            if (findShard(buffer.positions[i].x) == shardIndex) {
+                mBatchPositions.push_back(buffer.positions[i]);
+                mBatchDimensions.push_back(buffer.dimensions[i]);
+                mBatchHandles.push_back(buffer.handles[i]);
+            }
+        }
+        if (mBatchHandles.empty()) {
+            continue;
+        }
+
+        mBatchPoolHandles.resize(mBatchHandles.size());
+        mShards[shardIndex]->boxes.spawn(mBatchPositions.data(), mBatchDimensions.data(), mBatchHandles.size(), command.bodyType, mBatchPoolHandles.data());
+
+        for (size_t i = 0; i < mBatchHandles.size(); i++) {
+            const uint32_t handle = mBatchHandles[i];
+            mBodies[handle] = { shardIndex, mBatchPoolHandles[i], 1, 0 };
+            mSimTransforms[handle] = { mBatchPositions[i], mBatchPositions[i], 0.0f, 0.0f };
+        }
+    }
+}
+
+void PhysicsService::migrateAndSync() {
+    TS_PROFILE_SCOPE("PhysicsService::migrateAndSync");
+
+    const float margin = mConfig.migrationMargin;
+    mSimMovedHandles.clear();
+    for (size_t handle = 0; handle < mBodies.size(); handle++) {
+        BodyRecord& record = mBodies[handle];
+        if (!record.alive) {
+            continue;
+        }
+
+        b2Body* body = mShards[record.shard]->boxes.getBox(record.poolHandle).getBody();
+        const bool awake = body->IsAwake();
+        if (!awake && record.settled) {
+            continue;
+        }
+
+        // Only moving bodies can leave their strip.
+        if (awake && mShards.size() > 1) {
+            const float x = body->GetPosition().x;
+            const int targetShard = findShard(x);
+            if (targetShard > record.shard) {
+                const float boundary = mConfig.shardOriginX + (record.shard + 1) * mConfig.shardWidth;
+                if (x > boundary + margin) {
+                    body = migrateBody(record, body, targetShard);
+                }
+            }
+            else if (targetShard < record.shard) {
+                const float boundary = mConfig.shardOriginX + record.shard * mConfig.shardWidth;
+                if (x < boundary - margin) {
+                    body = migrateBody(record, body, targetShard);
+                }
+            }
+        }
+
+        // Same bookkeeping as PhysicsRenderBridge::sync.
+        PhysicsTransform& transform = mSimTransforms[handle];
+        const b2Vec2& position = body->GetPosition();
+        transform.prevPosition = transform.position;
+        transform.prevAngle = transform.angle;
+        transform.position = glm::vec2(position.x, position.y);
+        transform.angle = body->GetAngle();
+
+        if (!awake) {
+            transform.prevPosition = transform.position;
+            transform.prevAngle = transform.angle;
+        }
+        record.settled = awake ? 0 : 1;
+        mSimMovedHandles.push_back(static_cast<uint32_t>(handle));
+    }
+}
+
+b2Body* PhysicsService::migrateBody(BodyRecord& record, b2Body* body, const int targetShard) {
+    TS_PROFILE_SCOPE("PhysicsService::migrateBody");
+
+    // Contacts don't carry over, the body is recreated with its position and velocities.
+    const b2Vec2 position = body->GetPosition();
+    const float angle = body->GetAngle();
+    const b2Vec2 linearVelocity = body->GetLinearVelocity();
+    const float angularVelocity = body->GetAngularVelocity();
+    const b2BodyType type = body->GetType();
+    const glm::vec2 glmPosition(position.x, position.y);
+    const glm::vec2 dimensions = mShards[record.shard]->boxes.getBox(record.poolHandle).getDimensions();
+
+    mShards[record.shard]->boxes.destroy(record.poolHandle);
+
+    uint32_t poolHandle;
+    BoxPool& targetBoxes = mShards[targetShard]->boxes;
+    targetBoxes.spawn(&glmPosition, &dimensions, 1, type, &poolHandle);
+    b2Body* migrated = targetBoxes.getBox(poolHandle).getBody();
+    migrated->SetTransform(position, angle);
+    migrated->SetLinearVelocity(linearVelocity);
+    migrated->SetAngularVelocity(angularVelocity);
+
+    record.shard = targetShard;
+    record.poolHandle = poolHandle;
+    mSimNumMigrations++;
+    return migrated;
+}
+
+int PhysicsService::findShard(const float x) const {
+    const float strip = std::floor((x - mConfig.shardOriginX) / mConfig.shardWidth);
+    const float lastShard = static_cast<float>(mShards.size() - 1);
+    return static_cast<int>(std::min(std::max(strip, 0.0f), lastShard));
+}
@@ -0,0 +1,266 @@
+#include "Tearsplash/Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+#include <imgui/imgui.h>
+
+using namespace Tearsplash;
+
+namespace {
+    // Every thread buffer ever created. Buffers outlive their threads so their
+    // events can still be exported, and are handed to the next new thread once
+    // their thread exits. There are never more buffers than threads alive at once.
+    std::mutex gBuffersMutex;
+    std::vector<std::unique_ptr<ProfileThreadBuffer>> gBuffers;
+    std::vector<ProfileThreadBuffer*> gFreeBuffers;
+
+    // Bounds of the last finished frame and start of the current one.
+    std::atomic<int64_t> gLastFrameStartNs(0);
+    std::atomic<int64_t> gLastFrameEndNs(0);
+    std::atomic<int64_t> gFrameStartNs(0);
+
+    // Returns the buffer of the calling thread to the free list when the thread exits.
+    struct ThreadBufferOwner {
+        ProfileThreadBuffer* buffer = nullptr;
+
+        ~ThreadBufferOwner() {
+            if (buffer != nullptr) {
+                std::lock_guard<std::mutex> lock(gBuffersMutex);
+                gFreeBuffers.push_back(buffer);
+            }
+        }
+    };
+
+    thread_local ThreadBufferOwner tThreadBuffer;
+
+    void writeEscaped(std::ofstream& file, const char* text) {
+        for (const char* c = text; *c != '\0'; c++) {
+            if (*c == '"' || *c == '\\') {
+                file << '\\';
+            }
+            file << *c;
+        }
+    }
+
+    std::vector<ProfileThreadBuffer*> snapshotBuffers() {
+        std::lock_guard<std::mutex> lock(gBuffersMutex);
+        std::vector<ProfileThreadBuffer*> buffers;
+        for (auto& buffer : gBuffers) {
+            buffers.push_back(buffer.get());
+        }
+        return buffers;
+    }
+}
+
+ProfileThreadBuffer::ProfileThreadBuffer(const uint32_t threadIndex) :
+    depth(0), mThreadIndex(threadIndex), mSlots(CAPACITY), mWriteIndex(0) {
+}
+
+void ProfileThreadBuffer::push(const ProfileEvent& event) {
+    const uint64_t writeIndex = mWriteIndex.load(std::memory_order_relaxed);
+    Slot& slot = mSlots[writeIndex % CAPACITY];
+
+    // Readers that see any of the new fields also see the slot marked as being written.
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(event.name, std::memory_order_relaxed);
+    slot.startNs.store(event.startNs, std::memory_order_relaxed);
+    slot.endNs.store(event.endNs, std::memory_order_relaxed);
+    slot.depth.store(event.depth, std::memory_order_relaxed);
+
+    // Publish the event to readers.
+    slot.sequence.store(writeIndex + 1, std::memory_order_release);
+    mWriteIndex.store(writeIndex + 1, std::memory_order_release);
+}
+
+void ProfileThreadBuffer::collect(const int64_t fromNs, const int64_t toNs, std::vector<ProfileEvent>& out) const {
+    const uint64_t writeIndex = mWriteIndex.load(std::memory_order_acquire);
+    const uint64_t first = writeIndex > CAPACITY ? writeIndex - CAPACITY : 0;
+
+    for (uint64_t i = first; i < writeIndex; i++) {
+        const Slot& slot = mSlots[i % CAPACITY];
+
+        // The writer may have lapped us and be reusing the slot, skip it unless it
+        // still holds event i from before the copy until after it.
+        const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != i + 1) {
+            continue;
+        }
+        const ProfileEvent event = {
+            slot.name.load(std::memory_order_relaxed),
+            slot.startNs.load(std::memory_order_relaxed),
+            slot.endNs.load(std::memory_order_relaxed),
+            slot.depth.load(std::memory_order_relaxed)
+        };
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+            continue;
+        }
+
+        if (event.endNs >= fromNs && event.startNs <= toNs) {
+            out.push_back(event);
+        }
+    }
+}
+
+int64_t Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::newFrame() {
+    const int64_t frameStartNs = now();
+    const int64_t previousStartNs = gFrameStartNs.exchange(frameStartNs);
+    if (previousStartNs != 0) {
+        gLastFrameStartNs.store(previousStartNs);
+        gLastFrameEndNs.store(frameStartNs);
+    }
+}
+
+ProfileThreadBuffer& Profiler::getThreadBuffer() {
+    if (tThreadBuffer.buffer == nullptr) {
+        std::lock_guard<std::mutex> lock(gBuffersMutex);
+        if (gFreeBuffers.empty()) {
+            gBuffers.push_back(std::make_unique<ProfileThreadBuffer>(static_cast<uint32_t>(gBuffers.size())));
+            tThreadBuffer.buffer = gBuffers.back().get();
+        }
+        else {
+            // The new thread takes over the lane of an exited one, the older events stay
+            // until they are overwritten.
+            tThreadBuffer.buffer = gFreeBuffers.back();
+            gFreeBuffers.pop_back();
+            tThreadBuffer.buffer->depth = 0;
+        }
+    }
+    return *tThreadBuffer.buffer;
+}
+
+bool Profiler::writeChromeTrace(const std::string& filePath) {
+    std::ofstream file(filePath);
+    if (!file) {
+        return false;
+    }
+
+    file << "{\"traceEvents\":[\n";
+    bool first = true;
+    std::vector<ProfileEvent> events;
+    for (ProfileThreadBuffer* buffer : snapshotBuffers()) {
+        events.clear();
+        buffer->collect(INT64_MIN, INT64_MAX, events);
+
+        for (const ProfileEvent& event : events) {
+            if (!first) {
+                file << ",\n";
+            }
+            first = false;
+
+            // Complete events ("X") with timestamps in microseconds.
+            char times[96];
+            std::snprintf(times, sizeof(times), "\"ts\":%.3f,\"dur\":%.3f",
+                event.startNs * 0.001, (event.endNs - event.startNs) * 0.001);
+            file << "{\"name\":\"";
+            writeEscaped(file, event.name);
+            file << "\",\"cat\":\"cpu\",\"ph\":\"X\"," << times << ",\"pid\":0,\"tid\":" << buffer->getThreadIndex() << "}";
+        }
+    }
+    file << "\n]}\n";
+
+    return static_cast<bool>(file);
+}
+
+void Profiler::drawImGuiFlameGraph() {
+    // Bottom left by default, clear of windows placed at ImGui's default position.
+    ImGui::SetNextWindowPos(ImVec2(10.0f, ImGui::GetIO().DisplaySize.y - 210.0f), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(600.0f, 200.0f), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Profiler")) {
+        ImGui::End();
+        return;
+    }
+
+#if TEARSPLASH_PROFILE
+    static bool paused = false;
+    static int64_t frameStartNs = 0;
+    static int64_t frameEndNs = 0;
+    static std::vector<std::pair<uint32_t, ProfileEvent>> frameEvents;
+
+    ImGui::Checkbox("Pause", &paused);
+    ImGui::SameLine();
+    if (ImGui::Button("Save trace")) {
+        writeChromeTrace("profile.json");
+    }
+
+    if (!paused) {
+        frameStartNs = gLastFrameStartNs.load();
+        frameEndNs = gLastFrameEndNs.load();
+        frameEvents.clear();
+        std::vector<ProfileEvent> events;
+        for (ProfileThreadBuffer* buffer : snapshotBuffers()) {
+            events.clear();
+            buffer->collect(frameStartNs, frameEndNs, events);
+            for (const ProfileEvent& event : events) {
+                frameEvents.emplace_back(buffer->getThreadIndex(), event);
+            }
+        }
+    }
+
+    const float frameMs = static_cast<float>(frameEndNs - frameStartNs) * 1e-6f;
+    ImGui::SameLine();
+    ImGui::Text("Frame %.2f ms", frameMs);
+
+    if (frameEndNs > frameStartNs) {
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        const float width = ImGui::GetContentRegionAvail().x;
+        const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+        const float laneHeight = rowHeight * 8.0f;
+        const double nsToPixels = width / static_cast<double>(frameEndNs - frameStartNs);
+        const ImVec2 mouse = ImGui::GetIO().MousePos;
+
+        uint32_t numLanes = 0;
+        for (const auto& threadEvent : frameEvents) {
+            const uint32_t lane = threadEvent.first;
+            const ProfileEvent& event = threadEvent.second;
+            numLanes = std::max(numLanes, lane + 1);
+
+            // Clamp to the frame, events may straddle its bounds.
+            const float x0 = origin.x + static_cast<float>((std::max(event.startNs, frameStartNs) - frameStartNs) * nsToPixels);
+            const float x1 = origin.x + static_cast<float>((std::min(event.endNs, frameEndNs) - frameStartNs) * nsToPixels);
+            const float y0 = origin.y + lane * laneHeight + event.depth * rowHeight;
+            const ImVec2 min(x0, y0);
+            const ImVec2 max(std::max(x1, x0 + 1.0f), y0 + rowHeight - 1.0f);
+
+            // Color by name so a zone keeps its color between frames.
+            const ImU32 hash = static_cast<ImU32>(reinterpret_cast<uintptr_t>(event.name) * 2654435761u);
+            drawList->AddRectFilled(min, max, IM_COL32(64 + (hash & 0x7F), 64 + ((hash >> 8) & 0x7F), 64 + ((hash >> 16) & 0x7F), 255));
+            drawList->PushClipRect(min, max, true);
+            drawList->AddText(ImVec2(x0 + 2.0f, y0), IM_COL32_WHITE, event.name);
+            drawList->PopClipRect();
+
+            if (mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y) {
+                ImGui::SetTooltip("%s\n%.3f ms", event.name, (event.endNs - event.startNs) * 1e-6);
+            }
+        }
+
+        ImGui::Dummy(ImVec2(width, numLanes * laneHeight));
+    }
+#else
+    ImGui::Text("Profiling is compiled out. Build with TEARSPLASH_PROFILE=1 to enable it.");
+#endif
+
+    ImGui::End();
+}
+
+ProfileScope::ProfileScope(const char* name) :
+    mBuffer(Profiler::getThreadBuffer()), mName(name), mStartNs(Profiler::now()) {
+    mBuffer.depth++;
+}
+
+ProfileScope::~ProfileScope() {
+    mBuffer.depth--;
+    mBuffer.push({ mName, mStartNs, Profiler::now(), mBuffer.depth });
+}
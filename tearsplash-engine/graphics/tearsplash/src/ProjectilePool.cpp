@@ -0,0 +1,152 @@
+#include "Tearsplash/ProjectilePool.h"
+
+#include "Tearsplash/Profiler.h"
+
+using namespace Tearsplash;
+
+ProjectilePool::ProjectilePool() : mMaxProjectiles(0), mSize(0.0f) {
+}
+
+ProjectilePool::~ProjectilePool() {
+    // Do nothing.
+}
+
+void ProjectilePool::init(const size_t maxProjectiles, const glm::vec2& size, const GLTexture& texture, const ColorRGBA8& color) {
+    mMaxProjectiles = maxProjectiles;
+    mSize = size;
+    mTexture = texture;
+    mColor = color;
+
+    // Reserve everything up front so spawning never reallocates.
+    mPositions.reserve(maxProjectiles);
+    mPrevPositions.reserve(maxProjectiles);
+    mVelocities.reserve(maxProjectiles);
+    mLifeTimes.reserve(maxProjectiles);
+    mBounds.reserve(maxProjectiles);
+    mCullMask.reserve(cullMaskWords(maxProjectiles));
+    mDestRects.reserve(maxProjectiles);
+    clear();
+}
+
+bool ProjectilePool::spawn(const glm::vec2& position, const glm::vec2& velocity, const float lifeTime) {
+    if (mPositions.size() >= mMaxProjectiles) {
+        return false;
+    }
+
+    mPositions.push_back(position);
+    mPrevPositions.push_back(position);
+    mVelocities.push_back(velocity);
+    mLifeTimes.push_back(lifeTime);
+    mBounds.push_back({ position, position + mSize });
+    return true;
+}
+
+void ProjectilePool::clear() {
+    mPositions.clear();
+    mPrevPositions.clear();
+    mVelocities.clear();
+    mLifeTimes.clear();
+    mBounds.clear();
+    mDestRects.clear();
+}
+
+void ProjectilePool::update(const float deltaTime) {
+    TS_PROFILE_SCOPE("ProjectilePool::update");
+
+    const size_t count = mPositions.size();
+    glm::vec2* positions = mPositions.data();
+    glm::vec2* prevPositions = mPrevPositions.data();
+    const glm::vec2* velocities = mVelocities.data();
+    float* lifeTimes = mLifeTimes.data();
+    AABB* bounds = mBounds.data();
+
+    // Straight loops without branches, simple enough for the compiler to vectorize.
+    for (size_t i = 0; i < count; i++) {
+        prevPositions[i] = positions[i];
+        positions[i] += velocities[i] * deltaTime;
+        lifeTimes[i] -= deltaTime;
+    }
+    for (size_t i = 0; i < count; i++) {
+        bounds[i].min = glm::min(prevPositions[i], positions[i]);
+        bounds[i].max = glm::max(prevPositions[i], positions[i]) + mSize;
+    }
+
+    removeDead();
+}
+
+void ProjectilePool::collide(const SpatialGrid& world, std::vector<ProjectileHit>& outHits) {
+    TS_PROFILE_SCOPE("ProjectilePool::collide");
+
+    bool anyHit = false;
+    for (size_t i = 0; i < mPositions.size(); i++) {
+        mHitCandidates.clear();
+        world.query(mBounds[i], mHitCandidates);
+        if (mHitCandidates.empty()) {
+            continue;
+        }
+
+        // A projectile is spent on the first thing it hits.
+        outHits.push_back({ mPositions[i], mVelocities[i], mHitCandidates[0] });
+        mLifeTimes[i] = 0.0f;
+        anyHit = true;
+    }
+
+    if (anyHit) {
+        removeDead();
+    }
+}
+
+size_t ProjectilePool::buildDrawData(const AABB& view, const float alpha) {
+    TS_PROFILE_SCOPE("ProjectilePool::buildDrawData");
+
+    const size_t count = mPositions.size();
+    mCullMask.resize(cullMaskWords(count));
+    cullAABBs(mBounds.data(), count, view, mCullMask.data());
+
+    mDestRects.clear();
+    for (size_t word = 0; word < mCullMask.size(); word++) {
+        // Walk the set bits only, most words are empty when few projectiles are on screen.
+        uint32_t bits = mCullMask[word];
+        while (bits != 0) {
+            uint32_t bit = 0;
+            while (((bits >> bit) & 1u) == 0) {
+                bit++;
+            }
+            bits &= bits - 1;
+
+            const size_t i = word * 32 + bit;
+            const glm::vec2 renderPos = glm::mix(mPrevPositions[i], mPositions[i], alpha);
+            mDestRects.emplace_back(renderPos, mSize);
+        }
+    }
+
+    return mDestRects.size();
+}
+
+void ProjectilePool::draw(Spritebatch& spriteBatch, const int depth) const {
+    spriteBatch.draw(mDestRects.data(), mDestRects.size(), glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), mTexture.id, depth, mColor);
+}
+
+void ProjectilePool::removeDead() {
+    // Swap and pop, order doesn't matter.
+    size_t count = mPositions.size();
+    for (size_t i = 0; i < count;) {
+        if (mLifeTimes[i] > 0.0f) {
+            i++;
+            continue;
+        }
+
+        count--;
+        mPositions[i] = mPositions[count];
+        mPrevPositions[i] = mPrevPositions[count];
+        mVelocities[i] = mVelocities[count];
+        mLifeTimes[i] = mLifeTimes[count];
+        mBounds[i] = mBounds[count];
+    }
+
+    mPositions.resize(count);
+    mPrevPositions.resize(count);
+    mVelocities.resize(count);
+    mLifeTimes.resize(count);
+    mBounds.resize(count);
+}
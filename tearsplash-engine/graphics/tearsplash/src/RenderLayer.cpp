@@ -0,0 +1,155 @@
+#include "Tearsplash/RenderLayer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Tearsplash/Errors.h"
+#include "Tearsplash/Profiler.h"
+#include "Tearsplash/Spritebatch.h"
+
+using namespace Tearsplash;
+
+RenderLayer::RenderLayer() :
+    mFramebuffer(0), mTexture(0), mWidth(0), mHeight(0), mBounds{ glm::vec2(0.0f), glm::vec2(0.0f) },
+    mPixelsPerUnit(1.0f), mDirtyMin(0), mDirtyMax(0), mNumRedraws(0),
+    mPrevFramebuffer(0), mPrevViewport{ 0, 0, 0, 0 }, mPrevClearColor{ 0.0f, 0.0f, 0.0f, 0.0f },
+    mPrevBlend{ 0, 0, 0, 0 }, mPrevScissorBox{ 0, 0, 0, 0 }, mPrevScissorTest(GL_FALSE) {
+}
+
+RenderLayer::~RenderLayer() {
+    // Do nothing.
+}
+
+void RenderLayer::init(const AABB& bounds, const float pixelsPerUnit) {
+    destroy();
+
+    mBounds = bounds;
+    mPixelsPerUnit = pixelsPerUnit;
+
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    mWidth = static_cast<int>(std::ceil((bounds.max.x - bounds.min.x) * pixelsPerUnit));
+    mHeight = static_cast<int>(std::ceil((bounds.max.y - bounds.min.y) * pixelsPerUnit));
+    if (mWidth <= 0 || mHeight <= 0 || mWidth > maxSize || mHeight > maxSize) {
+        Tearsplash::fatalError("Render layer size not supported by the GPU");
+    }
+    mBounds.max = mBounds.min + glm::vec2(mWidth, mHeight) / pixelsPerUnit;
+
+    glGenTextures(1, &mTexture);
+    glBindTexture(GL_TEXTURE_2D, mTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, mWidth, mHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLint prevFramebuffer = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prevFramebuffer);
+    glGenFramebuffers(1, &mFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mTexture, 0);
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, prevFramebuffer);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        Tearsplash::fatalError("Render layer framebuffer is incomplete");
+    }
+
+    mNumRedraws = 0;
+    invalidate();
+}
+
+void RenderLayer::destroy() {
+    if (mFramebuffer != 0) {
+        glDeleteFramebuffers(1, &mFramebuffer);
+        glDeleteTextures(1, &mTexture);
+        mFramebuffer = 0;
+        mTexture = 0;
+    }
+    mWidth = 0;
+    mHeight = 0;
+    mDirtyMin = glm::ivec2(0);
+    mDirtyMax = glm::ivec2(0);
+}
+
+void RenderLayer::invalidate() {
+    mDirtyMin = glm::ivec2(0);
+    mDirtyMax = glm::ivec2(mWidth, mHeight);
+}
+
+void RenderLayer::invalidate(const AABB& region) {
+    // Every texel the region touches, clamped to the layer.
+    const glm::vec2 minTexel = (region.min - mBounds.min) * mPixelsPerUnit;
+    const glm::vec2 maxTexel = (region.max - mBounds.min) * mPixelsPerUnit;
+    const glm::ivec2 regionMin = glm::max(glm::ivec2(glm::floor(minTexel)), glm::ivec2(0));
+    const glm::ivec2 regionMax = glm::min(glm::ivec2(glm::ceil(maxTexel)), glm::ivec2(mWidth, mHeight));
+    if (regionMin.x >= regionMax.x || regionMin.y >= regionMax.y) {
+        return;
+    }
+
+    if (isDirty()) {
+        mDirtyMin = glm::min(mDirtyMin, regionMin);
+        mDirtyMax = glm::max(mDirtyMax, regionMax);
+    }
+    else {
+        mDirtyMin = regionMin;
+        mDirtyMax = regionMax;
+    }
+}
+
+AABB RenderLayer::getDirtyRect() const {
+    const float unitsPerPixel = 1.0f / mPixelsPerUnit;
+    return { mBounds.min + glm::vec2(mDirtyMin) * unitsPerPixel, mBounds.min + glm::vec2(mDirtyMax) * unitsPerPixel };
+}
+
+glm::mat4 RenderLayer::begin() {
+    TS_PROFILE_SCOPE("RenderLayer::begin");
+
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &mPrevFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, mPrevViewport);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, mPrevClearColor);
+    glGetIntegerv(GL_BLEND_SRC_RGB, &mPrevBlend[0]);
+    glGetIntegerv(GL_BLEND_DST_RGB, &mPrevBlend[1]);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, &mPrevBlend[2]);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, &mPrevBlend[3]);
+    glGetIntegerv(GL_SCISSOR_BOX, mPrevScissorBox);
+    mPrevScissorTest = glIsEnabled(GL_SCISSOR_TEST);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+    glViewport(0, 0, mWidth, mHeight);
+
+    const glm::ivec2 dirtySize = mDirtyMax - mDirtyMin;
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(mDirtyMin.x, mDirtyMin.y, dirtySize.x, dirtySize.y);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // Usual alpha blending for color, but alpha accumulates as coverage, which leaves
+    // premultiplied color in the layer.
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    mNumRedraws++;
+    return glm::ortho(mBounds.min.x, mBounds.max.x, mBounds.min.y, mBounds.max.y);
+}
+
+void RenderLayer::end() {
+    glBlendFuncSeparate(mPrevBlend[0], mPrevBlend[1], mPrevBlend[2], mPrevBlend[3]);
+    glClearColor(mPrevClearColor[0], mPrevClearColor[1], mPrevClearColor[2], mPrevClearColor[3]);
+    glScissor(mPrevScissorBox[0], mPrevScissorBox[1], mPrevScissorBox[2], mPrevScissorBox[3]);
+    if (mPrevScissorTest == GL_FALSE) {
+        glDisable(GL_SCISSOR_TEST);
+    }
+    glViewport(mPrevViewport[0], mPrevViewport[1], mPrevViewport[2], mPrevViewport[3]);
+    glBindFramebuffer(GL_FRAMEBUFFER, mPrevFramebuffer);
+
+    mDirtyMin = glm::ivec2(0);
+    mDirtyMax = glm::ivec2(0);
+}
+
+void RenderLayer::draw(Spritebatch& spriteBatch, const int depth) const {
+    // Texel row 0 is the bottom of the layer, the same way up as Spritebatch uvs.
+    const glm::vec4 destRect(mBounds.min, mBounds.max - mBounds.min);
+    spriteBatch.draw(destRect, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), mTexture, depth, ColorRGBA8(255, 255, 255, 255));
+}
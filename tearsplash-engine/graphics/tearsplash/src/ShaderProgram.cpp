@@ -22,7 +22,7 @@ using namespace Tearsplash;
 
 // ----------------------------------
 // Default constructor
-ShaderProgram::ShaderProgram() : mNumAttributes(0), mProgramID(0), mVertexShaderID(0), mFragmentShaderID(0)
+ShaderProgram::ShaderProgram() : mNumAttributes(0), mProgramID(0), mVertexShaderID(0), mGeometryShaderID(0), mFragmentShaderID(0)
 {
 	// Initialize member variables through MIL
 }
@@ -42,23 +42,9 @@ void ShaderProgram::compileShaders(const std::string &vertexShaderFilePath, cons
 	// Create program
 	mProgramID = glCreateProgram();
 
-	// Define local variables
-	std::string vertexCode;
-	std::string fragmentCode;
-	std::ifstream vertexShaderFile;
-	std::ifstream fragmentShaderFile;
-
 	// Create vertex and fragment shaders
-	mVertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-	mFragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
-	if (mVertexShaderID == (GLuint)0)
-	{
-		fatalError("Could not create vertex shader");
-	}
-	if (mFragmentShaderID == (GLuint)0)
-	{
-		fatalError("Could not create fragment shader");
-	}
+	mVertexShaderID = createShader(GL_VERTEX_SHADER);
+	mFragmentShaderID = createShader(GL_FRAGMENT_SHADER);
 
 	// Compile shaders
 	compileShader(vertexShaderFilePath, mVertexShaderID);
@@ -68,15 +54,56 @@ void ShaderProgram::compileShaders(const std::string &vertexShaderFilePath, cons
 }
 
 // ----------------------------------
-// Links a vertex shader and a fragment shader to the mProgramID
+// Compiles a vertex shader, a geometry shader and a fragment
+// shader given file path for each file.
+void ShaderProgram::compileShaders(const std::string &vertexShaderFilePath, const std::string &geometryShaderFilePath, const std::string &fragmentShaderFilePath)
+{
+	compileShaders(vertexShaderFilePath, fragmentShaderFilePath);
+
+	mGeometryShaderID = createShader(GL_GEOMETRY_SHADER);
+	compileShader(geometryShaderFilePath, mGeometryShaderID);
+
+	return;
+}
+
+// ----------------------------------
+// Compiles only a vertex shader. Used for programs that never
+// rasterize, e.g. transform feedback passes.
+void ShaderProgram::compileShaders(const std::string &vertexShaderFilePath)
+{
+	mProgramID = glCreateProgram();
+
+	mVertexShaderID = createShader(GL_VERTEX_SHADER);
+	compileShader(vertexShaderFilePath, mVertexShaderID);
+
+	return;
+}
+
+// ----------------------------------
+// Tells the program which vertex shader outputs to capture
+// with transform feedback. The outputs are written interleaved
+// in the order given.
+void ShaderProgram::setTransformFeedbackVaryings(const std::vector<const char*>& varyings)
+{
+	glTransformFeedbackVaryings(mProgramID, static_cast<GLsizei>(varyings.size()), varyings.data(), GL_INTERLEAVED_ATTRIBS);
+}
+
+// ----------------------------------
+// Links the compiled shaders to the mProgramID
 void ShaderProgram::linkShaders()
 {
-	// Vertex and fragment shaders are successfully compiled.
+	// Shaders are successfully compiled.
 	// Now time to link them together into a program.
+	const GLuint shaderIDs[] = { mVertexShaderID, mGeometryShaderID, mFragmentShaderID };
 
 	// Attach our shaders to our program
-	glAttachShader(mProgramID, mVertexShaderID);
-	glAttachShader(mProgramID, mFragmentShaderID);
+	for (GLuint shaderID : shaderIDs)
+	{
+		if (shaderID != 0)
+		{
+			glAttachShader(mProgramID, shaderID);
+		}
+	}
 
 	// Link our program
 	glLinkProgram(mProgramID);
@@ -96,8 +123,13 @@ void ShaderProgram::linkShaders()
 		// We don't need the program anymore.
 		glDeleteProgram(mProgramID);
 		// Don't leak shaders either.
-		glDeleteShader(mVertexShaderID);
-		glDeleteShader(mFragmentShaderID);
+		for (GLuint shaderID : shaderIDs)
+		{
+			if (shaderID != 0)
+			{
+				glDeleteShader(shaderID);
+			}
+		}
 
 		// Use the infoLog as you see fit.
 		printf("Failed to link program. Log info: %s", &infoLog[0]);
@@ -106,14 +138,31 @@ void ShaderProgram::linkShaders()
 	}
 
 	// Always detach shaders after a successful link. Delete as well.
-	glDetachShader(mProgramID, mVertexShaderID);
-	glDetachShader(mProgramID, mFragmentShaderID);
-	glDeleteShader(mVertexShaderID);
-	glDeleteShader(mFragmentShaderID);
+	for (GLuint shaderID : shaderIDs)
+	{
+		if (shaderID != 0)
+		{
+			glDetachShader(mProgramID, shaderID);
+			glDeleteShader(shaderID);
+		}
+	}
 
 	return;
 }
 
+// ----------------------------------
+// Creates an empty shader object of the given type
+GLuint ShaderProgram::createShader(GLenum shaderType)
+{
+	GLuint id = glCreateShader(shaderType);
+	if (id == (GLuint)0)
+	{
+		fatalError("Could not create shader of type " + std::to_string(shaderType));
+	}
+
+	return id;
+}
+
 // ----------------------------------
 // Compiles a shader given a file path and an id. Also prints errors
 // if there are any.
@@ -0,0 +1,223 @@
+#include "Tearsplash/SpatialGrid.h"
+
+#include <algorithm>
+
+using namespace Tearsplash;
+
+namespace {
+    const int INITIAL_CELL_SLOT_SHIFT = 10;
+
+    size_t slotIndex(const uint64_t key, const int shift) {
+        // Fibonacci hashing, the top bits of the product are well mixed.
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> (64 - shift));
+    }
+
+    // std::floor is a library call on plain SSE2 targets, and this runs four times per query.
+    int floorToInt(const float value) {
+        const int truncated = static_cast<int>(value);
+        return truncated - (value < static_cast<float>(truncated) ? 1 : 0);
+    }
+}
+
+SpatialGrid::SpatialGrid() : mInvCellSize(1.0f / 64.0f), mCellSlotShift(0), mQueryStamp(0) {
+    clear();
+}
+
+SpatialGrid::~SpatialGrid() {
+    // Do nothing.
+}
+
+void SpatialGrid::init(const float cellSize) {
+    mInvCellSize = 1.0f / cellSize;
+    clear();
+}
+
+void SpatialGrid::clear() {
+    mEntries.clear();
+    mFreeHandles.clear();
+    mCellLists.clear();
+    mFreeCellLists.clear();
+    mCellSlotShift = INITIAL_CELL_SLOT_SHIFT;
+    mCellSlots.assign(size_t(1) << mCellSlotShift, { 0, -1 });
+}
+
+int SpatialGrid::insert(const AABB& bounds, const uint32_t userData) {
+    int handle;
+    if (mFreeHandles.empty()) {
+        handle = static_cast<int>(mEntries.size());
+        mEntries.emplace_back();
+    }
+    else {
+        handle = mFreeHandles.back();
+        mFreeHandles.pop_back();
+    }
+
+    Entry& entry = mEntries[handle];
+    entry.bounds = bounds;
+    entry.cells = cellRange(bounds);
+    entry.userData = userData;
+    entry.queryStamp = mQueryStamp;
+    addToCells(handle, entry.cells);
+
+    return handle;
+}
+
+void SpatialGrid::update(const int handle, const AABB& bounds) {
+    Entry& entry = mEntries[handle];
+    entry.bounds = bounds;
+
+    // Most moves stay within the same cells.
+    const glm::ivec4 cells = cellRange(bounds);
+    if (cells != entry.cells) {
+        removeFromCells(handle, entry.cells);
+        addToCells(handle, cells);
+        entry.cells = cells;
+    }
+}
+
+void SpatialGrid::remove(const int handle) {
+    removeFromCells(handle, mEntries[handle].cells);
+    mFreeHandles.push_back(handle);
+}
+
+void SpatialGrid::query(const AABB& region, std::vector<uint32_t>& out) const {
+    // Entries spanning several cells are only reported the first time they're seen.
+    mQueryStamp++;
+
+    const glm::ivec4 cells = cellRange(region);
+    for (int y = cells.y; y <= cells.w; y++) {
+        for (int x = cells.x; x <= cells.z; x++) {
+            const int list = findCell(cellKey(x, y));
+            if (list < 0) {
+                continue;
+            }
+
+            for (const int handle : mCellLists[list]) {
+                const Entry& entry = mEntries[handle];
+                if (entry.queryStamp != mQueryStamp) {
+                    entry.queryStamp = mQueryStamp;
+                    if (entry.bounds.overlaps(region)) {
+                        out.push_back(entry.userData);
+                    }
+                }
+            }
+        }
+    }
+}
+
+glm::ivec4 SpatialGrid::cellRange(const AABB& bounds) const {
+    return glm::ivec4(floorToInt(bounds.min.x * mInvCellSize),
+                      floorToInt(bounds.min.y * mInvCellSize),
+                      floorToInt(bounds.max.x * mInvCellSize),
+                      floorToInt(bounds.max.y * mInvCellSize));
+}
+
+uint64_t SpatialGrid::cellKey(const int x, const int y) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
+
+void SpatialGrid::addToCells(const int handle, const glm::ivec4& cells) {
+    for (int y = cells.y; y <= cells.w; y++) {
+        for (int x = cells.x; x <= cells.z; x++) {
+            findOrAddCell(cellKey(x, y)).push_back(handle);
+        }
+    }
+}
+
+void SpatialGrid::removeFromCells(const int handle, const glm::ivec4& cells) {
+    for (int y = cells.y; y <= cells.w; y++) {
+        for (int x = cells.x; x <= cells.z; x++) {
+            const int list = findCell(cellKey(x, y));
+            if (list < 0) {
+                continue;
+            }
+
+            // Order within a cell doesn't matter, swap and pop.
+            std::vector<int>& handles = mCellLists[list];
+            auto handleIt = std::find(handles.begin(), handles.end(), handle);
+            if (handleIt != handles.end()) {
+                *handleIt = handles.back();
+                handles.pop_back();
+            }
+            if (handles.empty()) {
+                freeCell(cellKey(x, y));
+            }
+        }
+    }
+}
+
+int SpatialGrid::findCell(const uint64_t key) const {
+    const size_t mask = mCellSlots.size() - 1;
+    for (size_t i = slotIndex(key, mCellSlotShift);; i = (i + 1) & mask) {
+        const CellSlot& slot = mCellSlots[i];
+        if (slot.list < 0 || slot.key == key) {
+            return slot.list;
+        }
+    }
+}
+
+std::vector<int>& SpatialGrid::findOrAddCell(const uint64_t key) {
+    // Keep the table at most half full so probe sequences stay short.
+    if ((mCellLists.size() - mFreeCellLists.size() + 1) * 2 > mCellSlots.size()) {
+        growCellTable();
+    }
+
+    const size_t mask = mCellSlots.size() - 1;
+    for (size_t i = slotIndex(key, mCellSlotShift);; i = (i + 1) & mask) {
+        CellSlot& slot = mCellSlots[i];
+        if (slot.list < 0) {
+            slot.key = key;
+            if (mFreeCellLists.empty()) {
+                slot.list = static_cast<int>(mCellLists.size());
+                mCellLists.emplace_back();
+            }
+            else {
+                slot.list = mFreeCellLists.back();
+                mFreeCellLists.pop_back();
+            }
+            return mCellLists[slot.list];
+        }
+        if (slot.key == key) {
+            return mCellLists[slot.list];
+        }
+    }
+}
+
+void SpatialGrid::freeCell(const uint64_t key) {
+    const size_t mask = mCellSlots.size() - 1;
+    size_t hole = slotIndex(key, mCellSlotShift);
+    while (mCellSlots[hole].key != key) {
+        hole = (hole + 1) & mask;
+    }
+    mFreeCellLists.push_back(mCellSlots[hole].list);
+
+    // Backward shift deletion, no tombstones. Pull later slots of the probe run into the
+    // hole unless that would move them in front of their home slot.
+    for (size_t i = (hole + 1) & mask; mCellSlots[i].list >= 0; i = (i + 1) & mask) {
+        const size_t home = slotIndex(mCellSlots[i].key, mCellSlotShift);
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            mCellSlots[hole] = mCellSlots[i];
+            hole = i;
+        }
+    }
+    mCellSlots[hole].list = -1;
+}
+
+void SpatialGrid::growCellTable() {
+    std::vector<CellSlot> oldSlots;
+    oldSlots.swap(mCellSlots);
+    mCellSlotShift++;
+    mCellSlots.assign(size_t(1) << mCellSlotShift, { 0, -1 });
+
+    const size_t mask = mCellSlots.size() - 1;
+    for (const CellSlot& oldSlot : oldSlots) {
+        if (oldSlot.list < 0) {
+            continue;
+        }
+        size_t i = slotIndex(oldSlot.key, mCellSlotShift);
+        while (mCellSlots[i].list >= 0) {
+            i = (i + 1) & mask;
+        }
+        mCellSlots[i] = oldSlot;
+    }
+}
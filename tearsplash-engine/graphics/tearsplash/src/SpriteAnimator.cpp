@@ -0,0 +1,170 @@
+#include "Tearsplash/SpriteAnimator.h"
+
+#include "Tearsplash/Errors.h"
+#include "Tearsplash/Profiler.h"
+
+using namespace Tearsplash;
+
+SpriteAnimator::SpriteAnimator() {
+}
+
+SpriteAnimator::~SpriteAnimator() {
+    // Do nothing.
+}
+
+int SpriteAnimator::addClip(const Tilesheet& tilesheet, const std::vector<int>& tiles, const std::vector<float>& durations,
+                            const bool loop) {
+    if (tiles.empty() || tiles.size() != durations.size()) {
+        Tearsplash::fatalError("Animation clip needs one duration per frame");
+    }
+
+    Clip clip;
+    clip.firstFrame = static_cast<uint32_t>(mFrameUVs.size());
+    clip.numFrames = static_cast<uint32_t>(tiles.size());
+    clip.texture = tilesheet.mTexture.id;
+    clip.loop = loop;
+
+    for (size_t i = 0; i < tiles.size(); i++) {
+        if (tiles[i] < 0 || tiles[i] >= tilesheet.getNumTiles()) {
+            Tearsplash::fatalError("Animation frame outside of its tilesheet");
+        }
+        // update() steps frames until the time left fits in one, which needs every frame to take time.
+        if (!(durations[i] > 0.0f)) {
+            Tearsplash::fatalError("Animation frame durations must be positive");
+        }
+        mFrameUVs.push_back(tilesheet.getUV(tiles[i]));
+        mFrameDurations.push_back(durations[i]);
+    }
+
+    mClips.push_back(clip);
+    return static_cast<int>(mClips.size()) - 1;
+}
+
+int SpriteAnimator::addClip(const Tilesheet& tilesheet, const int firstTile, const int numFrames, const float frameDuration,
+                            const bool loop) {
+    std::vector<int> tiles(numFrames > 0 ? numFrames : 0);
+    for (size_t i = 0; i < tiles.size(); i++) {
+        tiles[i] = firstTile + static_cast<int>(i);
+    }
+    return addClip(tilesheet, tiles, std::vector<float>(tiles.size(), frameDuration), loop);
+}
+
+void SpriteAnimator::clear() {
+    mFrameUVs.clear();
+    mFrameDurations.clear();
+    mClips.clear();
+
+    mTimes.clear();
+    mClipIds.clear();
+    mFrames.clear();
+    mHandles.clear();
+    mIndices.clear();
+    mFreeHandles.clear();
+}
+
+int SpriteAnimator::play(const int clip, const float startTime) {
+    int handle;
+    if (mFreeHandles.empty()) {
+        handle = static_cast<int>(mIndices.size());
+        mIndices.push_back(-1);
+    }
+    else {
+        handle = mFreeHandles.back();
+        mFreeHandles.pop_back();
+    }
+
+    uint32_t frame = mClips[clip].firstFrame;
+    float time = startTime > 0.0f ? startTime : 0.0f;
+    if (time >= mFrameDurations[frame]) {
+        advance(mClips[clip], frame, time);
+    }
+
+    mIndices[handle] = static_cast<int>(mTimes.size());
+    mTimes.push_back(time);
+    mClipIds.push_back(static_cast<uint32_t>(clip));
+    mFrames.push_back(frame);
+    mHandles.push_back(handle);
+    return handle;
+}
+
+void SpriteAnimator::setClip(const int handle, const int clip) {
+    const int index = mIndices[handle];
+    if (mClipIds[index] == static_cast<uint32_t>(clip)) {
+        return;
+    }
+
+    mTimes[index] = 0.0f;
+    mClipIds[index] = static_cast<uint32_t>(clip);
+    mFrames[index] = mClips[clip].firstFrame;
+}
+
+void SpriteAnimator::remove(const int handle) {
+    // Move the last player into the removed one's slot to keep the arrays packed.
+    const int index = mIndices[handle];
+    const int last = static_cast<int>(mTimes.size()) - 1;
+    if (index != last) {
+        mTimes[index] = mTimes[last];
+        mClipIds[index] = mClipIds[last];
+        mFrames[index] = mFrames[last];
+        mHandles[index] = mHandles[last];
+        mIndices[mHandles[index]] = index;
+    }
+
+    mTimes.pop_back();
+    mClipIds.pop_back();
+    mFrames.pop_back();
+    mHandles.pop_back();
+
+    mIndices[handle] = -1;
+    mFreeHandles.push_back(handle);
+}
+
+void SpriteAnimator::update(const float deltaTime) {
+    TS_PROFILE_SCOPE("SpriteAnimator::update");
+
+    const size_t count = mTimes.size();
+    float* times = mTimes.data();
+    uint32_t* frames = mFrames.data();
+    const uint32_t* clipIds = mClipIds.data();
+    const float* durations = mFrameDurations.data();
+
+    for (size_t i = 0; i < count; i++) {
+        float time = times[i] + deltaTime;
+        uint32_t frame = frames[i];
+
+        // Most sprites stay on their frame, the clip is only looked up when one ends.
+        if (time >= durations[frame]) {
+            advance(mClips[clipIds[i]], frame, time);
+        }
+
+        times[i] = time;
+        frames[i] = frame;
+    }
+}
+
+void SpriteAnimator::advance(const Clip& clip, uint32_t& frame, float& time) const {
+    const float* durations = mFrameDurations.data();
+    const uint32_t lastFrame = clip.firstFrame + clip.numFrames - 1;
+    float duration = durations[frame];
+    do {
+        if (frame == lastFrame) {
+            if (!clip.loop) {
+                time = duration;
+                return;
+            }
+            frame = clip.firstFrame;
+        }
+        else {
+            frame++;
+        }
+        time -= duration;
+        duration = durations[frame];
+    } while (time >= duration);
+}
+
+bool SpriteAnimator::isFinished(const int handle) const {
+    const int index = mIndices[handle];
+    const Clip& clip = mClips[mClipIds[index]];
+    const uint32_t frame = mFrames[index];
+    return !clip.loop && frame == clip.firstFrame + clip.numFrames - 1 && mTimes[index] >= mFrameDurations[frame];
+}
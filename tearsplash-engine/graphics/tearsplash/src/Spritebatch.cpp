@@ -11,6 +11,7 @@
 
 #include "Tearsplash/Spritebatch.h"
 #include "Tearsplash/Errors.h"
+#include "Tearsplash/Profiler.h"
 
 #include <vector>
 #include <algorithm>
@@ -35,6 +36,8 @@ void Spritebatch::begin(GlyphSortType sortType)
 
 void Spritebatch::end() 
 {
+    TS_PROFILE_SCOPE("Spritebatch::end");
+
     mGlyphPointers.resize(mGlyphs.size());
     for (int i = 0; i < mGlyphPointers.size(); i++) {
         mGlyphPointers[i] = &mGlyphs[i];
@@ -67,6 +70,20 @@ void Tearsplash::Spritebatch::draw(const glm::vec4& destRect, const glm::vec4& u
     mGlyphs.emplace_back(destRect, uvRect, texture, depth, color, radianAngle);
 }
 
+void Tearsplash::Spritebatch::draw(const Glyph* glyphs, size_t count)
+{
+    mGlyphs.insert(mGlyphs.end(), glyphs, glyphs + count);
+}
+
+void Tearsplash::Spritebatch::draw(const glm::vec4* destRects, size_t count, const glm::vec4& uvRect, GLuint texture, int depth, const ColorRGBA8& color)
+{
+    mGlyphs.reserve(mGlyphs.size() + count);
+    for (size_t i = 0; i < count; i++)
+    {
+        mGlyphs.emplace_back(destRects[i], uvRect, texture, depth, color);
+    }
+}
+
 void Spritebatch::createVertexArray()
 {
     if (mVAO == 0)
@@ -122,6 +139,8 @@ void Spritebatch::sortGlyphs()
 
 void Spritebatch::renderBatch()
 {
+    TS_PROFILE_SCOPE("Spritebatch::renderBatch");
+
     glBindVertexArray(mVAO);
 
     // Render all batches
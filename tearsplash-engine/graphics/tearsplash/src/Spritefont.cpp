@@ -1,142 +1,379 @@
 #include "Tearsplash/Spritefont.h"
+#include "Tearsplash/DistanceField.h"
 #include "Tearsplash/Errors.h"
+#include "Tearsplash/Profiler.h"
+
+#include <algorithm>
+#include <cstring>
 
 #include <GL/glew.h>
 
 using namespace Tearsplash;
 
+namespace {
+    const uint32_t REPLACEMENT_CHARACTER = 0xFFFD;
+    // Pixels a distance field reaches out from the glyph edge.
+    const int SDF_SPREAD = 6;
+
+    // Decodes the UTF-8 sequence starting at text[i] and moves i past it.
+    // Malformed sequences decode to U+FFFD.
+    uint32_t decodeUtf8(const std::string& text, size_t& i) {
+        const unsigned char lead = static_cast<unsigned char>(text[i++]);
+        if (lead < 0x80) {
+            return lead;
+        }
+
+        int length = 0;
+        uint32_t codepoint = 0;
+        if ((lead & 0xE0) == 0xC0) {
+            length = 1;
+            codepoint = lead & 0x1F;
+        }
+        else if ((lead & 0xF0) == 0xE0) {
+            length = 2;
+            codepoint = lead & 0x0F;
+        }
+        else if ((lead & 0xF8) == 0xF0) {
+            length = 3;
+            codepoint = lead & 0x07;
+        }
+        else {
+            return REPLACEMENT_CHARACTER;
+        }
+
+        for (int n = 0; n < length; n++) {
+            if (i == text.size() || (static_cast<unsigned char>(text[i]) & 0xC0) != 0x80) {
+                return REPLACEMENT_CHARACTER;
+            }
+            codepoint = (codepoint << 6) | (static_cast<unsigned char>(text[i++]) & 0x3F);
+        }
+        return codepoint <= 0x10FFFF ? codepoint : REPLACEMENT_CHARACTER;
+    }
+}
+
 Spritefont::Spritefont() :
 mPixelWidth(static_cast<FT_UInt>(0)),
-mPixelHeight(static_cast<FT_UInt>(48)) {}
+mPixelHeight(static_cast<FT_UInt>(48)),
+mRenderMode(FontRenderMode::BITMAP),
+mLibrary(nullptr),
+mFace(nullptr),
+mCharacters(),
+mDeferred(false),
+mRasterQuit(false) {}
 
 Spritefont::~Spritefont() {
-    // Do nothing.
+    stopRasterizer();
+    if (mFace != nullptr) {
+        FT_Done_Face(mFace);
+    }
+    if (mLibrary != nullptr) {
+        FT_Done_FreeType(mLibrary);
+    }
 }
 
-void Spritefont::init(const char* fontPath, unsigned int pixelWidth/*=0*/, unsigned int pixelHeight/*=48*/) {
-    FT_Library ftLibrary;
-    FT_Face ftFace;
-    if (FT_Init_FreeType(&ftLibrary)) {
+void Spritefont::init(const char* fontPath, unsigned int pixelWidth/*=0*/, unsigned int pixelHeight/*=48*/, const int maxAtlasPages/*=4*/,
+                      const FontRenderMode renderMode/*=FontRenderMode::BITMAP*/) {
+    mRenderMode = renderMode;
+
+    if (FT_Init_FreeType(&mLibrary)) {
         Tearsplash::fatalError("Could not init FreeType Library");
     }
 
-    if (FT_New_Face(ftLibrary, fontPath, 0, &ftFace))
+    // The face stays open, glyphs outside ascii are loaded when first drawn.
+    if (FT_New_Face(mLibrary, fontPath, 0, &mFace))
     {
         Tearsplash::fatalError("Failed to load font");
     }
 
-    FT_Set_Pixel_Sizes(ftFace, mPixelWidth, mPixelHeight);
+    mPixelWidth = pixelWidth;
+    mPixelHeight = pixelHeight;
+    FT_Set_Pixel_Sizes(mFace, mPixelWidth, mPixelHeight);
 
     // Enable blending mode.
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    // Disable byte-alignment restriction.
-    // The reason for this is that the textures
-    // requires all textures to be 4-byte aligned
-    //, i.e. have a size multiple by 4.  Since
-    // we're only going to use the red channel,
-    // the texture could have any dimension. We
-    // don't want any unnecessary padding added
-    // or alignment issues, which is why we disable
-    // the aligning.
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
-
-    for (unsigned char c = 0; c < 128; c++)
+    // Every glyph goes into the same few atlas pages, so a line of text is one draw call.
+    // The atlas disables the 4-byte row alignment itself, glyph bitmaps can have any width.
+    mAtlas.init(1024, 1, maxAtlasPages);
+
+    // Printable ascii up front, so common text never waits.
+    RasterizedGlyph glyph;
+    for (uint32_t c = 32; c < 127; c++)
     {
-        // load character glyph 
-        if (FT_Load_Char(ftFace, c, FT_LOAD_RENDER))
+        rasterize(c, glyph);
+        if (!addGlyph(glyph))
         {
-            //std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
-            break;
-        }
-        // generate texture
-        unsigned int texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            ftFace->glyph->bitmap.width,
-            ftFace->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            ftFace->glyph->bitmap.buffer
-        );
-
-        // set texture options
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // now store character for later use
-        Character character = {
-            texture,
-            ftFace->glyph->advance.x,
-            glm::ivec2(ftFace->glyph->bitmap.width, ftFace->glyph->bitmap.rows),
-            glm::ivec2(ftFace->glyph->bitmap_left, ftFace->glyph->bitmap_top),
-        };
-        mCharacters.insert(std::pair<char, Character>(c, character));
-    }
-
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    // Done with the face and library, free from FT.
-    FT_Done_Face(ftFace);
-    FT_Done_FreeType(ftLibrary);
+            Tearsplash::fatalError("Glyph too large for the font atlas");
+        }
+    }
 
     // Initialize the SpriteBatch used for text.
     mSpritebatchText.init();
 
     // Setup the shaders to be used for this text.
-    mTextShader.compileShaders("tearsplash/shaders/2DText.vert", "tearsplash/shaders/2DText.frag");
+    if (mRenderMode == FontRenderMode::SIGNED_DISTANCE_FIELD) {
+        mTextShader.compileShaders("tearsplash/shaders/2DText.vert", "tearsplash/shaders/2DTextSDF.frag");
+    }
+    else {
+        mTextShader.compileShaders("tearsplash/shaders/2DText.vert", "tearsplash/shaders/2DText.frag");
+    }
     mTextShader.addAttribute("vertexPosition");
     mTextShader.addAttribute("vertexColor");
     mTextShader.addAttribute("vertexUV");
     mTextShader.linkShaders();
 }
 
+void Spritefont::setDeferredRasterization(const bool deferred) {
+    if (deferred == mDeferred) {
+        return;
+    }
+
+    mDeferred = deferred;
+    if (mDeferred) {
+        mRasterQuit = false;
+        mRasterizer = std::thread(&Spritefont::rasterizerLoop, this);
+    }
+    else {
+        stopRasterizer();
+        collectRasterizedGlyphs();
+        mPendingGlyphs.clear();
+    }
+}
+
 void Spritefont::drawText(const std::string& text, const glm::vec4& position, const glm::mat4& cameraMatrix, const glm::vec3& textColor, const float scale) {
-    mTextShader.use();
+    mLastLayout.set(text, glm::vec2(position.x, position.y), textColor, scale);
+    drawText(mLastLayout, cameraMatrix);
+}
 
-    float x = position.x;
-    float y = position.y;
+void Spritefont::drawText(TextLayout& layout, const glm::mat4& cameraMatrix) {
+    if (mDeferred) {
+        collectRasterizedGlyphs();
+    }
 
-    glUniform3f(mTextShader.getUniformLocation("textColor"), textColor.x, textColor.y, textColor.z);
+    // Laid out again when glyphs were missing or may have been evicted since.
+    if (layout.mFont != this || !layout.mComplete || layout.mAtlasEvictions != mAtlas.getNumEvictions()) {
+        layoutText(layout);
+        layout.mFont = this;
+    }
+    else {
+        for (const int page : layout.mPages) {
+            mAtlas.touch(page);
+        }
+    }
+
+    mTextShader.use();
+
+    glUniform3f(mTextShader.getUniformLocation("textColor"), layout.mColor.x, layout.mColor.y, layout.mColor.z);
     glUniformMatrix4fv(mTextShader.getUniformLocation("P"), 1, GL_FALSE, &(cameraMatrix[0][0]));
 
+    mSpritebatchText.begin(Tearsplash::GlyphSortType::TEXTURE);
+    mSpritebatchText.draw(layout.mGlyphs.data(), layout.mGlyphs.size());
+    mTextShader.dontuse();
+}
+
+void Spritefont::render() {
+    mTextShader.use();
+    mSpritebatchText.end();
+    mSpritebatchText.renderBatch();
+    mTextShader.dontuse();
+
+    mAtlas.newFrame();
+}
+
+void Spritefont::layoutText(TextLayout& layout) {
+    TS_PROFILE_SCOPE("Spritefont::layoutText");
+
+    float x = layout.mPosition.x;
+    float y = layout.mPosition.y;
+    const float scale = layout.mScale;
+
     ColorRGBA8 color;
-    color.r = static_cast<uint8_t>(textColor.r * 255.0);
-    color.g = static_cast<uint8_t>(textColor.g * 255.0);
-    color.b = static_cast<uint8_t>(textColor.b * 255.0);
+    color.r = static_cast<uint8_t>(layout.mColor.r * 255.0);
+    color.g = static_cast<uint8_t>(layout.mColor.g * 255.0);
+    color.b = static_cast<uint8_t>(layout.mColor.b * 255.0);
     color.a = 255;
 
-    mSpritebatchText.begin(Tearsplash::GlyphSortType::TEXTURE);
+    layout.mGlyphs.clear();
+    layout.mGlyphs.reserve(layout.mText.size());
+    layout.mPages.clear();
+    layout.mComplete = true;
 
     // iterate through all characters
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++)
+    size_t i = 0;
+    while (i < layout.mText.size())
     {
-        Character ch = mCharacters[*c];
+        const Character* ch = findGlyph(decodeUtf8(layout.mText, i));
+        if (ch == nullptr)
+        {
+            // Still rasterizing, the layout is redone next frame.
+            layout.mComplete = false;
+            continue;
+        }
 
-        float xpos = x + ch.bearing.x * scale;
-        float ypos = y - (ch.size.y - ch.bearing.y) * scale;
+        float xpos = x + ch->bearing.x * scale;
+        float ypos = y - (ch->size.y - ch->bearing.y) * scale;
 
-        float w = ch.size.x * scale;
-        float h = ch.size.y * scale;
+        float w = ch->size.x * scale;
+        float h = ch->size.y * scale;
 
-        mSpritebatchText.draw(glm::vec4(xpos, ypos, w, h), glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), ch.textureID, 0, color);
+        // Whitespace has nothing to draw, only an advance.
+        if (ch->size.x > 0 && ch->size.y > 0)
+        {
+            layout.mGlyphs.emplace_back(glm::vec4(xpos, ypos, w, h), ch->region.uvRect, ch->region.texture, 0, color);
+            if (std::find(layout.mPages.begin(), layout.mPages.end(), ch->region.page) == layout.mPages.end())
+            {
+                layout.mPages.push_back(ch->region.page);
+            }
+        }
         // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-        x += (ch.advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64)
+        x += (ch->advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64)
     }
-    mTextShader.dontuse();
+
+    // Any eviction this layout caused only hit pages it doesn't use.
+    layout.mAtlasEvictions = mAtlas.getNumEvictions();
 }
 
-void Spritefont::render() {
-    mTextShader.use();
-    mSpritebatchText.end();
-    mSpritebatchText.renderBatch();
-    mTextShader.dontuse();
-}
\ No newline at end of file
+const Character* Spritefont::findGlyph(const uint32_t codepoint) {
+    Character& ch = getCharacter(codepoint);
+    if (!ch.loaded || !mAtlas.isResident(ch.region)) {
+        if (mDeferred) {
+            requestGlyph(codepoint);
+            return nullptr;
+        }
+
+        RasterizedGlyph glyph;
+        rasterize(codepoint, glyph);
+        if (!addGlyph(glyph)) {
+            return nullptr;
+        }
+    }
+
+    mAtlas.touch(ch.region.page);
+    return &ch;
+}
+
+Character& Spritefont::getCharacter(const uint32_t codepoint) {
+    if (codepoint < 256) {
+        return mCharacters[codepoint];
+    }
+    return mExtendedCharacters[codepoint];
+}
+
+void Spritefont::rasterize(const uint32_t codepoint, RasterizedGlyph& glyph) {
+    glyph.codepoint = codepoint;
+    glyph.pixels.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(mFaceMutex);
+
+        // A codepoint the font can't load is kept as an empty glyph, so it isn't retried.
+        if (FT_Load_Char(mFace, codepoint, FT_LOAD_RENDER))
+        {
+            glyph.size = glm::ivec2(0);
+            glyph.bearing = glm::ivec2(0);
+            glyph.advance = 0;
+            return;
+        }
+
+        const FT_Bitmap& bitmap = mFace->glyph->bitmap;
+        glyph.size = glm::ivec2(bitmap.width, bitmap.rows);
+        glyph.bearing = glm::ivec2(mFace->glyph->bitmap_left, mFace->glyph->bitmap_top);
+        glyph.advance = static_cast<unsigned int>(mFace->glyph->advance.x);
+
+        glyph.pixels.resize(static_cast<size_t>(bitmap.width) * bitmap.rows);
+        for (unsigned int row = 0; row < bitmap.rows; row++)
+        {
+            std::memcpy(&glyph.pixels[row * bitmap.width], bitmap.buffer + row * bitmap.pitch, bitmap.width);
+        }
+    }
+
+    // The field is grown by the spread on every side, the bearing moves to match.
+    if (mRenderMode == FontRenderMode::SIGNED_DISTANCE_FIELD && glyph.size.x > 0 && glyph.size.y > 0)
+    {
+        std::vector<unsigned char> field;
+        generateSignedDistanceField(glyph.pixels.data(), glyph.size.x, glyph.size.y, glyph.size.x, SDF_SPREAD, field);
+        glyph.pixels.swap(field);
+        glyph.size += glm::ivec2(2 * SDF_SPREAD);
+        glyph.bearing += glm::ivec2(-SDF_SPREAD, SDF_SPREAD);
+    }
+}
+
+bool Spritefont::addGlyph(const RasterizedGlyph& glyph) {
+    Character& ch = getCharacter(glyph.codepoint);
+    if (!mAtlas.insert(glyph.size.x, glyph.size.y, glyph.pixels.data(), glyph.size.x, ch.region))
+    {
+        return false;
+    }
+
+    ch.advance = glyph.advance;
+    ch.size = glyph.size;
+    ch.bearing = glyph.bearing;
+    ch.loaded = true;
+    return true;
+}
+
+void Spritefont::requestGlyph(const uint32_t codepoint) {
+    if (!mPendingGlyphs.insert(codepoint).second) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mRasterMutex);
+        mRasterRequests.push_back(codepoint);
+    }
+    mRasterCondition.notify_one();
+}
+
+void Spritefont::collectRasterizedGlyphs() {
+    std::vector<RasterizedGlyph> results;
+    {
+        std::lock_guard<std::mutex> lock(mRasterMutex);
+        results.swap(mRasterResults);
+    }
+
+    for (const RasterizedGlyph& glyph : results) {
+        mPendingGlyphs.erase(glyph.codepoint);
+        addGlyph(glyph);
+    }
+}
+
+void Spritefont::rasterizerLoop() {
+    while (true) {
+        std::vector<uint32_t> batch;
+        {
+            std::unique_lock<std::mutex> lock(mRasterMutex);
+            mRasterCondition.wait(lock, [this]() { return mRasterQuit || !mRasterRequests.empty(); });
+            if (mRasterQuit) {
+                return;
+            }
+            batch.swap(mRasterRequests);
+        }
+
+        // The whole batch is handed over at once, so a new string costs the game
+        // thread one upload pass.
+        std::vector<RasterizedGlyph> glyphs(batch.size());
+        for (size_t i = 0; i < batch.size(); i++) {
+            rasterize(batch[i], glyphs[i]);
+        }
+
+        std::lock_guard<std::mutex> lock(mRasterMutex);
+        for (RasterizedGlyph& glyph : glyphs) {
+            mRasterResults.push_back(std::move(glyph));
+        }
+    }
+}
+
+void Spritefont::stopRasterizer() {
+    if (!mRasterizer.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mRasterMutex);
+        mRasterQuit = true;
+        mRasterRequests.clear();
+    }
+    mRasterCondition.notify_one();
+    mRasterizer.join();
+}
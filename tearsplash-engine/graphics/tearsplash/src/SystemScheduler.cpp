@@ -0,0 +1,79 @@
+#include "Tearsplash/SystemScheduler.h"
+
+#include <algorithm>
+
+#include "Tearsplash/Profiler.h"
+
+using namespace Tearsplash;
+
+SystemScheduler::SystemScheduler() : mNeedsStageUpdate(false) {
+}
+
+SystemScheduler::~SystemScheduler() {
+    // Do nothing.
+}
+
+void SystemScheduler::init(const size_t numWorkers) {
+    mJobs.init(numWorkers);
+}
+
+void SystemScheduler::destroy() {
+    mJobs.destroy();
+}
+
+void SystemScheduler::add(const std::string& name, const ComponentMask reads, const ComponentMask writes, SystemFunction function) {
+    mSystems.push_back({ name, reads, writes, function });
+    mNeedsStageUpdate = true;
+}
+
+void SystemScheduler::run(World& world, const float deltaTime) {
+    TS_PROFILE_SCOPE("SystemScheduler::run");
+
+    if (mNeedsStageUpdate) {
+        buildStages();
+    }
+
+    for (const std::vector<size_t>& stage : mStages) {
+        // Single system stages run inline, parallelFor doesn't wake the workers for them.
+        mJobs.parallelFor(stage.size(), [this, &stage, &world, deltaTime](const size_t index) {
+            TS_PROFILE_SCOPE("SystemScheduler::system");
+            mSystems[stage[index]].function(world, deltaTime);
+        });
+    }
+
+    world.flushDestroyed();
+}
+
+size_t SystemScheduler::getNumStages() {
+    if (mNeedsStageUpdate) {
+        buildStages();
+    }
+    return mStages.size();
+}
+
+void SystemScheduler::buildStages() {
+    mStages.clear();
+    std::vector<size_t> stageOfSystem(mSystems.size(), 0);
+
+    for (size_t i = 0; i < mSystems.size(); i++) {
+        const System& system = mSystems[i];
+        const ComponentMask touches = system.reads | system.writes;
+
+        // Keep the order of the systems this one conflicts with.
+        size_t stage = 0;
+        for (size_t j = 0; j < i; j++) {
+            const System& earlier = mSystems[j];
+            if ((system.writes & (earlier.reads | earlier.writes)) != 0 || (earlier.writes & touches) != 0) {
+                stage = std::max(stage, stageOfSystem[j] + 1);
+            }
+        }
+
+        stageOfSystem[i] = stage;
+        if (stage >= mStages.size()) {
+            mStages.resize(stage + 1);
+        }
+        mStages[stage].push_back(i);
+    }
+
+    mNeedsStageUpdate = false;
+}
@@ -15,8 +15,15 @@
 
 //using namespace Tearsplash;
 
-int Tearsplash::init()
+int Tearsplash::init(bool headless)
 {
+	if (headless)
+	{
+		// Timers and events only, there's no display or audio device to open.
+		SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS);
+		return 0;
+	}
+
 	// Initialize SDL
 	SDL_Init(SDL_INIT_EVERYTHING);
 
@@ -0,0 +1,22 @@
+#include "Tearsplash/TextLayout.h"
+
+using namespace Tearsplash;
+
+TextLayout::TextLayout() : mFont(nullptr), mPosition(0.0f), mColor(1.0f), mScale(1.0f), mComplete(false), mAtlasEvictions(0) {
+}
+
+TextLayout::~TextLayout() {
+    // Do nothing.
+}
+
+void TextLayout::set(const std::string& text, const glm::vec2& position, const glm::vec3& color, const float scale) {
+    if (text == mText && position == mPosition && color == mColor && scale == mScale) {
+        return;
+    }
+
+    mText = text;
+    mPosition = position;
+    mColor = color;
+    mScale = scale;
+    mFont = nullptr;
+}
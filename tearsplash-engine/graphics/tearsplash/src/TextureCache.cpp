@@ -11,6 +11,7 @@
 #include <iostream>
 #include "Tearsplash/TextureCache.h"
 #include "Tearsplash/ImageLoader.h"
+#include "Tearsplash/Profiler.h"
 
 using namespace Tearsplash;
 
@@ -31,6 +32,8 @@ TextureCache::~TextureCache()
 // otherwise it adds the new texture to the map.
 GLTexture TextureCache::getTexture(std::string texturePath)
 {
+	TS_PROFILE_SCOPE("TextureCache::getTexture");
+
 	// auto replaces std::map<std::string, GLTexture>::iterator
 	auto mit = mTextureMap.find(texturePath);
 
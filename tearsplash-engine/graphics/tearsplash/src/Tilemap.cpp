@@ -0,0 +1,185 @@
+#include "Tearsplash/Tilemap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "Tearsplash/Profiler.h"
+
+using namespace Tearsplash;
+
+const uint16_t Tilemap::EMPTY_TILE;
+
+Tilemap::Tilemap() :
+    mTilesheet(nullptr), mWidth(0), mHeight(0), mTileSize(1.0f), mOrigin(0.0f), mChunkSize(32),
+    mNumChunksX(0), mNumChunksY(0), mNumDrawnChunks(0), mNumRebuiltChunks(0) {
+}
+
+Tilemap::~Tilemap() {
+    // Do nothing.
+}
+
+void Tilemap::init(const Tilesheet* tilesheet, const int width, const int height, const float tileSize,
+                   const glm::vec2& origin, const int chunkSize) {
+    destroy();
+
+    mTilesheet = tilesheet;
+    mWidth = width;
+    mHeight = height;
+    mTileSize = tileSize;
+    mOrigin = origin;
+    mChunkSize = chunkSize;
+    mNumChunksX = (width + chunkSize - 1) / chunkSize;
+    mNumChunksY = (height + chunkSize - 1) / chunkSize;
+
+    mTiles.assign(static_cast<size_t>(width) * height, EMPTY_TILE);
+    mChunks.assign(static_cast<size_t>(mNumChunksX) * mNumChunksY, Chunk{ 0, 0, 0, true });
+}
+
+void Tilemap::destroy() {
+    for (Chunk& chunk : mChunks) {
+        if (chunk.vao != 0) {
+            glDeleteVertexArrays(1, &chunk.vao);
+            glDeleteBuffers(1, &chunk.vbo);
+        }
+    }
+    mChunks.clear();
+    mTiles.clear();
+}
+
+void Tilemap::setTile(const int x, const int y, const uint16_t tile) {
+    uint16_t& current = mTiles[static_cast<size_t>(y) * mWidth + x];
+    if (current != tile) {
+        current = tile;
+        mChunks[(y / mChunkSize) * mNumChunksX + x / mChunkSize].dirty = true;
+    }
+}
+
+void Tilemap::draw(const Camera2D& camera) {
+    TS_PROFILE_SCOPE("Tilemap::draw");
+
+    mNumDrawnChunks = 0;
+    mNumRebuiltChunks = 0;
+
+    glm::ivec2 first;
+    glm::ivec2 last;
+    if (!getVisibleChunks(camera.getViewAABB(), first, last)) {
+        return;
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, mTilesheet->mTexture.id);
+
+    for (int chunkY = first.y; chunkY <= last.y; chunkY++) {
+        for (int chunkX = first.x; chunkX <= last.x; chunkX++) {
+            Chunk& chunk = mChunks[chunkY * mNumChunksX + chunkX];
+            if (chunk.dirty) {
+                rebuildChunk(chunkX, chunkY, chunk);
+            }
+            if (chunk.numVertices == 0) {
+                continue;
+            }
+
+            glBindVertexArray(chunk.vao);
+            glDrawArrays(GL_TRIANGLES, 0, chunk.numVertices);
+            mNumDrawnChunks++;
+        }
+    }
+
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+bool Tilemap::getVisibleChunks(const AABB& view, glm::ivec2& first, glm::ivec2& last) const {
+    const float chunkWorldSize = mTileSize * mChunkSize;
+    first.x = static_cast<int>(std::floor((view.min.x - mOrigin.x) / chunkWorldSize));
+    first.y = static_cast<int>(std::floor((view.min.y - mOrigin.y) / chunkWorldSize));
+    last.x = static_cast<int>(std::floor((view.max.x - mOrigin.x) / chunkWorldSize));
+    last.y = static_cast<int>(std::floor((view.max.y - mOrigin.y) / chunkWorldSize));
+
+    if (last.x < 0 || last.y < 0 || first.x >= mNumChunksX || first.y >= mNumChunksY) {
+        return false;
+    }
+
+    first = glm::max(first, glm::ivec2(0));
+    last = glm::min(last, glm::ivec2(mNumChunksX - 1, mNumChunksY - 1));
+    return true;
+}
+
+void Tilemap::buildChunkVertices(const int chunkX, const int chunkY, std::vector<Vertex>& vertices) const {
+    vertices.clear();
+
+    const int firstX = chunkX * mChunkSize;
+    const int firstY = chunkY * mChunkSize;
+    const int endX = std::min(firstX + mChunkSize, mWidth);
+    const int endY = std::min(firstY + mChunkSize, mHeight);
+
+    Vertex corner;
+    corner.setColor(255, 255, 255, 255);
+
+    for (int y = firstY; y < endY; y++) {
+        const uint16_t* row = &mTiles[static_cast<size_t>(y) * mWidth];
+        const float bottom = mOrigin.y + y * mTileSize;
+        const float top = bottom + mTileSize;
+
+        for (int x = firstX; x < endX; x++) {
+            if (row[x] == EMPTY_TILE) {
+                continue;
+            }
+
+            const glm::vec4& uv = mTilesheet->getUV(row[x]);
+            const float left = mOrigin.x + x * mTileSize;
+            const float right = left + mTileSize;
+
+            // Top left, bottom left, bottom right, bottom right, top right, top left.
+            Vertex topLeft = corner;
+            topLeft.setPosition(left, top);
+            topLeft.setUV(uv.x, uv.y + uv.w);
+            Vertex bottomLeft = corner;
+            bottomLeft.setPosition(left, bottom);
+            bottomLeft.setUV(uv.x, uv.y);
+            Vertex bottomRight = corner;
+            bottomRight.setPosition(right, bottom);
+            bottomRight.setUV(uv.x + uv.z, uv.y);
+            Vertex topRight = corner;
+            topRight.setPosition(right, top);
+            topRight.setUV(uv.x + uv.z, uv.y + uv.w);
+
+            vertices.push_back(topLeft);
+            vertices.push_back(bottomLeft);
+            vertices.push_back(bottomRight);
+            vertices.push_back(bottomRight);
+            vertices.push_back(topRight);
+            vertices.push_back(topLeft);
+        }
+    }
+}
+
+void Tilemap::rebuildChunk(const int chunkX, const int chunkY, Chunk& chunk) {
+    TS_PROFILE_SCOPE("Tilemap::rebuildChunk");
+
+    if (chunk.vao == 0) {
+        glGenVertexArrays(1, &chunk.vao);
+        glGenBuffers(1, &chunk.vbo);
+
+        glBindVertexArray(chunk.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.vbo);
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+        glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, color));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, uv));
+        glBindVertexArray(0);
+    }
+
+    buildChunkVertices(chunkX, chunkY, mScratchVertices);
+
+    glBindBuffer(GL_ARRAY_BUFFER, chunk.vbo);
+    glBufferData(GL_ARRAY_BUFFER, mScratchVertices.size() * sizeof(Vertex), mScratchVertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    chunk.numVertices = static_cast<GLsizei>(mScratchVertices.size());
+    chunk.dirty = false;
+    mNumRebuiltChunks++;
+}
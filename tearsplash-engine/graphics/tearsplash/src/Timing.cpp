@@ -6,17 +6,22 @@
 // Author:	Oscar Mrtensson
 // -------------------------------------------
 // Log:	    2019-03-24 File created
+//          2026-10-19 High resolution frame pacing and fixed timestep
+//          2026-10-19 Per instance frame statistics
 /**********************************************************************/
 
 #include "Tearsplash/Timing.h"
-#include "Tearsplash/Errors.h"
 
 #include <SDL/SDL.h>
 
 using namespace Tearsplash;
 
+namespace {
+    // How close to the deadline we stop sleeping and start spinning.
+    const double SPIN_THRESHOLD_SECONDS = 0.002;
+}
 
-FPSLimiter::FPSLimiter() {}
+FPSLimiter::FPSLimiter() : mMaxFPS(60.0f), mFPS(0.0f), mFrameTime(0.0f), mStartCounter(0), mPreviousCounter(0) {}
 FPSLimiter::~FPSLimiter() {}
 
 void FPSLimiter::init(const float maxFPS)
@@ -26,7 +31,7 @@ void FPSLimiter::init(const float maxFPS)
 
 void FPSLimiter::begin() 
 {
-    mStartTicks = SDL_GetTicks();
+    mStartCounter = SDL_GetPerformanceCounter();
 }
 
 // Returns the current fps
@@ -34,67 +39,101 @@ float FPSLimiter::end()
 {
     calcFPS();
 
-    float frameTicks = static_cast<float>(SDL_GetTicks() - mStartTicks);
-    float maxFrameTicks = 1000.0f / mMaxFPS;
+    // Wait until the frame has taken its full share of time
+    const double frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+    waitUntil(mStartCounter + static_cast<uint64_t>(frequency / mMaxFPS));
+
+    return mFPS;
+}
+
+void FPSLimiter::waitUntil(const uint64_t targetCounter) const
+{
+    const double frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+    uint64_t now = SDL_GetPerformanceCounter();
 
-    // Check if we need to wait
-    if (maxFrameTicks > frameTicks)
+    // Sleep in whole milliseconds while far enough from the deadline
+    while (now < targetCounter)
     {
-        SDL_Delay(static_cast<Uint32>(maxFrameTicks - frameTicks));
+        const double remaining = static_cast<double>(targetCounter - now) / frequency;
+        if (remaining <= SPIN_THRESHOLD_SECONDS)
+        {
+            break;
+        }
+        SDL_Delay(static_cast<Uint32>((remaining - SPIN_THRESHOLD_SECONDS) * 1000.0) + 1);
+        now = SDL_GetPerformanceCounter();
     }
 
-    return mFPS;
+    // Spin for the last bit
+    while (SDL_GetPerformanceCounter() < targetCounter) {}
 }
 
 // ----------------------------------
-// Calculates the engine FPS averaged over NUM_SAMPLES of frames
+// Records the time since the previous frame and updates the
+// fps from the averaged frame times
 void FPSLimiter::calcFPS()
 {
-    static const int	NUM_SAMPLES = 10;
-    static int			currentFrame = 0;
-    static float		frameTimes[NUM_SAMPLES];
-    static float		previousTicks = static_cast<float>(SDL_GetTicks());
-    float				currentTicks = static_cast<float>(SDL_GetTicks());
-    float				frameTimeAverages = 0.0f;
-    int count;
-
-    mFrameTime = currentTicks - previousTicks;
-    frameTimes[currentFrame % NUM_SAMPLES] = mFrameTime;
-
-    currentFrame++;
-    if (currentFrame < NUM_SAMPLES)
-    {
-        count = currentFrame;
-    }
-    else
+    const uint64_t currentCounter = SDL_GetPerformanceCounter();
+
+    // The first frame has nothing to measure against
+    if (mPreviousCounter != 0)
     {
-        count = NUM_SAMPLES;
+        const uint64_t elapsedCounts = currentCounter - mPreviousCounter;
+        const uint64_t frameTimeMicroseconds = elapsedCounts * 1000000 / SDL_GetPerformanceFrequency();
+        mFrameStats.addSample(frameTimeMicroseconds);
+
+        mFrameTime = static_cast<float>(frameTimeMicroseconds) * 0.001f;
+        mFPS = mFrameStats.getSummary().fps;
     }
 
-    // Calculate the average frame time
-    frameTimeAverages = 0.0f;
-    for (int i = 0; i < count; i++)
+    mPreviousCounter = currentCounter;
+}
+
+FixedTimestep::FixedTimestep() :
+    mTimeStep(1.0f / 60.0f), mMaxStepsPerFrame(5), mLockstep(false), mLockstepSteps(1), mAccumulator(0.0), mFrameTime(0.0), mPreviousCounter(0) {}
+FixedTimestep::~FixedTimestep() {}
+
+void FixedTimestep::init(const float stepsPerSecond, const int maxStepsPerFrame)
+{
+    mTimeStep = 1.0f / stepsPerSecond;
+    mMaxStepsPerFrame = maxStepsPerFrame;
+    mAccumulator = 0.0;
+    mFrameTime = 0.0;
+    mPreviousCounter = 0;
+}
+
+void FixedTimestep::beginFrame()
+{
+    const uint64_t currentCounter = SDL_GetPerformanceCounter();
+
+    // The first frame has nothing to measure against
+    if (mPreviousCounter != 0)
     {
-        frameTimeAverages += frameTimes[i];
+        mFrameTime = static_cast<double>(currentCounter - mPreviousCounter) / static_cast<double>(SDL_GetPerformanceFrequency());
     }
+    mPreviousCounter = currentCounter;
 
-    // Check for divison-by-zero
-    if (count > 0)
+    if (mLockstep)
     {
-        frameTimeAverages /= count;
+        // Exact, a float times a small integer fits a double.
+        mAccumulator = static_cast<double>(mTimeStep) * mLockstepSteps;
+        return;
     }
 
-    // Check for divison-by-zero
-    if (frameTimeAverages > 0)
+    // Drop the time we could never catch up on
+    mAccumulator += mFrameTime;
+    const double maxAccumulated = static_cast<double>(mTimeStep) * mMaxStepsPerFrame;
+    if (mAccumulator > maxAccumulated)
     {
-        // Convert from [f / ms] -> [f / s]
-        mFPS = 1000.0f / frameTimeAverages;
+        mAccumulator = maxAccumulated;
     }
-    else
+}
+
+bool FixedTimestep::step()
+{
+    if (mAccumulator >= mTimeStep)
     {
-        Tearsplash::softError("FPS counter division by zero.");
+        mAccumulator -= mTimeStep;
+        return true;
     }
-
-    // Update ticks
-    previousTicks = currentTicks;
+    return false;
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "Tearsplash/VoiceManager.h"
+
+#include <algorithm>
+
+#include <imgui/imgui.h>
+
+#include "Tearsplash/Profiler.h"
+
+using namespace Tearsplash;
+
+VoiceManager::VoiceManager() : mMaxStartsPerFramePerSound(1), mNextSequence(0) {
+}
+
+VoiceManager::~VoiceManager() {
+    // Do nothing.
+}
+
+void VoiceManager::init(const int numChannels, const int maxStartsPerFramePerSound) {
+    const int allocated = Mix_AllocateChannels(numChannels);
+    mVoices.assign(allocated, Voice{ nullptr, 0, 0, false });
+    mStartedThisFrame.clear();
+    mMaxStartsPerFramePerSound = maxStartsPerFramePerSound;
+    mNextSequence = 0;
+    mStats = VoiceStats();
+    mStats.numChannels = allocated;
+}
+
+int VoiceManager::play(Mix_Chunk* chunk, const int loops, const int priority) {
+    auto started = std::find_if(mStartedThisFrame.begin(), mStartedThisFrame.end(),
+        [chunk](const std::pair<Mix_Chunk*, int>& entry) { return entry.first == chunk; });
+    if (started != mStartedThisFrame.end() && started->second >= mMaxStartsPerFramePerSound) {
+        mStats.rateLimited++;
+        return -1;
+    }
+
+    const int channel = findChannel(priority);
+    if (channel == -1) {
+        mStats.dropped++;
+        return -1;
+    }
+
+    Voice& voice = mVoices[channel];
+    if (voice.active) {
+        Mix_HaltChannel(channel);
+        voice.active = false;
+        mStats.activeVoices--;
+        mStats.stolen++;
+    }
+
+    if (Mix_PlayChannel(channel, chunk, loops) == -1) {
+        mStats.dropped++;
+        return -1;
+    }
+
+    voice = { chunk, priority, mNextSequence++, true };
+    mStats.played++;
+    mStats.activeVoices++;
+    mStats.peakVoices = std::max(mStats.peakVoices, mStats.activeVoices);
+
+    if (started != mStartedThisFrame.end()) {
+        started->second++;
+    }
+    else {
+        mStartedThisFrame.emplace_back(chunk, 1);
+    }
+    return channel;
+}
+
+void VoiceManager::stop(const int channel) {
+    if (channel < 0 || channel >= static_cast<int>(mVoices.size())) {
+        return;
+    }
+
+    Mix_HaltChannel(channel);
+    if (mVoices[channel].active) {
+        mVoices[channel].active = false;
+        mStats.activeVoices--;
+    }
+}
+
+void VoiceManager::stopAll() {
+    for (int channel = 0; channel < static_cast<int>(mVoices.size()); channel++) {
+        stop(channel);
+    }
+}
+
+void VoiceManager::update() {
+    TS_PROFILE_SCOPE("VoiceManager::update");
+
+    // Finished voices are noticed here rather than in Mix_ChannelFinished, which
+    // runs on the audio thread.
+    for (int channel = 0; channel < static_cast<int>(mVoices.size()); channel++) {
+        Voice& voice = mVoices[channel];
+        if (voice.active && Mix_Playing(channel) == 0) {
+            voice.active = false;
+            mStats.activeVoices--;
+        }
+    }
+    mStartedThisFrame.clear();
+}
+
+void VoiceManager::drawImGui() const {
+    ImGui::Text("Audio %d/%d voices (peak %d)", mStats.activeVoices, mStats.numChannels, mStats.peakVoices);
+    ImGui::Text("  played %llu stolen %llu dropped %llu rate limited %llu",
+        static_cast<unsigned long long>(mStats.played), static_cast<unsigned long long>(mStats.stolen),
+        static_cast<unsigned long long>(mStats.dropped), static_cast<unsigned long long>(mStats.rateLimited));
+}
+
+int VoiceManager::findChannel(const int priority) {
+    int victim = -1;
+    for (int channel = 0; channel < static_cast<int>(mVoices.size()); channel++) {
+        const Voice& voice = mVoices[channel];
+        if (!voice.active) {
+            return channel;
+        }
+
+        // Lowest priority first, then the oldest.
+        if (victim == -1 ||
+            voice.priority < mVoices[victim].priority ||
+            (voice.priority == mVoices[victim].priority && voice.sequence < mVoices[victim].sequence)) {
+            victim = channel;
+        }
+    }
+
+    if (victim != -1 && mVoices[victim].priority <= priority) {
+        return victim;
+    }
+    return -1;
+}
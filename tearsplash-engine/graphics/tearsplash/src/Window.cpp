@@ -15,13 +15,21 @@
 using namespace Tearsplash;
 
 // Constructor
-Window::Window() {}
+Window::Window() : mSDLWindow(nullptr), mGLContext(nullptr), mWindowWidth(0), mWindowHeight(0) {}
 
 // Destructor
-Window::~Window() {}
+Window::~Window()
+{
+	mHeadlessContext.destroy();
+}
 
 int Window::createWindow(std::string windowName, int screenWidth, int screenHeight, unsigned int currentFlags)
 {
+	if (currentFlags & HEADLESS)
+	{
+		return createHeadless(screenWidth, screenHeight);
+	}
+
 	// Update window flags if needed
 	Uint32 flags = SDL_WINDOW_OPENGL;
 	if (currentFlags & INVISIBLE)
@@ -44,7 +52,7 @@ int Window::createWindow(std::string windowName, int screenWidth, int screenHeig
   // Set flags for context. Create core context profile.
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 2);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
 
 	// Create window
 	mSDLWindow = SDL_CreateWindow(windowName.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, screenWidth, screenHeight, flags);
@@ -75,24 +83,67 @@ int Window::createWindow(std::string windowName, int screenWidth, int screenHeig
 		fatalError("GLEW could not be initialized");
 	}
 
+	// Disable vertical sync
+	SDL_GL_SetSwapInterval(0);
+
+	initGLState();
+
+	return 0;
+}
+
+// Creates an offscreen context instead of a window, for benchmarks and machines without a display
+int Window::createHeadless(int screenWidth, int screenHeight)
+{
+	if (!mHeadlessContext.create())
+	{
+		fatalError("Headless GL context could not be created");
+	}
+
+	mWindowHeight = screenHeight;
+	mWindowWidth = screenWidth;
+
+	// Core contexts need experimental to load everything. Without an X display glewInit
+	// reports the missing GLX extensions after the GL functions have been loaded, which
+	// is all a headless context needs.
+	glewExperimental = true;
+	GLenum error = glewInit();
+	if (error != GLEW_OK && error != GLEW_ERROR_NO_GLX_DISPLAY)
+	{
+		fatalError("GLEW could not be initialized");
+	}
+	// glewExperimental leaves GL_INVALID_ENUM behind on core contexts.
+	glGetError();
+
+	mHeadlessContext.initFramebuffer(screenWidth, screenHeight);
+
+	initGLState();
+
+	return 0;
+}
+
+void Window::initGLState()
+{
 	// Print OpenGL version of system
 	std::printf("--- OpenGL version %s ---\n\n", glGetString(GL_VERSION));
 
 	// Clear bg color to blue
 	glClearColor(0.0f, 0.0f, 1.0f, 1.0f);
 
-	// Disable vertical sync
-	SDL_GL_SetSwapInterval(0);
-
     // Enable alpha blending
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	return 0;
 }
 
 void Window::swapBuffer()
 {
+	if (mHeadlessContext.isCreated())
+	{
+		// Nothing to present. Wait for the frame instead, so frames can't queue up
+		// and frame times include the GPU work.
+		glFinish();
+		return;
+	}
+
 	// Swap render buffer
 	SDL_GL_SwapWindow(mSDLWindow);
 }
\ No newline at end of file